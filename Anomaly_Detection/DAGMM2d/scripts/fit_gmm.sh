@@ -0,0 +1,13 @@
+#!/bin/bash
+
+DATA='MVTecAD'
+
+./DAGMM2d \
+    --GMM true \
+    --dataset ${DATA} \
+    --GMM_dir "train" \
+    --GMM_workers 4 \
+    --GMM_threads 4 \
+    --size 256 \
+    --gpu_id 0 \
+    --nc 3
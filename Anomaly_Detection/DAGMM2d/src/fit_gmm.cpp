@@ -0,0 +1,139 @@
+#include <iostream>                    // std::cout
+#include <fstream>                     // std::ifstream
+#include <filesystem>                  // std::filesystem
+#include <string>                      // std::string
+#include <tuple>                       // std::tuple
+#include <vector>                      // std::vector
+#include <cmath>                       // std::ceil
+// For External Library
+#include <torch/torch.h>               // torch
+#include <boost/program_options.hpp>   // boost::program_options
+// For Original Header
+#include "networks.hpp"                // Encoder, Decoder, EstimationNetwork, RelativeEuclideanDistance, CosineSimilarity, save_params
+#include "gmm.hpp"                     // GMMFitter
+#include "transforms.hpp"              // transforms::Compose
+#include "datasets.hpp"                // datasets::ImageFolderWithPaths
+#include "dataloader.hpp"              // DataLoader::ImageFolderWithPaths
+#include "progress.hpp"                // progress
+
+// Define Namespace
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+// ----------------------------------------------
+// Gaussian Mixture Parameters Fitting Function
+// ----------------------------------------------
+void fit_gmm(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &dec, EstimationNetwork &est, std::vector<transforms::Compose*> &transform){
+
+    // (0) Initialization and Declaration
+    size_t total_iter;
+    std::string path, checkpoint_dir, cache_dir, cache_path;
+    std::string dataroot, load_epoch, buff;
+    std::ifstream infoi;
+    std::tuple<torch::Tensor, std::vector<std::string>> mini_batch;
+    std::vector<torch::Tensor> z_all, gamma_all;
+    torch::Tensor image, output;
+    torch::Tensor z, z_c, z_r, z_r1, z_r2, gamma_ap;
+    torch::Tensor mu, sigma, phi;
+    datasets::ImageFolderWithPaths dataset;
+    DataLoader::ImageFolderWithPaths dataloader;
+    progress::display *show_progress;
+
+    // (1) Get Model
+    checkpoint_dir = "checkpoints/" + vm["dataset"].as<std::string>();
+    path = checkpoint_dir + "/models/epoch_" + vm["GMM_load_epoch"].as<std::string>() + "_enc.pth"; torch::load(enc, path);
+    path = checkpoint_dir + "/models/epoch_" + vm["GMM_load_epoch"].as<std::string>() + "_dec.pth"; torch::load(dec, path);
+    path = checkpoint_dir + "/models/epoch_" + vm["GMM_load_epoch"].as<std::string>() + "_est.pth"; torch::load(est, path);
+
+    // (2) Set Path of Latent Cache
+    load_epoch = vm["GMM_load_epoch"].as<std::string>();
+    if (load_epoch == "latest"){
+        infoi.open(checkpoint_dir + "/models/info.txt", std::ios::in);
+        std::getline(infoi, buff);
+        infoi.close();
+        load_epoch = "";
+        for (auto &c : buff){
+            if (('0' <= c) && (c <= '9')){
+                load_epoch += c;
+            }
+        }
+    }
+    cache_dir = checkpoint_dir + "/latents";  fs::create_directories(cache_dir);
+    cache_path = cache_dir + "/epoch_" + load_epoch + "_" + vm["GMM_dir"].as<std::string>();
+    cache_path += "_size" + std::to_string(vm["size"].as<size_t>()) + "_nc" + std::to_string(vm["nc"].as<size_t>());  // the transform of the images
+    cache_path += (vm["RED"].as<bool>() ? "_RED" : "_AED") + std::string(".pth");                                      // the reconstruction features
+
+    // (3) Get Latent Variables
+    torch::NoGradGuard no_grad;
+    enc->eval();
+    dec->eval();
+    est->eval();
+    if (vm["GMM_cache"].as<bool>() && fs::exists(cache_path)){
+        torch::load(z, cache_path);
+        std::cout << "total cached latent variables : " << z.size(0) << std::endl;
+    }
+    else{
+
+        dataroot = "datasets/" + vm["dataset"].as<std::string>() + "/" + vm["GMM_dir"].as<std::string>();
+        dataset = datasets::ImageFolderWithPaths(dataroot, transform);
+        dataloader = DataLoader::ImageFolderWithPaths(dataset, vm["GMM_batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/vm["GMM_workers"].as<size_t>());
+        std::cout << "total fitting images : " << dataset.size() << std::endl;
+
+        total_iter = std::ceil((float)dataset.size() / (float)vm["GMM_batch_size"].as<size_t>());
+        show_progress = new progress::display(/*count_max_=*/total_iter, /*header1=*/"---------------", /*header2=*/"Latent_Encoding", /*loss_=*/{});
+        while (dataloader(mini_batch)){
+
+            image = std::get<0>(mini_batch).to(device);
+
+            // (3.1) Encoder-Decoder Forward
+            z_c = enc->forward(image);   // {C,H,W} ===> {ZC,1,1}
+            output = dec->forward(z_c);  // {ZC,1,1} ===> {C,H,W}
+
+            // (3.2) Setting Latent Space
+            z_c = z_c.view({z_c.size(0), z_c.size(1)});  // {ZC,1,1} ===> {ZC}
+            if (vm["RED"].as<bool>()){
+                z_r1 = RelativeEuclideanDistance(image, output);
+            }
+            else{
+                z_r1 = AbsoluteEuclideanDistance(image, output);
+            }
+            z_r2 = CosineSimilarity(image, output);
+            z_r = torch::cat({z_r1, z_r2}, /*dim=*/1);  // {1} + {1} ===> {ZR} = {2}
+            z = torch::cat({z_c, z_r}, /*dim=*/1);  // {ZC} + {ZR} ===> {Z} = {ZC+ZR}
+            z_all.push_back(z.to(torch::kCPU));
+
+            show_progress->increment(/*loss_value=*/{});
+
+        }
+        delete show_progress;
+
+        z = torch::cat(z_all, /*dim=*/0);  // {N,Z}
+        torch::save(z, cache_path);
+
+    }
+
+    // (4) Estimation of Attribution Probability
+    for (auto &z_chunk : z.split(vm["GMM_batch_size"].as<size_t>(), /*dim=*/0)){
+        gamma_ap = est->forward(z_chunk.to(device));  // {Z} ===> {K}
+        gamma_all.push_back(gamma_ap.to(torch::kCPU));
+    }
+    gamma_ap = torch::cat(gamma_all, /*dim=*/0);  // {N,K}
+
+    // (5) Fitting of Gaussian Mixture Parameters
+    GMMFitter::fit(z, gamma_ap, /*n_shards=*/vm["GMM_threads"].as<size_t>(), /*chunk_size=*/vm["GMM_batch_size"].as<size_t>(), mu, sigma, phi);
+
+    // (6) Save Gaussian Mixture Parameters
+    if (vm["GMM_result"].as<std::string>().empty()){
+        path = checkpoint_dir + "/models/epoch_" + load_epoch + "_" + vm["GMM_dir"].as<std::string>() + "_gmp.dat";  // not to overwrite the parameters of the training
+    }
+    else{
+        path = checkpoint_dir + "/models/" + vm["GMM_result"].as<std::string>();
+    }
+    save_params(path, mu, sigma, phi);
+    std::cout << "Gaussian mixture parameters : " << path << std::endl;
+
+    // End Processing
+    return;
+
+}
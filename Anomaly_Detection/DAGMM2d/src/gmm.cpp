@@ -0,0 +1,144 @@
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "gmm.hpp"
+
+
+// ----------------------------------------------------------------------
+// class{GMMFitter} -> constructor
+// ----------------------------------------------------------------------
+GMMFitter::GMMFitter(const size_t nk_, const size_t nz_, const torch::Device device_){
+    this->nk = nk_;
+    this->nz = nz_;
+    this->device = device_;
+    this->reset();
+}
+
+
+// ----------------------------------------------------------------------
+// class{GMMFitter} -> function{reset}
+// ----------------------------------------------------------------------
+void GMMFitter::reset(){
+
+    auto options = torch::TensorOptions().dtype(torch::kDouble).device(this->device);
+
+    this->N = 0;
+    this->W = torch::zeros({(long int)this->nk}, options);                                        // W{K}
+    this->mean = torch::zeros({(long int)this->nk, (long int)this->nz}, options);                 // mean{K,Z}
+    this->M2 = torch::zeros({(long int)this->nk, (long int)this->nz, (long int)this->nz}, options);  // M2{K,Z,Z}
+
+    return;
+
+}
+
+
+// ----------------------------------------------------------------------
+// class{GMMFitter} -> function{update}
+// ----------------------------------------------------------------------
+void GMMFitter::update(torch::Tensor z, torch::Tensor gamma_ap){
+
+    torch::NoGradGuard no_grad;
+
+    // (1) Moments of Mini Batch
+    z = z.detach().to(this->device, torch::kDouble);                 // z{N,Z}
+    gamma_ap = gamma_ap.detach().to(this->device, torch::kDouble);   // gamma_ap{N,K}
+    torch::Tensor W_b = gamma_ap.sum(/*dim=*/0);  // gamma_ap{N,K} ===> W_b{K}
+    torch::Tensor mean_b = gamma_ap.t().mm(z) / W_b.clamp_min(DBL_MIN).unsqueeze(1);  // gamma_ap{K,N}, z{N,Z}, W_b{K,1} ===> mean_b{K,Z}
+    torch::Tensor z_dev = z.unsqueeze(0) - mean_b.unsqueeze(1);  // z{1,N,Z}, mean_b{K,1,Z} ===> z_dev{K,N,Z}
+    torch::Tensor M2_b = torch::bmm((gamma_ap.t().unsqueeze(2) * z_dev).transpose(1, 2), z_dev);  // gamma_ap{K,N,1}, z_dev{K,N,Z} ===> M2_b{K,Z,Z}
+
+    // (2) Merge into Running Moments
+    this->combine(W_b, mean_b, M2_b, (size_t)z.size(0));
+
+    return;
+
+}
+
+
+// ----------------------------------------------------------------------
+// class{GMMFitter} -> function{merge}
+// ----------------------------------------------------------------------
+void GMMFitter::merge(GMMFitter &other){
+    torch::NoGradGuard no_grad;
+    this->combine(other.W.to(this->device), other.mean.to(this->device), other.M2.to(this->device), other.N);
+    return;
+}
+
+
+// ----------------------------------------------------------------------
+// class{GMMFitter} -> function{combine}
+// ----------------------------------------------------------------------
+void GMMFitter::combine(torch::Tensor W_b, torch::Tensor mean_b, torch::Tensor M2_b, const size_t N_b){
+
+    torch::Tensor W_ab = this->W + W_b;  // W{K}, W_b{K} ===> W_ab{K}
+    torch::Tensor delta = mean_b - this->mean;  // mean_b{K,Z}, mean{K,Z} ===> delta{K,Z}
+    torch::Tensor ratio = (W_b / W_ab.clamp_min(DBL_MIN)).unsqueeze(1);  // W_b{K}, W_ab{K} ===> ratio{K,1}
+    torch::Tensor cross = (this->W * W_b / W_ab.clamp_min(DBL_MIN)).unsqueeze(1).unsqueeze(2);  // W{K}, W_b{K}, W_ab{K} ===> cross{K,1,1}
+
+    this->mean = this->mean + delta * ratio;  // mean{K,Z} ===> mean{K,Z}
+    this->M2 = this->M2 + M2_b + delta.unsqueeze(2) * delta.unsqueeze(1) * cross;  // M2{K,Z,Z}, M2_b{K,Z,Z}, delta{K,Z,1}, delta{K,1,Z} ===> M2{K,Z,Z}
+    this->W = W_ab;
+    this->N += N_b;
+
+    return;
+
+}
+
+
+// ----------------------------------------------------------------------
+// class{GMMFitter} -> function{get_params}
+// ----------------------------------------------------------------------
+void GMMFitter::get_params(torch::Tensor &mu, torch::Tensor &sigma, torch::Tensor &phi){
+    mu = this->mean.to(torch::kFloat).clone();  // mean{K,Z} ===> mu{K,Z}
+    sigma = (this->M2 / this->W.clamp_min(DBL_MIN).unsqueeze(1).unsqueeze(2)).to(torch::kFloat);  // M2{K,Z,Z}, W{K,1,1} ===> sigma{K,Z,Z}
+    phi = (this->W / (double)this->N).to(torch::kFloat);  // W{K}, N{} ===> phi{K}
+    return;
+}
+
+
+// ----------------------------------------------------------------------
+// class{GMMFitter} -> function{fit}
+// ----------------------------------------------------------------------
+void GMMFitter::fit(torch::Tensor z, torch::Tensor gamma_ap, const size_t n_shards, const size_t chunk_size, torch::Tensor &mu, torch::Tensor &sigma, torch::Tensor &phi){
+
+    // (0) Initialization and Declaration
+    size_t i, shards;
+    size_t nk = gamma_ap.size(1);
+    size_t nz = z.size(1);
+    std::vector<torch::Tensor> z_shards, gamma_shards;
+    std::vector<GMMFitter> fitters;
+
+    // (1) Split Data into Shards
+    z = z.detach().to(torch::kCPU).contiguous();                // z{N,Z}
+    gamma_ap = gamma_ap.detach().to(torch::kCPU).contiguous();  // gamma_ap{N,K}
+    shards = std::max((size_t)1, std::min(n_shards, (size_t)z.size(0)));
+    z_shards = z.chunk(shards, /*dim=*/0);
+    gamma_shards = gamma_ap.chunk(shards, /*dim=*/0);
+    shards = z_shards.size();
+    for (i = 0; i < shards; i++){
+        fitters.push_back(GMMFitter(nk, nz, torch::kCPU));
+    }
+
+    // (2) Accumulate Moments per Shard
+    #pragma omp parallel for num_threads(shards)  // the global number of threads is left unchanged
+    for (i = 0; i < shards; i++){
+        auto z_chunks = z_shards.at(i).split(chunk_size, /*dim=*/0);
+        auto gamma_chunks = gamma_shards.at(i).split(chunk_size, /*dim=*/0);
+        for (size_t j = 0; j < z_chunks.size(); j++){
+            fitters.at(i).update(z_chunks.at(j), gamma_chunks.at(j));
+        }
+    }
+
+    // (3) Merge Shards
+    for (i = 1; i < shards; i++){
+        fitters.at(0).merge(fitters.at(i));
+    }
+    fitters.at(0).get_params(mu, sigma, phi);
+
+    // End Processing
+    return;
+
+}
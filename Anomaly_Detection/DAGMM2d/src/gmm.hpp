@@ -0,0 +1,34 @@
+#ifndef GMM_HPP
+#define GMM_HPP
+
+#include <vector>
+// For External Library
+#include <torch/torch.h>
+
+
+// -------------------------------------------------
+// class{GMMFitter}
+// -------------------------------------------------
+// Streaming estimator of Gaussian mixture parameters.
+// Each component keeps the total attribution weight W{K}, the weighted mean{K,Z}
+// and the centered second moment M2{K,Z,Z} in double precision.
+// Mini batches and data shards are combined by the pairwise update of Chan et al.,
+// so the result does not depend on the order or grouping of the data.
+class GMMFitter{
+private:
+    size_t nk, nz, N;
+    torch::Device device = torch::kCPU;
+    torch::Tensor W, mean, M2;
+    void combine(torch::Tensor W_b, torch::Tensor mean_b, torch::Tensor M2_b, const size_t N_b);
+public:
+    GMMFitter(){}
+    GMMFitter(const size_t nk_, const size_t nz_, const torch::Device device_=torch::kCPU);
+    void reset();
+    void update(torch::Tensor z, torch::Tensor gamma_ap);
+    void merge(GMMFitter &other);
+    void get_params(torch::Tensor &mu, torch::Tensor &sigma, torch::Tensor &phi);
+    static void fit(torch::Tensor z, torch::Tensor gamma_ap, const size_t n_shards, const size_t chunk_size, torch::Tensor &mu, torch::Tensor &sigma, torch::Tensor &phi);
+};
+
+
+#endif
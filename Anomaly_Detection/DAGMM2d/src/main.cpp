@@ -12,6 +12,8 @@
 // For Original Header
 #include "networks.hpp"                // Encoder, Decoder, EstimationNetwork
 #include "transforms.hpp"              // transforms
+#include "torchscript.hpp"             // torchscript
+#include "visualizer.hpp"              // visualizer
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -20,6 +22,7 @@ namespace po = boost::program_options;
 // Function Prototype
 void train(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &dec, EstimationNetwork &est, std::vector<transforms::Compose*> &transform);
 void test(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &dec, EstimationNetwork &est, std::vector<transforms::Compose*> &transform);
+void fit_gmm(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &dec, EstimationNetwork &est, std::vector<transforms::Compose*> &transform);
 void anomaly_detection(po::variables_map &vm);
 torch::Device Set_Device(po::variables_map &vm);
 template <typename T> void Set_Model_Params(po::variables_map &vm, T &model, const std::string name);
@@ -48,6 +51,7 @@ po::options_description parse_arguments(){
         ("gpu_id", po::value<int>()->default_value(0), "cuda device : 'x=-1' is cpu device")
         ("seed_random", po::value<bool>()->default_value(false), "whether to make the seed of random number in a random")
         ("seed", po::value<int>()->default_value(0), "seed of random number")
+        ("png_compression", po::value<int>()->default_value(-1), "zlib level of the saved PNG images from 0 (fastest) to 9 (smallest) : 'x=-1' is the default level of the encoder")
 
         // (2) Define for Training
         ("train", po::value<bool>()->default_value(false), "training mode on/off")
@@ -56,6 +60,7 @@ po::options_description parse_arguments(){
         ("batch_size", po::value<size_t>()->default_value(32), "training batch size")
         ("train_load_epoch", po::value<std::string>()->default_value(""), "epoch of model to resume learning")
         ("save_epoch", po::value<size_t>()->default_value(20), "frequency of epoch to save model and optimizer")
+        ("log_sync_iter", po::value<size_t>()->default_value(10), "frequency of iteration to copy the training losses to the host and write the log")
         ("no_NVI", po::value<bool>()->default_value(true), "neural variational inference off/on")
         ("com_detach", po::value<bool>()->default_value(false), "calculation graph detachment on/off in compression features")
         ("rec_detach", po::value<bool>()->default_value(true), "calculation graph detachment on/off in reconstruction features")
@@ -71,15 +76,29 @@ po::options_description parse_arguments(){
         ("test_dir", po::value<std::string>()->default_value("test"), "test image directory : ./datasets/<dataset>/<test_dir>/<image files>")
         ("test_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for testing")
         ("test_result_dir", po::value<std::string>()->default_value("test_result"), "test result directory : ./<test_result_dir>")
-
-        // (5) Define for Anomaly Detection
+        ("test_archive", po::value<bool>()->default_value(false), "save the test images into ./<test_result_dir>/images.tar with its index images.tar.idx instead of one file per image")
+        ("test_batch_size", po::value<size_t>()->default_value(16), "test mini-batch size")
+        ("test_workers", po::value<size_t>()->default_value(4), "the number of workers to retrieve data from the test dataset")
+        ("test_gmp", po::value<std::string>()->default_value(""), "gaussian mixture parameters used for testing : ./checkpoints/<dataset>/models/<test_gmp> (empty is epoch_<test_load_epoch>_gmp.dat of the training)")
+
+        // (5) Define for Fitting of Gaussian Mixture Parameters
+        ("GMM", po::value<bool>()->default_value(false), "fitting mode of gaussian mixture parameters on/off")
+        ("GMM_dir", po::value<std::string>()->default_value("train"), "fitting image directory : ./datasets/<dataset>/<GMM_dir>/<image files>")
+        ("GMM_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for fitting")
+        ("GMM_batch_size", po::value<size_t>()->default_value(32), "fitting batch size")
+        ("GMM_workers", po::value<size_t>()->default_value(4), "the number of workers to retrieve data from the fitting dataset")
+        ("GMM_threads", po::value<size_t>()->default_value(4), "the number of data shards accumulated in parallel")
+        ("GMM_cache", po::value<bool>()->default_value(true), "whether to reuse cached latent variables : ./checkpoints/<dataset>/latents/<files>")
+        ("GMM_result", po::value<std::string>()->default_value(""), "fitted parameters : ./checkpoints/<dataset>/models/<GMM_result> (empty is epoch_<N>_<GMM_dir>_gmp.dat, apart from epoch_<N>_gmp.dat of the training)")
+
+        // (6) Define for Anomaly Detection
         ("AD", po::value<bool>()->default_value(false), "anomaly detection mode on/off")
         ("anomaly_path", po::value<std::string>()->default_value("anomaly.txt"), "path in which the result of anomaly image is written : ./<anomaly_path>")
         ("normal_path", po::value<std::string>()->default_value("normal.txt"), "path in which the result of normal image is written : ./<normal_path>")
         ("AD_result_dir", po::value<std::string>()->default_value("AD_result"), "anomaly detection result directory : ./<AD_result_dir>")
         ("n_thresh", po::value<size_t>()->default_value(256), "the number of threshold in anomaly detection")
 
-        // (6) Define for Network Parameter
+        // (7) Define for Network Parameter
         ("lr_com", po::value<float>()->default_value(5e-4), "learning rate for compression network")
         ("lr_est", po::value<float>()->default_value(5e-4), "learning rate for estimation network")
         ("beta1", po::value<float>()->default_value(0.5), "beta 1 in Adam of optimizer method")
@@ -91,6 +110,11 @@ po::options_description parse_arguments(){
         ("n_blocks", po::value<size_t>()->default_value(2), "the number of residual blocks in estimation network")
         ("no_dropout", po::value<bool>()->default_value(false), "Dropout off/on")
 
+        // (8) Define for Export
+        ("export", po::value<bool>()->default_value(false), "TorchScript export mode on/off")
+        ("export_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for exporting : ./checkpoints/<dataset>/models/epoch_<export_load_epoch>_{enc,dec,est}.pt")
+        ("export_batch_size", po::value<size_t>()->default_value(1), "batch size of the example input for tracing")
+
     ;
     
     // End Processing
@@ -112,6 +136,7 @@ int main(int argc, const char *argv[]){
         std::cout << args << std::endl;
         return 1;
     }
+    visualizer::set_writer(visualizer::writer::default_workers(), /*capacity=*/64, /*compression=*/vm["png_compression"].as<int>());
     
     // (2) Select Device
     torch::Device device = Set_Device(vm);
@@ -158,18 +183,37 @@ int main(int argc, const char *argv[]){
         train(vm, device, enc, dec, est, transform);
     }
 
-    // (8.2) Test Phase
+    // (8.2) Fitting Phase of Gaussian Mixture Parameters
+    if (vm["GMM"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "fit_gmm");
+        fit_gmm(vm, device, enc, dec, est, transform);
+    }
+
+    // (8.3) Test Phase
     if (vm["test"].as<bool>()){
         Set_Options(vm, argc, argv, args, "test");
         test(vm, device, enc, dec, est, transform);
     }
 
-    // (8.3) Anomaly Detection Phase
+    // (8.4) Anomaly Detection Phase
     if (vm["AD"].as<bool>()){
         Set_Options(vm, argc, argv, args, "anomaly_detection");
         anomaly_detection(vm);
     }
 
+    // (8.5) Export Phase
+    if (vm["export"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "export");
+        torch::NoGradGuard no_grad;
+        std::string path = dir + "/models/epoch_" + vm["export_load_epoch"].as<std::string>();
+        torch::Tensor image = torch::zeros({(long int)vm["export_batch_size"].as<size_t>(), (long int)vm["nc"].as<size_t>(), (long int)vm["size"].as<size_t>(), (long int)vm["size"].as<size_t>()}).to(device);  // {N,C,H,W}
+        torch::Tensor z_c = torch::zeros({(long int)vm["export_batch_size"].as<size_t>(), (long int)vm["nz_c"].as<size_t>(), 1, 1}).to(device);  // {N,ZC,1,1}
+        torch::Tensor z = torch::zeros({(long int)vm["export_batch_size"].as<size_t>(), (long int)(vm["nz_c"].as<size_t>() + vm["nz_r"].as<size_t>())}).to(device);  // {N,Z}
+        torchscript::export_model(enc, path + "_enc", image);
+        torchscript::export_model(dec, path + "_dec", z_c);
+        torchscript::export_model(est, path + "_est", z);
+    }
+
     // End Processing
     return 0;
 
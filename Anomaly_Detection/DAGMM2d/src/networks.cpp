@@ -276,7 +276,7 @@ torch::Tensor EstimationNetworkImpl::precision_just_before(){
 // ----------------------------------------------------------------------
 // struct{EstimationNetworkImpl}(nn::Module) -> function{anomaly_score}
 // ----------------------------------------------------------------------
-torch::Tensor EstimationNetworkImpl::anomaly_score(torch::Tensor z, torch::Tensor mu, torch::Tensor sigma, torch::Tensor phi){
+torch::Tensor EstimationNetworkImpl::anomaly_score(torch::Tensor z, torch::Tensor mu, torch::Tensor sigma, torch::Tensor phi, const bool each){
 
     size_t nz = mu.size(1);  // Z = the number of latent variables
     size_t nk = mu.size(0);  // K = the number of attribution probability
@@ -298,6 +298,9 @@ torch::Tensor EstimationNetworkImpl::anomaly_score(torch::Tensor z, torch::Tenso
     torch::Tensor exp_term = torch::exp(exp_term_base - max_value);  // exp_term_base{N,K}, max_value{N,1} ===> exp_term{N,K}
     torch::Tensor energy = - max_value.squeeze(1) - torch::log(torch::sum(phi.unsqueeze(0) * exp_term / torch::sqrt(det_sigma).unsqueeze(0), /*dim=*/1) + this->eps);  // max_value{N}, phi{1,K}, exp_term{N,K}, det_sigma{1,1} ===> energy{N}
 
+    if (each){
+        return energy;  // energy{N}
+    }
     torch::Tensor out = torch::mean(energy);  // energy{N} ===> energy{}
     return out;
 
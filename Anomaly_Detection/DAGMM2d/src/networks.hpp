@@ -69,7 +69,7 @@ public:
     torch::Tensor energy_just_before();
     torch::Tensor NVI_just_before();
     torch::Tensor precision_just_before();
-    torch::Tensor anomaly_score(torch::Tensor z, torch::Tensor mu, torch::Tensor sigma, torch::Tensor phi);
+    torch::Tensor anomaly_score(torch::Tensor z, torch::Tensor mu, torch::Tensor sigma, torch::Tensor phi, const bool each=false);
 };
 
 // -------------------------------------------------
@@ -1,20 +1,20 @@
 #include <iostream>                    // std::cout
-#include <fstream>                     // std::ifstream, std::ofstream
+#include <fstream>                     // std::ifstream
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
-#include <chrono>                      // std::chrono
-#include <cmath>                       // std::isinf
+#include <vector>                      // std::vector
+#include <climits>                     // LONG_MIN
 #include <utility>                     // std::pair
 // For External Library
 #include <torch/torch.h>               // torch
 #include <boost/program_options.hpp>   // boost::program_options
 // For Original Header
-#include "loss.hpp"                    // Loss
 #include "networks.hpp"                // Encoder, Decoder, EstimationNetwork, RelativeEuclideanDistance, CosineSimilarity, load_params
 #include "transforms.hpp"              // transforms::Compose
 #include "datasets.hpp"                // datasets::ImageFolderWithPaths
 #include "dataloader.hpp"              // DataLoader::ImageFolderWithPaths
 #include "visualizer.hpp"              // visualizer
+#include "evaluation.hpp"              // evaluation::Runner, evaluation::BufferedWriter, evaluation::EachLoss, evaluation::each
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -29,12 +29,13 @@ void test(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &d
     constexpr std::pair<float, float> output_range = {-1.0, 1.0};  // range of the value in output images
 
     // (0) Initialization and Declaration
-    float ave_loss, ave_anomaly_score, score;
-    double seconds, ave_time;
+    float ave_loss, ave_anomaly_score;
+    size_t i;
+    double ave_time;
     std::string path, result_dir, fname;
     std::string dataroot;
-    std::ofstream ofs, ofs_loss, ofs_score;
-    std::chrono::system_clock::time_point start, end;
+    std::vector<double> ave;
+    std::vector<std::vector<float>> rows;
     std::tuple<torch::Tensor, std::vector<std::string>> data;
     torch::Tensor image, output;
     torch::Tensor z, z_c, z_r, z_r1, z_r2;
@@ -42,15 +43,22 @@ void test(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &d
     torch::Tensor loss, anomaly_score;
     datasets::ImageFolderWithPaths dataset;
     DataLoader::ImageFolderWithPaths dataloader;
+    evaluation::Runner runner;
+    evaluation::BufferedWriter ofs, ofs_loss, ofs_score;
 
     // (1) Get Test Dataset
     dataroot = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_dir"].as<std::string>();
     dataset = datasets::ImageFolderWithPaths(dataroot, transform);
-    dataloader = DataLoader::ImageFolderWithPaths(dataset, /*batch_size_=*/1, /*shuffle_=*/false, /*num_workers_=*/0);
+    dataloader = DataLoader::ImageFolderWithPaths(dataset, /*batch_size_=*/vm["test_batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
     std::cout << "total test images : " << dataset.size() << std::endl << std::endl;
 
     // (2) Get Model
-    path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + "_gmp.dat"; load_params(path, mu, sigma, phi);
+    if (vm["test_gmp"].as<std::string>().empty()){
+        path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + "_gmp.dat"; load_params(path, mu, sigma, phi);
+    }
+    else{
+        path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/" + vm["test_gmp"].as<std::string>(); load_params(path, mu, sigma, phi);
+    }
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + "_enc.pth"; torch::load(enc, path);
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + "_dec.pth"; torch::load(dec, path);
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + "_est.pth"; torch::load(est, path);
@@ -59,32 +67,29 @@ void test(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &d
     phi = phi.to(device);
 
     // (3) Set Loss Function
-    auto criterion = Loss(vm["loss"].as<std::string>());
-
-    // (4) Initialization of Value
-    ave_loss = 0.0;
-    ave_anomaly_score = 0.0;
-    ave_time = 0.0;
+    auto criterion = evaluation::EachLoss(vm["loss"].as<std::string>());
 
-    // (5) Tensor Forward
+    // (4) Tensor Forward
+    torch::NoGradGuard no_grad;
     enc->eval();
     dec->eval();
     est->eval();
     result_dir = vm["test_result_dir"].as<std::string>();  fs::create_directories(result_dir);
-    ofs.open(result_dir + "/loss.txt", std::ios::out);
-    ofs_loss.open(result_dir + "/reconstruction_error.txt", std::ios::out);
-    ofs_score.open(result_dir + "/anomaly_score.txt", std::ios::out);
+    if (vm["test_archive"].as<bool>()) visualizer::open_archive(result_dir + "/images.tar");
+    ofs.open(result_dir + "/loss.txt");
+    ofs_loss.open(result_dir + "/reconstruction_error.txt");
+    ofs_score.open(result_dir + "/anomaly_score.txt");
     while (dataloader(data)){
         
         image = std::get<0>(data).to(device);
         
-        start = std::chrono::system_clock::now();
+        runner.start_timer();
         
-        // (5.1) Encoder-Decoder Forward
+        // (4.1) Encoder-Decoder Forward
         z_c = enc->forward(image);   // {C,H,W} ===> {ZC,1,1}
         output = dec->forward(z_c);  // {ZC,1,1} ===> {C,H,W}
 
-        // (5.2) Setting Latent Space
+        // (4.2) Setting Latent Space
         z_c = z_c.view({z_c.size(0), z_c.size(1)});  // {ZC,1,1} ===> {ZC}
         if (vm["RED"].as<bool>()){
             z_r1 = RelativeEuclideanDistance(image, output);
@@ -96,40 +101,40 @@ void test(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &d
         z_r = torch::cat({z_r1, z_r2}, /*dim=*/1);  // {1} + {1} ===> {ZR} = {2}
         z = torch::cat({z_c, z_r}, /*dim=*/1);  // {ZC} + {ZR} ===> {Z} = {ZC+ZR}
 
-        // (5.3) Calculation of Anomaly Score
-        anomaly_score = est->anomaly_score(z, mu, sigma, phi);
+        // (4.3) Calculation of Anomaly Score
+        anomaly_score = est->anomaly_score(z, mu, sigma, phi, /*each=*/true);  // {N,Z} ===> {N}
+        anomaly_score = anomaly_score.masked_fill(anomaly_score.isinf(), (double)LONG_MIN);  // (Note: Same value as the former host-side cast of an infinite score.)
+        loss = evaluation::each(criterion, output, image);  // {N,C,H,W} ===> {N}
 
-        end = std::chrono::system_clock::now();
-        seconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 0.001 * 0.001;
-        
-        loss = criterion(output, image);
-        
-        ave_loss += loss.item<float>();
-        score = anomaly_score.item<float>();
-        score = (std::isinf(score) ? (float)(long)score : score);
-        ave_anomaly_score += score;
-        ave_time += seconds;
+        // (4.4) Synchronize Once per Mini Batch
+        rows = runner.push({loss, anomaly_score});  // {N} * 2 ===> {N,2}
+        output = output.to(torch::kCPU);
 
-        std::cout << '<' << std::get<1>(data).at(0) << "> " << vm["loss"].as<std::string>() << ':' << loss.item<float>() << " anomaly_score:" << score << std::endl;
-        ofs << '<' << std::get<1>(data).at(0) << "> " << vm["loss"].as<std::string>() << ':' << loss.item<float>() << " anomaly_score:" << score << std::endl;
-        ofs_loss << loss.item<float>() << std::endl;
-        ofs_score << score << std::endl;
+        runner.stop_timer();
 
-        fname = result_dir + '/' + std::get<1>(data).at(0);
-        visualizer::save_image(output.detach(), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        // (4.5) Write Results
+        for (i = 0; i < rows.size(); i++){
+            ofs << '<' << std::get<1>(data).at(i) << "> " << vm["loss"].as<std::string>() << ':' << rows.at(i).at(0) << " anomaly_score:" << rows.at(i).at(1) << '\n';
+            ofs_loss << rows.at(i).at(0) << '\n';
+            ofs_score << rows.at(i).at(1) << '\n';
+            fname = result_dir + '/' + std::get<1>(data).at(i);
+            visualizer::save_image(output.narrow(/*dim=*/0, i, 1), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        }
 
     }
 
-    // (6) Calculate Average
-    ave_loss = ave_loss / (float)dataset.size();
-    ave_anomaly_score = ave_anomaly_score / (float)dataset.size();
-    ave_time = ave_time / (double)dataset.size();
+    // (5) Calculate Average
+    ave = runner.get_ave();
+    ave_loss = (float)ave.at(0);
+    ave_anomaly_score = (float)ave.at(1);
+    ave_time = runner.get_ave_time();
 
-    // (7) Average Output
+    // (6) Average Output
     std::cout << "<All> " << vm["loss"].as<std::string>() << ':' << ave_loss << " anomaly_score:" << ave_anomaly_score << " (time:" << ave_time << ')' << std::endl;
-    ofs << "<All> " << vm["loss"].as<std::string>() << ':' << ave_loss << " anomaly_score:" << ave_anomaly_score << " (time:" << ave_time << ')' << std::endl;
+    ofs << "<All> " << vm["loss"].as<std::string>() << ':' << ave_loss << " anomaly_score:" << ave_anomaly_score << " (time:" << ave_time << ")\n";
 
     // Post Processing
+    if (vm["test_archive"].as<bool>()) visualizer::close_archive();
     ofs.close();
     ofs_loss.close();
     ofs_score.close();
@@ -13,11 +13,13 @@
 // For Original Header
 #include "loss.hpp"                    // Loss
 #include "networks.hpp"                // Encoder, Decoder, EstimationNetwork, RelativeEuclideanDistance, CosineSimilarity, save_params
+#include "gmm.hpp"                     // GMMFitter
 #include "transforms.hpp"              // transforms::Compose
 #include "datasets.hpp"                // datasets::ImageFolderWithPaths
 #include "dataloader.hpp"              // DataLoader::ImageFolderWithPaths
 #include "visualizer.hpp"              // visualizer
 #include "progress.hpp"                // progress
+#include "metrics.hpp"                 // metrics
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -65,6 +67,7 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &
     visualizer::graph train_loss, train_rec_loss;
     visualizer::graph valid_loss, valid_rec_loss;
     progress::display *show_progress;
+    metrics::logger *logger;
     progress::irregular irreg_progress;
 
 
@@ -116,6 +119,8 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &
         dec->apply(weights_init);
         est->apply(weights_init);
         ofs.open(checkpoint_dir + "/log/train.txt", std::ios::out);
+        init.open(checkpoint_dir + "/log/train.jsonl", std::ios::trunc);
+        init.close();
         if (vm["valid"].as<bool>()){
             init.open(checkpoint_dir + "/log/valid.txt", std::ios::trunc);
             init.close();
@@ -173,6 +178,7 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &
         est->train();
         ofs << std::endl << "epoch:" << epoch << '/' << total_epoch << std::endl;
         show_progress = new progress::display(/*count_max_=*/total_iter, /*epoch=*/{epoch, total_epoch}, /*loss_=*/{"rec", "energy", "penalty"});
+        logger = new metrics::logger(show_progress, ofs, checkpoint_dir + "/log/train.jsonl", epoch, total_iter, /*loss_=*/{"rec", "energy", "penalty"}, vm["log_sync_iter"].as<size_t>());
 
         // -----------------------------------
         // b1. Mini Batch Learning
@@ -232,16 +238,12 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &
             // -----------------------------------
             // c2. Record Loss (iteration)
             // -----------------------------------
-            show_progress->increment(/*loss_value=*/{rec.item<float>(), energy.item<float>(), penalty.item<float>()});
-            ofs << "iters:" << show_progress->get_iters() << '/' << total_iter << ' ' << std::flush;
-            ofs << "rec:" << rec.item<float>() << "(ave:" <<  show_progress->get_ave(0) << ") " << std::flush;
-            ofs << "energy:" << energy.item<float>() << "(ave:" <<  show_progress->get_ave(1) << ") " << std::flush;
-            ofs << "penalty:" << penalty.item<float>() << "(ave:" <<  show_progress->get_ave(2) << ")" << std::endl;
+            logger->push({rec, energy, penalty});
 
             // -----------------------------------
             // c3. Save Sample Images
             // -----------------------------------
-            iter = show_progress->get_iters();
+            iter = logger->get_iters();
             if (iter % save_sample_iter == 1){
                 ss.str(""); ss.clear(std::stringstream::goodbit);
                 ss << save_images_dir << "/epoch_" << epoch << "-iter_" << iter << '.' << extension;
@@ -253,6 +255,7 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc, Decoder &
         // -----------------------------------
         // b2. Record Loss (epoch)
         // -----------------------------------
+        delete logger;
         train_loss.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(0) + show_progress->get_ave(1) + show_progress->get_ave(2), show_progress->get_ave(0), show_progress->get_ave(1), show_progress->get_ave(2)});
         train_rec_loss.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(0)});
 
@@ -344,12 +347,14 @@ void get_gmp(po::variables_map &vm, DataLoader::ImageFolderWithPaths &dataloader
     torch::Tensor z, z_c, z_r, z_r1, z_r2, gamma_ap;
     std::tuple<torch::Tensor, std::vector<std::string>> mini_batch;
     progress::display *show_progress;
+    GMMFitter fitter;
 
     // (1) Tensor Forward per Mini Batch
+    torch::NoGradGuard no_grad;
     enc->eval();
     dec->eval();
     est->eval();
-    est->resetGMP(device);
+    fitter = GMMFitter(vm["nk"].as<size_t>(), vm["nz_c"].as<size_t>() + vm["nz_r"].as<size_t>(), device);
 
     show_progress = new progress::display(/*count_max_=*/total_iter, /*header1=*/"---------------", /*header2=*/"Estimation_GMP", /*loss_=*/{});
     while (dataloader(mini_batch)){
@@ -374,15 +379,13 @@ void get_gmp(po::variables_map &vm, DataLoader::ImageFolderWithPaths &dataloader
 
         // (1.3) Estimation of Gaussian Mixture Parameters
         gamma_ap = est->forward(z);  // {Z} ===> {K}
-        est->estimationGMP(z, gamma_ap);
+        fitter.update(z, gamma_ap);
         show_progress->increment(/*loss_value=*/{});
 
     }
 
     // (2) Set Gaussian Mixture Parameters
-    mu = est->estimated_mu().clone();
-    sigma = est->estimated_sigma().clone();
-    phi = est->estimated_phi().clone();
+    fitter.get_params(mu, sigma, phi);
 
     // Post Processing
     delete show_progress;
@@ -12,6 +12,8 @@
 // For Original Header
 #include "networks.hpp"                // GAN_Encoder, GAN_Generator, GAN_Discriminator
 #include "transforms.hpp"              // transforms
+#include "torchscript.hpp"             // torchscript
+#include "visualizer.hpp"              // visualizer
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -45,6 +47,7 @@ po::options_description parse_arguments(){
         ("gpu_id", po::value<int>()->default_value(0), "cuda device : 'x=-1' is cpu device")
         ("seed_random", po::value<bool>()->default_value(false), "whether to make the seed of random number in a random")
         ("seed", po::value<int>()->default_value(0), "seed of random number")
+        ("png_compression", po::value<int>()->default_value(-1), "zlib level of the saved PNG images from 0 (fastest) to 9 (smallest) : 'x=-1' is the default level of the encoder")
 
         // (2) Define for Training
         ("train", po::value<bool>()->default_value(false), "training mode on/off")
@@ -53,6 +56,7 @@ po::options_description parse_arguments(){
         ("batch_size", po::value<size_t>()->default_value(32), "training batch size")
         ("train_load_epoch", po::value<std::string>()->default_value(""), "epoch of model to resume learning")
         ("save_epoch", po::value<size_t>()->default_value(20), "frequency of epoch to save model and optimizer")
+        ("log_sync_iter", po::value<size_t>()->default_value(10), "frequency of iteration to copy the training losses to the host and write the log")
 
         // (3) Define for Validation
         ("valid", po::value<bool>()->default_value(false), "validation mode on/off")
@@ -67,6 +71,9 @@ po::options_description parse_arguments(){
         ("test_dir", po::value<std::string>()->default_value("test"), "test image directory : ./datasets/<dataset>/<test_dir>/<image files>")
         ("test_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for testing")
         ("test_result_dir", po::value<std::string>()->default_value("test_result"), "test result directory : ./<test_result_dir>")
+        ("test_archive", po::value<bool>()->default_value(false), "save the test images into ./<test_result_dir>/images.tar with its index images.tar.idx instead of one file per image")
+        ("test_batch_size", po::value<size_t>()->default_value(16), "test mini-batch size")
+        ("test_workers", po::value<size_t>()->default_value(4), "the number of workers to retrieve data from the test dataset")
         ("test_Lambda", po::value<float>()->default_value(0.1), "anomaly score rate between reconstruction and feature matching in test")
 
         // (5) Define for Anomaly Detection
@@ -89,6 +96,11 @@ po::options_description parse_arguments(){
         ("ngf", po::value<size_t>()->default_value(64), "the number of filters in convolution layer closest to image in generator")
         ("ndf", po::value<size_t>()->default_value(64), "the number of filters in convolution layer closest to image in discriminator")
 
+        // (7) Define for Export
+        ("export", po::value<bool>()->default_value(false), "TorchScript export mode on/off")
+        ("export_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for exporting : ./checkpoints/<dataset>/models/epoch_<export_load_epoch>_{enc,gen}.pt")
+        ("export_batch_size", po::value<size_t>()->default_value(1), "batch size of the example input for tracing")
+
     ;
     
     // End Processing
@@ -110,6 +122,7 @@ int main(int argc, const char *argv[]){
         std::cout << args << std::endl;
         return 1;
     }
+    visualizer::set_writer(visualizer::writer::default_workers(), /*capacity=*/64, /*compression=*/vm["png_compression"].as<int>());
     
     // (2) Select Device
     torch::Device device = Set_Device(vm);
@@ -168,6 +181,17 @@ int main(int argc, const char *argv[]){
         anomaly_detection(vm);
     }
 
+    // (8.4) Export Phase
+    if (vm["export"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "export");
+        torch::NoGradGuard no_grad;
+        std::string path = dir + "/models/epoch_" + vm["export_load_epoch"].as<std::string>();
+        torch::Tensor image = torch::zeros({(long int)vm["export_batch_size"].as<size_t>(), (long int)vm["nc"].as<size_t>(), (long int)vm["size"].as<size_t>(), (long int)vm["size"].as<size_t>()}).to(device);  // {N,C,H,W}
+        torch::Tensor z = torch::zeros({(long int)vm["export_batch_size"].as<size_t>(), (long int)vm["nz"].as<size_t>()}).to(device);  // {N,Z}
+        torchscript::export_model(enc, path + "_enc", image);
+        torchscript::export_model(gen, path + "_gen", z);
+    }
+
     // End Processing
     return 0;
 
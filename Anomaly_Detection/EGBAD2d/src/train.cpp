@@ -18,6 +18,7 @@
 #include "dataloader.hpp"              // DataLoader::ImageFolderWithPaths
 #include "visualizer.hpp"              // visualizer
 #include "progress.hpp"                // progress
+#include "metrics.hpp"                 // metrics
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -64,6 +65,7 @@ void train(po::variables_map &vm, torch::Device &device, GAN_Encoder &enc, GAN_G
     DataLoader::ImageFolderWithPaths dataloader, valid_dataloader;
     visualizer::graph train_loss, train_loss_dis, valid_loss, valid_loss_dis;
     progress::display *show_progress;
+    metrics::logger *logger;
     progress::irregular irreg_progress;
 
 
@@ -115,6 +117,8 @@ void train(po::variables_map &vm, torch::Device &device, GAN_Encoder &enc, GAN_G
         gen->apply(weights_init);
         dis->apply(weights_init);
         ofs.open(checkpoint_dir + "/log/train.txt", std::ios::out);
+        init.open(checkpoint_dir + "/log/train.jsonl", std::ios::trunc);
+        init.close();
         if (vm["valid"].as<bool>()){
             init.open(checkpoint_dir + "/log/valid.txt", std::ios::trunc);
             init.close();
@@ -173,6 +177,7 @@ void train(po::variables_map &vm, torch::Device &device, GAN_Encoder &enc, GAN_G
         dis->train();
         ofs << std::endl << "epoch:" << epoch << '/' << total_epoch << std::endl;
         show_progress = new progress::display(/*count_max_=*/total_iter, /*epoch=*/{epoch, total_epoch}, /*loss_=*/{"E", "G", "D_Real", "D_Fake"});
+        logger = new metrics::logger(show_progress, ofs, checkpoint_dir + "/log/train.jsonl", epoch, total_iter, /*loss_=*/{"E", "G", "D_Real", "D_Fake"}, vm["log_sync_iter"].as<size_t>());
 
         // -----------------------------------
         // b1. Mini Batch Learning
@@ -226,17 +231,12 @@ void train(po::variables_map &vm, torch::Device &device, GAN_Encoder &enc, GAN_G
             // -----------------------------------
             // c2. Record Loss (iteration)
             // -----------------------------------
-            show_progress->increment(/*loss_value=*/{enc_loss.item<float>(), gen_loss.item<float>(), dis_real_loss.item<float>(), dis_fake_loss.item<float>()});
-            ofs << "iters:" << show_progress->get_iters() << '/' << total_iter << ' ' << std::flush;
-            ofs << "E:" << enc_loss.item<float>() << "(ave:" <<  show_progress->get_ave(0) << ") " << std::flush;
-            ofs << "G:" << gen_loss.item<float>() << "(ave:" <<  show_progress->get_ave(1) << ") " << std::flush;
-            ofs << "D_Real:" << dis_real_loss.item<float>() << "(ave:" <<  show_progress->get_ave(2) << ") " << std::flush;
-            ofs << "D_Fake:" << dis_fake_loss.item<float>() << "(ave:" <<  show_progress->get_ave(3) << ")" << std::endl;
+            logger->push({enc_loss, gen_loss, dis_real_loss, dis_fake_loss});
 
             // -----------------------------------
             // c3. Save Sample Images
             // -----------------------------------
-            iter = show_progress->get_iters();
+            iter = logger->get_iters();
             if (iter % save_sample_iter == 1){
                 ss.str(""); ss.clear(std::stringstream::goodbit);
                 ss << save_images_dir << "/epoch_" << epoch << "-iter_" << iter << '.' << extension;
@@ -248,6 +248,7 @@ void train(po::variables_map &vm, torch::Device &device, GAN_Encoder &enc, GAN_G
         // -----------------------------------
         // b2. Record Loss (epoch)
         // -----------------------------------
+        delete logger;
         train_loss.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(0), show_progress->get_ave(1), show_progress->get_ave(2) + show_progress->get_ave(3)});
         train_loss_dis.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(2) + show_progress->get_ave(3), show_progress->get_ave(2), show_progress->get_ave(3)});
 
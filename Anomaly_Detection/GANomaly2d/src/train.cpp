@@ -18,6 +18,7 @@
 #include "dataloader.hpp"              // DataLoader::ImageFolderWithPaths
 #include "visualizer.hpp"              // visualizer
 #include "progress.hpp"                // progress
+#include "metrics.hpp"                 // metrics
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -66,6 +67,7 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc1, Encoder
     visualizer::graph train_loss_rec, train_loss_gan, train_loss_dis;
     visualizer::graph valid_loss_rec, valid_loss_gan, valid_loss_dis;
     progress::display *show_progress;
+    metrics::logger *logger;
     progress::irregular irreg_progress;
 
 
@@ -124,6 +126,8 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc1, Encoder
         dec->apply(weights_init);
         dis->apply(weights_init);
         ofs.open(checkpoint_dir + "/log/train.txt", std::ios::out);
+        init.open(checkpoint_dir + "/log/train.jsonl", std::ios::trunc);
+        init.close();
         if (vm["valid"].as<bool>()){
             init.open(checkpoint_dir + "/log/valid.txt", std::ios::trunc);
             init.close();
@@ -185,6 +189,7 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc1, Encoder
         dis->train();
         ofs << std::endl << "epoch:" << epoch << '/' << total_epoch << std::endl;
         show_progress = new progress::display(/*count_max_=*/total_iter, /*epoch=*/{epoch, total_epoch}, /*loss_=*/{"adv", "con", "enc", "D_Real", "D_Fake"});
+        logger = new metrics::logger(show_progress, ofs, checkpoint_dir + "/log/train.jsonl", epoch, total_iter, /*loss_=*/{"adv", "con", "enc", "D_Real", "D_Fake"}, vm["log_sync_iter"].as<size_t>());
 
         // -----------------------------------
         // b1. Mini Batch Learning
@@ -233,18 +238,12 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc1, Encoder
             // -----------------------------------
             // c2. Record Loss (iteration)
             // -----------------------------------
-            show_progress->increment(/*loss_value=*/{adv_loss.item<float>(), con_loss.item<float>(), enc_loss.item<float>(), dis_real_loss.item<float>(), dis_fake_loss.item<float>()});
-            ofs << "iters:" << show_progress->get_iters() << '/' << total_iter << ' ' << std::flush;
-            ofs << "adv:" << adv_loss.item<float>() << "(ave:" <<  show_progress->get_ave(0) << ") " << std::flush;
-            ofs << "con:" << con_loss.item<float>() << "(ave:" <<  show_progress->get_ave(1) << ") " << std::flush;
-            ofs << "enc:" << enc_loss.item<float>() << "(ave:" <<  show_progress->get_ave(2) << ") " << std::flush;
-            ofs << "D_Real:" << dis_real_loss.item<float>() << "(ave:" <<  show_progress->get_ave(3) << ") " << std::flush;
-            ofs << "D_Fake:" << dis_fake_loss.item<float>() << "(ave:" <<  show_progress->get_ave(4) << ")" << std::endl;
+            logger->push({adv_loss, con_loss, enc_loss, dis_real_loss, dis_fake_loss});
 
             // -----------------------------------
             // c3. Save Sample Images
             // -----------------------------------
-            iter = show_progress->get_iters();
+            iter = logger->get_iters();
             if (iter % save_sample_iter == 1){
                 ss.str(""); ss.clear(std::stringstream::goodbit);
                 ss << save_images_dir << "/epoch_" << epoch << "-iter_" << iter << '.' << extension;
@@ -257,6 +256,7 @@ void train(po::variables_map &vm, torch::Device &device, Encoder &enc1, Encoder
         // -----------------------------------
         // b2. Record Loss (epoch)
         // -----------------------------------
+        delete logger;
         train_loss_rec.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(1), show_progress->get_ave(2)});
         train_loss_gan.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(0), show_progress->get_ave(3) + show_progress->get_ave(4)});
         train_loss_dis.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(3) + show_progress->get_ave(4), show_progress->get_ave(3), show_progress->get_ave(4)});
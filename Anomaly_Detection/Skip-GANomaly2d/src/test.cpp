@@ -1,9 +1,9 @@
 #include <iostream>                    // std::cout
-#include <fstream>                     // std::ifstream, std::ofstream
+#include <fstream>                     // std::ifstream
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
 #include <tuple>                       // std::tuple
-#include <chrono>                      // std::chrono
+#include <vector>                      // std::vector
 #include <utility>                     // std::pair
 // For External Library
 #include <torch/torch.h>               // torch
@@ -14,6 +14,7 @@
 #include "datasets.hpp"                // datasets::ImageFolderWithPaths
 #include "dataloader.hpp"              // DataLoader::ImageFolderWithPaths
 #include "visualizer.hpp"              // visualizer
+#include "evaluation.hpp"              // evaluation::Runner, evaluation::BufferedWriter
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -32,80 +33,81 @@ void test(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, GAN
 
     // (0) Initialization and Declaration
     float ave_anomaly_score, ave_res_loss, ave_dis_loss;
-    double seconds, ave_time;
+    size_t i;
+    double ave_time;
     std::string path, result_dir, fname;
     std::string dataroot;
-    std::ofstream ofs, ofs_score;
-    std::chrono::system_clock::time_point start, end;
+    std::vector<double> ave;
+    std::vector<std::vector<float>> rows;
     std::tuple<torch::Tensor, std::vector<std::string>> data;
     std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> anomaly_score_with_alpha;
     torch::Tensor image, output;
     torch::Tensor anomaly_score, res_loss, dis_loss;
     datasets::ImageFolderWithPaths dataset;
     DataLoader::ImageFolderWithPaths dataloader;
+    evaluation::Runner runner;
+    evaluation::BufferedWriter ofs, ofs_score;
 
     // (1) Get Test Dataset
     dataroot = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_dir"].as<std::string>();
     dataset = datasets::ImageFolderWithPaths(dataroot, transform);
-    dataloader = DataLoader::ImageFolderWithPaths(dataset, /*batch_size_=*/1, /*shuffle_=*/false, /*num_workers_=*/0);
+    dataloader = DataLoader::ImageFolderWithPaths(dataset, /*batch_size_=*/vm["test_batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
     std::cout << "total test images : " << dataset.size() << std::endl << std::endl;
 
     // (2) Get Model
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + "_gen.pth"; torch::load(gen, path);
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + "_dis.pth"; torch::load(dis, path);
 
-    // (3) Initialization of Value
-    ave_anomaly_score = 0.0;
-    ave_res_loss = 0.0;
-    ave_dis_loss = 0.0;
-    ave_time = 0.0;
-
-    // (4) Tensor Forward
+    // (3) Tensor Forward
+    torch::NoGradGuard no_grad;
     gen->eval();
     dis->eval();
     result_dir = vm["test_result_dir"].as<std::string>();  fs::create_directories(result_dir);
-    ofs.open(result_dir + "/loss.txt", std::ios::out);
-    ofs_score.open(result_dir + "/anomaly_score.txt", std::ios::out);
+    if (vm["test_archive"].as<bool>()) visualizer::open_archive(result_dir + "/images.tar");
+    ofs.open(result_dir + "/loss.txt");
+    ofs_score.open(result_dir + "/anomaly_score.txt");
     while (dataloader(data)){
         
         image = std::get<0>(data).to(device);
         
-        start = std::chrono::system_clock::now();
+        runner.start_timer();
         
+        // (3.1) Metrics on Device
         output = gen->forward(image);
         anomaly_score_with_alpha = AnomalyScore(image, output, dis, vm["test_Lambda"].as<float>());
-        anomaly_score = std::get<0>(anomaly_score_with_alpha);
-        res_loss = std::get<1>(anomaly_score_with_alpha);
-        dis_loss = std::get<2>(anomaly_score_with_alpha);
+        anomaly_score = std::get<0>(anomaly_score_with_alpha);  // {N}
+        res_loss = std::get<1>(anomaly_score_with_alpha);       // {N}
+        dis_loss = std::get<2>(anomaly_score_with_alpha);       // {N}
 
-        end = std::chrono::system_clock::now();
-        seconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 0.001 * 0.001;
-        
-        ave_anomaly_score += anomaly_score.item<float>();
-        ave_res_loss += res_loss.item<float>();
-        ave_dis_loss += dis_loss.item<float>();
-        ave_time += seconds;
+        // (3.2) Synchronize Once per Mini Batch
+        rows = runner.push({anomaly_score, res_loss, dis_loss});  // {N} * 3 ===> {N,3}
+        output = output.to(torch::kCPU);
 
-        std::cout << '<' << std::get<1>(data).at(0) << "> anomaly_score:" << anomaly_score.item<float>() << " res:" << res_loss.item<float>() << " dis:" << dis_loss.item<float>() << std::endl;
-        ofs << '<' << std::get<1>(data).at(0) << "> anomaly_score:" << anomaly_score.item<float>() << " res:" << res_loss.item<float>() << " dis:" << dis_loss.item<float>() << std::endl;
-        ofs_score << anomaly_score.item<float>() << std::endl;
+        runner.stop_timer();
 
-        fname = result_dir + '/' + std::get<1>(data).at(0);
-        visualizer::save_image(output.detach(), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        // (3.3) Write Results
+        for (i = 0; i < rows.size(); i++){
+            ofs << '<' << std::get<1>(data).at(i) << "> anomaly_score:" << rows.at(i).at(0) << " res:" << rows.at(i).at(1) << " dis:" << rows.at(i).at(2) << '\n';
+            ofs_score << rows.at(i).at(0) << '\n';
+            fname = result_dir + '/' + std::get<1>(data).at(i);
+            visualizer::save_image(output.narrow(/*dim=*/0, i, 1), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        }
 
     }
 
-    // (5) Calculate Average
-    ave_anomaly_score = ave_anomaly_score / (double)dataset.size();
-    ave_res_loss = ave_res_loss / (double)dataset.size();
-    ave_dis_loss = ave_dis_loss / (double)dataset.size();
-    ave_time = ave_time / (double)dataset.size();
+    // (4) Calculate Average
+    ave = runner.get_ave();
+    ave_anomaly_score = (float)ave.at(0);
+    ave_res_loss = (float)ave.at(1);
+    ave_dis_loss = (float)ave.at(2);
+    ave_time = runner.get_ave_time();
 
-    // (6) Average Output
+    // (5) Average Output
     std::cout << "<All> anomaly_score:" << ave_anomaly_score << " res:" << ave_res_loss << " dis:" << ave_dis_loss << " (time:" << ave_time << ')' << std::endl;
-    ofs << "<All> anomaly_score:" << ave_anomaly_score << " res:" << ave_res_loss << " dis:" << ave_dis_loss << " (time:" << ave_time << ')' << std::endl;
+    ofs << "<All> anomaly_score:" << ave_anomaly_score << " res:" << ave_res_loss << " dis:" << ave_dis_loss << " (time:" << ave_time << ")\n";
 
     // Post Processing
+    if (vm["test_archive"].as<bool>()) visualizer::close_archive();
     ofs.close();
     ofs_score.close();
 
@@ -119,10 +121,10 @@ void test(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, GAN
 // Function to Calculate Anomaly Score
 // ---------------------------------------------
 std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> AnomalyScore(torch::Tensor image, torch::Tensor fake_image, GAN_Discriminator &dis, const float Lambda){
-    torch::Tensor res_loss = torch::abs(image - fake_image).sum();
+    torch::Tensor res_loss = torch::abs(image - fake_image).view({image.size(0), -1}).sum(/*dim=*/1);  // {N,C,H,W} ===> {N}
     torch::Tensor image_feature = dis->forward(image).second;
     torch::Tensor fake_image_feature = dis->forward(fake_image).second;
-    torch::Tensor dis_loss = torch::abs(image_feature - fake_image_feature).sum();
+    torch::Tensor dis_loss = torch::abs(image_feature - fake_image_feature).view({image.size(0), -1}).sum(/*dim=*/1);  // {N,...} ===> {N}
     torch::Tensor anomaly_score = (1.0 - Lambda) * res_loss + Lambda * dis_loss;
     return {anomaly_score, res_loss, dis_loss};
 }
\ No newline at end of file
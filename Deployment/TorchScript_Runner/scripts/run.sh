@@ -0,0 +1,10 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./TorchScript_Runner \
+    --module "../../Multiclass_Classification/ResNet/checkpoints/${DATA}/models/epoch_latest.pt" \
+    --input_shape 1,1,224,224 \
+    --iterations 100 \
+    --warmup 10 \
+    --gpu_id -1
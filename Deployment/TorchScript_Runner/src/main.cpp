@@ -0,0 +1,144 @@
+#include <iostream>                    // std::cout, std::cerr
+#include <string>                      // std::string, std::stol
+#include <sstream>                     // std::stringstream
+#include <vector>                      // std::vector
+#include <map>                         // std::map
+#include <chrono>                      // std::chrono
+#include <algorithm>                   // std::sort
+#include <cstdlib>                     // std::exit
+// For External Library
+#include <torch/script.h>              // torch::jit::load
+#include <torch/torch.h>               // torch
+
+
+// Function Prototype
+std::map<std::string, std::string> parse_arguments(int argc, const char *argv[]);
+std::vector<long int> parse_shape(const std::string shape);
+
+
+// -----------------------------------
+// 0. Usage
+// -----------------------------------
+const std::string usage =
+    "Usage : ./TorchScript_Runner --module <path of .pt> --input_shape N,C,H,W [options]\n"
+    "  --module       TorchScript module exported by '--export true'\n"
+    "  --input_shape  shape of the input tensor (e.g. 1,3,256,256 or 1,512 for latent inputs)\n"
+    "  --iterations   the number of measured forward passes (default: 100)\n"
+    "  --warmup       the number of forward passes before measurement (default: 10)\n"
+    "  --gpu_id       cuda device : 'x=-1' is cpu device (default: -1)\n"
+    "  --threads      the number of intra-op threads : 'x=0' is the default of libtorch (default: 0)";
+
+
+// -----------------------------------
+// 1. Main Function
+// -----------------------------------
+int main(int argc, const char *argv[]){
+
+    // (0) Initialization and Declaration
+    long int i;
+    long int iterations, warmup, threads;
+    int gpu_id;
+    double ms;
+    std::vector<long int> shape;
+    std::vector<double> times;
+    std::chrono::steady_clock::time_point start, end;
+    torch::jit::Module module;
+    torch::Tensor input, output;
+
+    // (1) Extract Arguments
+    std::map<std::string, std::string> args = parse_arguments(argc, argv);
+    if ((args.count("module") == 0) || (args.count("input_shape") == 0)){
+        std::cout << usage << std::endl;
+        return 1;
+    }
+    shape = parse_shape(args["input_shape"]);
+    iterations = args.count("iterations") ? std::stol(args["iterations"]) : 100;
+    warmup = args.count("warmup") ? std::stol(args["warmup"]) : 10;
+    gpu_id = args.count("gpu_id") ? std::stoi(args["gpu_id"]) : -1;
+    threads = args.count("threads") ? std::stol(args["threads"]) : 0;
+    if (threads > 0){
+        torch::set_num_threads(threads);
+    }
+
+    // (2) Select Device
+    torch::Device device(torch::kCPU);
+    if (torch::cuda::is_available() && (gpu_id >= 0)){
+        device = torch::Device(torch::kCUDA, gpu_id);
+    }
+    std::cout << "using device = " << device << std::endl;
+
+    // (3) Load Module
+    torch::NoGradGuard no_grad;
+    module = torch::jit::load(args["module"], device);
+    module.eval();
+    input = torch::randn(shape, torch::TensorOptions().device(device));
+
+    // (4) Warmup (the first passes of a frozen module run the graph optimization)
+    for (i = 0; i < warmup; i++){
+        output = module.forward({input}).toTensor();
+    }
+    if (device.is_cuda()) torch::cuda::synchronize();
+
+    // (5) Measurement
+    for (i = 0; i < iterations; i++){
+        start = std::chrono::steady_clock::now();
+        output = module.forward({input}).toTensor();
+        if (device.is_cuda()) torch::cuda::synchronize();
+        end = std::chrono::steady_clock::now();
+        times.push_back((double)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 0.001);
+    }
+
+    // (6) Result Output
+    if (times.empty()){
+        std::cout << "output : " << output.sizes() << std::endl;
+        return 0;
+    }
+    std::sort(times.begin(), times.end());
+    ms = 0.0;
+    for (auto &t : times){
+        ms += t;
+    }
+    ms /= (double)times.size();
+    std::cout << "input : " << input.sizes() << "  output : " << output.sizes() << std::endl;
+    std::cout << "latency[ms] mean:" << ms << " p50:" << times.at(times.size() / 2) << " p90:" << times.at(times.size() * 9 / 10) << " min:" << times.front() << std::endl;
+    std::cout << "throughput[samples/s] : " << (double)shape.at(0) * 1000.0 / ms << std::endl;
+
+    // End Processing
+    return 0;
+
+}
+
+
+// -----------------------------------
+// 2. Argument Parsing Function
+// -----------------------------------
+std::map<std::string, std::string> parse_arguments(int argc, const char *argv[]){
+    std::map<std::string, std::string> args;
+    for (int i = 1; i + 1 < argc; i += 2){
+        std::string key = argv[i];
+        if (key.rfind("--", 0) != 0){
+            std::cerr << "Error : The argument '" << key << "' must begin with '--'." << std::endl;
+            std::exit(1);
+        }
+        args[key.substr(2)] = argv[i + 1];
+    }
+    return args;
+}
+
+
+// -----------------------------------
+// 3. Shape Parsing Function
+// -----------------------------------
+std::vector<long int> parse_shape(const std::string shape){
+    std::vector<long int> out;
+    std::stringstream ss(shape);
+    std::string item;
+    while (std::getline(ss, item, ',')){
+        out.push_back(std::stol(item));
+    }
+    if (out.empty()){
+        std::cerr << "Error : The input shape '" << shape << "' is empty." << std::endl;
+        std::exit(1);
+    }
+    return out;
+}
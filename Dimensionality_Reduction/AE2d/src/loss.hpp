@@ -4,6 +4,8 @@
 #include <string>
 // For External Library
 #include <torch/torch.h>
+// For Original Header
+#include "losses.hpp"
 
 
 // -------------------
@@ -12,6 +14,7 @@
 class Loss{
 private:
     int judge;
+    Losses::SSIMLoss ssim;
 public:
     Loss(){}
     Loss(const std::string loss);
@@ -1,19 +1,19 @@
 #include <iostream>                    // std::cout
-#include <fstream>                     // std::ifstream, std::ofstream
+#include <fstream>                     // std::ifstream
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
-#include <chrono>                      // std::chrono
+#include <vector>                      // std::vector
 #include <utility>                     // std::pair
 // For External Library
 #include <torch/torch.h>               // torch
 #include <boost/program_options.hpp>   // boost::program_options
 // For Original Header
-#include "loss.hpp"                    // Loss
 #include "networks.hpp"                // ConvolutionalAutoEncoder
 #include "transforms.hpp"              // transforms::Compose
 #include "datasets.hpp"                // datasets::ImageFolderPairWithPaths
 #include "dataloader.hpp"              // DataLoader::ImageFolderPairWithPaths
 #include "visualizer.hpp"              // visualizer
+#include "evaluation.hpp"              // evaluation::Runner, evaluation::BufferedWriter, evaluation::EachLoss, evaluation::each
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -29,22 +29,25 @@ void test(po::variables_map &vm, torch::Device &device, ConvolutionalAutoEncoder
 
     // (0) Initialization and Declaration
     float ave_loss, ave_GT_loss;
-    double seconds, ave_time;
+    size_t i;
+    double ave_time;
     std::string path, result_dir, fname;
     std::string input_dir, output_dir;
-    std::ofstream ofs;
-    std::chrono::system_clock::time_point start, end;
+    std::vector<double> ave;
+    std::vector<std::vector<float>> rows;
     std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>, std::vector<std::string>> data;
     torch::Tensor imageI, imageO, output;
     torch::Tensor loss, GT_loss;
     datasets::ImageFolderPairWithPaths dataset;
     DataLoader::ImageFolderPairWithPaths dataloader;
+    evaluation::Runner runner;
+    evaluation::BufferedWriter ofs;
 
     // (1) Get Test Dataset
     input_dir = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_in_dir"].as<std::string>();
     output_dir = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_out_dir"].as<std::string>();
     dataset = datasets::ImageFolderPairWithPaths(input_dir, output_dir, transform, transform);
-    dataloader = DataLoader::ImageFolderPairWithPaths(dataset, /*batch_size_=*/1, /*shuffle_=*/false, /*num_workers_=*/0);
+    dataloader = DataLoader::ImageFolderPairWithPaths(dataset, /*batch_size_=*/vm["test_batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
     std::cout << "total test images : " << dataset.size() << std::endl << std::endl;
 
     // (2) Get Model
@@ -52,54 +55,53 @@ void test(po::variables_map &vm, torch::Device &device, ConvolutionalAutoEncoder
     torch::load(model, path);
 
     // (3) Set Loss Function
-    auto criterion = Loss(vm["loss"].as<std::string>());
+    auto criterion = evaluation::EachLoss(vm["loss"].as<std::string>());
 
-    // (4) Initialization of Value
-    ave_loss = 0.0;
-    ave_GT_loss = 0.0;
-    ave_time = 0.0;
-
-    // (5) Tensor Forward
+    // (4) Tensor Forward
+    torch::NoGradGuard no_grad;
     model->eval();
     result_dir = vm["test_result_dir"].as<std::string>();  fs::create_directories(result_dir);
-    ofs.open(result_dir + "/loss.txt", std::ios::out);
+    if (vm["test_archive"].as<bool>()) visualizer::open_archive(result_dir + "/images.tar");
+    ofs.open(result_dir + "/loss.txt");
     while (dataloader(data)){
         
         imageI = std::get<0>(data).to(device);
         imageO = std::get<1>(data).to(device);
         
-        start = std::chrono::system_clock::now();
+        runner.start_timer();
         
+        // (4.1) Metrics on Device
         output = model->forward(imageI);
+        loss = evaluation::each(criterion, output, imageI);    // {N,C,H,W} ===> {N}
+        GT_loss = evaluation::each(criterion, output, imageO);  // {N,C,H,W} ===> {N}
 
-        end = std::chrono::system_clock::now();
-        seconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 0.001 * 0.001;
-        
-        loss = criterion(output, imageI);
-        GT_loss = criterion(output, imageO);
-        
-        ave_loss += loss.item<float>();
-        ave_GT_loss += GT_loss.item<float>();
-        ave_time += seconds;
+        // (4.2) Synchronize Once per Mini Batch
+        rows = runner.push({loss, GT_loss});  // {N} * 2 ===> {N,2}
+        output = output.to(torch::kCPU);
 
-        std::cout << '<' << std::get<2>(data).at(0) << "> " << vm["loss"].as<std::string>() << ':' << loss.item<float>() << " GT_" << vm["loss"].as<std::string>() << ':' << GT_loss.item<float>() << std::endl;
-        ofs << '<' << std::get<2>(data).at(0) << "> " << vm["loss"].as<std::string>() << ':' << loss.item<float>() << " GT_" << vm["loss"].as<std::string>() << ':' << GT_loss.item<float>() << std::endl;
+        runner.stop_timer();
 
-        fname = result_dir + '/' + std::get<3>(data).at(0);
-        visualizer::save_image(output.detach(), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        // (4.3) Write Results
+        for (i = 0; i < rows.size(); i++){
+            ofs << '<' << std::get<2>(data).at(i) << "> " << vm["loss"].as<std::string>() << ':' << rows.at(i).at(0) << " GT_" << vm["loss"].as<std::string>() << ':' << rows.at(i).at(1) << '\n';
+            fname = result_dir + '/' + std::get<3>(data).at(i);
+            visualizer::save_image(output.narrow(/*dim=*/0, i, 1), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        }
 
     }
 
-    // (6) Calculate Average
-    ave_loss = ave_loss / (float)dataset.size();
-    ave_GT_loss = ave_GT_loss / (float)dataset.size();
-    ave_time = ave_time / (double)dataset.size();
+    // (5) Calculate Average
+    ave = runner.get_ave();
+    ave_loss = (float)ave.at(0);
+    ave_GT_loss = (float)ave.at(1);
+    ave_time = runner.get_ave_time();
 
-    // (7) Average Output
+    // (6) Average Output
     std::cout << "<All> " << vm["loss"].as<std::string>() << ':' << ave_loss << " GT_" << vm["loss"].as<std::string>() << ':' << ave_GT_loss << " (time:" << ave_time << ')' << std::endl;
-    ofs << "<All> " << vm["loss"].as<std::string>() << ':' << ave_loss << " GT_" << vm["loss"].as<std::string>() << ':' << ave_GT_loss << " (time:" << ave_time << ')' << std::endl;
+    ofs << "<All> " << vm["loss"].as<std::string>() << ':' << ave_loss << " GT_" << vm["loss"].as<std::string>() << ':' << ave_GT_loss << " (time:" << ave_time << ")\n";
 
     // Post Processing
+    if (vm["test_archive"].as<bool>()) visualizer::close_archive();
     ofs.close();
 
     // End Processing
@@ -18,6 +18,7 @@
 #include "dataloader.hpp"              // DataLoader::ImageFolderWithPaths
 #include "visualizer.hpp"              // visualizer
 #include "progress.hpp"                // progress
+#include "metrics.hpp"                 // metrics
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -60,6 +61,7 @@ void train(po::variables_map &vm, torch::Device &device, ConvolutionalAutoEncode
     DataLoader::ImageFolderWithPaths dataloader, valid_dataloader;
     visualizer::graph train_loss, valid_loss;
     progress::display *show_progress;
+    metrics::logger *logger;
     progress::irregular irreg_progress;
 
 
@@ -105,6 +107,8 @@ void train(po::variables_map &vm, torch::Device &device, ConvolutionalAutoEncode
     if (vm["train_load_epoch"].as<std::string>() == ""){
         model->apply(weights_init);
         ofs.open(checkpoint_dir + "/log/train.txt", std::ios::out);
+        init.open(checkpoint_dir + "/log/train.jsonl", std::ios::trunc);
+        init.close();
         if (vm["valid"].as<bool>()){
             init.open(checkpoint_dir + "/log/valid.txt", std::ios::trunc);
             init.close();
@@ -156,6 +160,7 @@ void train(po::variables_map &vm, torch::Device &device, ConvolutionalAutoEncode
         model->train();
         ofs << std::endl << "epoch:" << epoch << '/' << total_epoch << std::endl;
         show_progress = new progress::display(/*count_max_=*/total_iter, /*epoch=*/{epoch, total_epoch}, /*loss_=*/{"rec"});
+        logger = new metrics::logger(show_progress, ofs, checkpoint_dir + "/log/train.jsonl", epoch, total_iter, /*loss_=*/{"rec"}, vm["log_sync_iter"].as<size_t>());
 
         // -----------------------------------
         // b1. Mini Batch Learning
@@ -175,14 +180,12 @@ void train(po::variables_map &vm, torch::Device &device, ConvolutionalAutoEncode
             // -----------------------------------
             // c2. Record Loss (iteration)
             // -----------------------------------
-            show_progress->increment(/*loss_value=*/{loss.item<float>()});
-            ofs << "iters:" << show_progress->get_iters() << '/' << total_iter << ' ' << std::flush;
-            ofs << "rec:" << loss.item<float>() << "(ave:" <<  show_progress->get_ave(0) << ')' << std::endl;
+            logger->push({loss});
 
             // -----------------------------------
             // c3. Save Sample Images
             // -----------------------------------
-            iter = show_progress->get_iters();
+            iter = logger->get_iters();
             if (iter % save_sample_iter == 1){
                 ss.str(""); ss.clear(std::stringstream::goodbit);
                 ss << save_images_dir << "/epoch_" << epoch << "-iter_" << iter << '.' << extension;
@@ -194,6 +197,7 @@ void train(po::variables_map &vm, torch::Device &device, ConvolutionalAutoEncode
         // -----------------------------------
         // b2. Record Loss (epoch)
         // -----------------------------------
+        delete logger;
         train_loss.plot(/*base=*/epoch, /*value=*/show_progress->get_ave());
 
         // -----------------------------------
@@ -1,10 +1,13 @@
-#include <iostream>                    // std::cout
+#include <iostream>                    // std::cout, std::cerr
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
 #include <sstream>                     // std::stringstream
+#include <vector>                      // std::vector
 #include <utility>                     // std::pair
+#include <algorithm>                   // std::min
 #include <ios>                         // std::right
 #include <iomanip>                     // std::setw, std::setfill
+#include <cstdlib>                     // std::exit
 // For External Library
 #include <torch/torch.h>               // torch
 #include <boost/program_options.hpp>   // boost::program_options
@@ -26,9 +29,11 @@ void sample(po::variables_map &vm, torch::Device &device, GAN_Generator &gen){
     constexpr std::pair<float, float> output_range = {-1.0, 1.0};  // range of the value in output images
 
     // (0) Initialization and Declaration
+    size_t i, j;
     size_t total, digit;
-    std::string path, result_dir, fname;
-    std::stringstream ss;
+    size_t batch_size, mini_batch_size;
+    std::string path, result_dir;
+    std::vector<std::string> fnames;
     torch::Tensor z, output;
 
     // (1) Get Model
@@ -36,26 +41,42 @@ void sample(po::variables_map &vm, torch::Device &device, GAN_Generator &gen){
     torch::load(gen, path);
 
     // (2) Image Generation
+    torch::InferenceMode guard;
     gen->eval();
     result_dir = vm["sample_result_dir"].as<std::string>();  fs::create_directories(result_dir);
     total = vm["sample_total"].as<size_t>();
+    batch_size = vm["sample_batch_size"].as<size_t>();
+    if (batch_size == 0){
+        std::cerr << "Error : The mini batch size of sampling must be 1 or more." << std::endl;
+        std::exit(1);
+    }
     digit = std::to_string(total - 1).length();
+    fnames = std::vector<std::string>(total);
+    for (i = 0; i < total; i++){
+        std::stringstream ss;
+        ss << std::setfill('0') << std::right << std::setw(digit) << i;
+        fnames.at(i) = result_dir + '/' + ss.str() + '.' + std::string(extension);
+    }
     std::cout << "total sampling images : " << total << std::endl << std::endl;
-    for (size_t i = 0; i < total; i++){
+    visualizer::set_writer(vm["sample_workers"].as<size_t>(), /*capacity=*/64, /*compression=*/vm["png_compression"].as<int>());
+    for (i = 0; i < total; i += batch_size){
 
-        z = torch::randn({1, (long int)vm["nz"].as<size_t>()}).to(device);
-        output = gen->forward(z);
+        // (2.1) Generator Forward for a Mini Batch
+        mini_batch_size = std::min(batch_size, total - i);
+        z = torch::randn({(long int)mini_batch_size, (long int)vm["nz"].as<size_t>()}, torch::TensorOptions().device(device));  // one random call for the mini batch
+        output = gen->forward(z).to(torch::kCPU);  // {N,Z} ===> {N,C,H,W}
 
-        ss.str(""); ss.clear(std::stringstream::goodbit);
-        ss << std::setfill('0') << std::right << std::setw(digit) << i;
-        fname = result_dir + '/' + ss.str() + '.' + std::string(extension);
-        visualizer::save_image(output.detach(), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        // (2.2) Queue the Images to the Writer
+        for (j = 0; j < mini_batch_size; j++){
+            visualizer::save_image(output.narrow(/*dim=*/0, /*start=*/j, /*length=*/1), fnames.at(i + j), /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        }
 
-        std::cout << '<' << fname << "> Generated!" << std::endl;
+        std::cout << '<' << fnames.at(i) << " - " << fnames.at(i + mini_batch_size - 1) << "> Generated!" << std::endl;
 
     }
+    visualizer::flush();
 
     // End Processing
     return;
 
-}
\ No newline at end of file
+}
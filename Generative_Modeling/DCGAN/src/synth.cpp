@@ -1,7 +1,10 @@
+#include <iostream>                    // std::cerr
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
 #include <sstream>                     // std::stringstream
+#include <vector>                      // std::vector
 #include <utility>                     // std::pair
+#include <cstdlib>                     // std::exit
 // For External Library
 #include <torch/torch.h>               // torch
 #include <boost/program_options.hpp>   // boost::program_options
@@ -24,30 +27,33 @@ void synth(po::variables_map &vm, torch::Device &device, GAN_Generator &gen){
 
     // (0) Initialization and Declaration
     size_t max_counter;
-    float value;
     std::string path, result_dir;
     std::stringstream ss;
-    torch::Tensor z, output, outputs;
+    std::vector<torch::Tensor> outputs;
+    torch::Tensor values, z, output;
 
     // (1) Get Model
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["synth_load_epoch"].as<std::string>() + "_gen.pth";
     torch::load(gen, path);
 
     // (2) Image Generation
+    if (vm["synth_batch_size"].as<size_t>() == 0){
+        std::cerr << "Error : The mini batch size of synthesis must be 1 or more." << std::endl;
+        std::exit(1);
+    }
+    torch::InferenceMode guard;
     gen->eval();
     max_counter = (int)(vm["synth_sigma_max"].as<float>() / vm["synth_sigma_inter"].as<float>() * 2) + 1;
-    z = torch::full({1, (long int)vm["nz"].as<size_t>()}, /*value=*/-vm["synth_sigma_max"].as<float>(), torch::TensorOptions().dtype(torch::kFloat)).to(device);
-    outputs = gen->forward(z);
-    for (size_t i = 1; i < max_counter; i++){
-        value = -vm["synth_sigma_max"].as<float>() + (float)i * vm["synth_sigma_inter"].as<float>();
-        z = torch::full({1, (long int)vm["nz"].as<size_t>()}, /*value=*/value, torch::TensorOptions().dtype(torch::kFloat)).to(device);
-        output = gen->forward(z);
-        outputs = torch::cat({outputs, output}, /*dim=*/0);
+    values = -vm["synth_sigma_max"].as<float>() + torch::arange((long int)max_counter, torch::TensorOptions().dtype(torch::kFloat).device(device)) * vm["synth_sigma_inter"].as<float>();  // {M}
+    z = values.view({(long int)max_counter, 1}).expand({(long int)max_counter, (long int)vm["nz"].as<size_t>()});  // {M} ===> {M,Z}
+    for (auto &z_batch : z.split(vm["synth_batch_size"].as<size_t>(), /*dim=*/0)){
+        outputs.push_back(gen->forward(z_batch.contiguous()));  // {N,Z} ===> {N,C,H,W}
     }
+    output = torch::cat(outputs, /*dim=*/0);  // {N,C,H,W} * B ===> {M,C,H,W}
     result_dir = vm["synth_result_dir"].as<std::string>();  fs::create_directories(result_dir);
     ss.str(""); ss.clear(std::stringstream::goodbit);
     ss << result_dir << "/Generated_Image."  << extension;
-    visualizer::save_image(outputs.detach(), ss.str(), /*range=*/output_range, /*cols=*/max_counter);
+    visualizer::save_image(output, ss.str(), /*range=*/output_range, /*cols=*/max_counter);
 
     // End Processing
     return;
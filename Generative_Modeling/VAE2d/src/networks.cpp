@@ -78,8 +78,14 @@ torch::Tensor VariationalAutoEncoderImpl::forward_z(torch::Tensor z){
 // -----------------------------------------------------------------------------
 // struct{VariationalAutoEncoderImpl}(nn::Module) -> function{kld_just_before}
 // -----------------------------------------------------------------------------
-torch::Tensor VariationalAutoEncoderImpl::kld_just_before(){
-    torch::Tensor kld = - 0.5 * torch::mean(1.0 + torch::log(this->var_keep) - this->mean_keep * this->mean_keep - this->var_keep);
+torch::Tensor VariationalAutoEncoderImpl::kld_just_before(const bool each){
+    torch::Tensor kld;
+    if (each){
+        kld = - 0.5 * (1.0 + torch::log(this->var_keep) - this->mean_keep * this->mean_keep - this->var_keep).view({this->var_keep.size(0), -1}).mean(/*dim=*/1);  // {N,Z,4,4} ===> {N}
+    }
+    else{
+        kld = - 0.5 * torch::mean(1.0 + torch::log(this->var_keep) - this->mean_keep * this->mean_keep - this->var_keep);
+    }
     return kld;
 }
 
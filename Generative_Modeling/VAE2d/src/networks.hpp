@@ -30,7 +30,7 @@ public:
     VariationalAutoEncoderImpl(po::variables_map &vm);
     torch::Tensor forward(torch::Tensor x);
     torch::Tensor forward_z(torch::Tensor z);
-    torch::Tensor kld_just_before();
+    torch::Tensor kld_just_before(const bool each=false);
     std::vector<long int> get_z_shape(const std::vector<long int> x_shape, torch::Device &device);
 };
 
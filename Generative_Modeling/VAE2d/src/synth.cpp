@@ -1,13 +1,15 @@
+#include <iostream>                    // std::cerr
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
 #include <sstream>                     // std::stringstream
 #include <vector>                      // std::vector
 #include <utility>                     // std::pair
+#include <cstdlib>                     // std::exit
 // For External Library
 #include <torch/torch.h>               // torch
 #include <boost/program_options.hpp>   // boost::program_options
 // For Original Header
-#include "networks.hpp"                // VariationalAutoEncoder
+#include "networks.hpp"                // VariationalAutoencoder
 #include "visualizer.hpp"              // visualizer
 
 // Define Namespace
@@ -25,32 +27,36 @@ void synth(po::variables_map &vm, torch::Device &device, VariationalAutoEncoder
 
     // (0) Initialization and Declaration
     size_t max_counter;
-    float value;
     std::string path, result_dir;
     std::stringstream ss;
     std::vector<long int> z_shape;
-    torch::Tensor z, output, outputs;
+    std::vector<torch::Tensor> outputs;
+    torch::Tensor values, z, output;
 
     // (1) Get Model
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["synth_load_epoch"].as<std::string>() + ".pth";
     torch::load(model, path);
 
     // (2) Image Generation
+    if (vm["synth_batch_size"].as<size_t>() == 0){
+        std::cerr << "Error : The mini batch size of synthesis must be 1 or more." << std::endl;
+        std::exit(1);
+    }
+    torch::InferenceMode guard;
     model->eval();
     max_counter = (int)(vm["synth_sigma_max"].as<float>() / vm["synth_sigma_inter"].as<float>() * 2) + 1;
+    values = -vm["synth_sigma_max"].as<float>() + torch::arange((long int)max_counter, torch::TensorOptions().dtype(torch::kFloat).device(device)) * vm["synth_sigma_inter"].as<float>();  // {M}
     z_shape = model->get_z_shape({1, (long int)vm["nc"].as<size_t>(), (long int)vm["size"].as<size_t>(), (long int)vm["size"].as<size_t>()}, device);
-    z = torch::full(z_shape, /*value=*/-vm["synth_sigma_max"].as<float>(), torch::TensorOptions().dtype(torch::kFloat)).to(device);
-    outputs = model->forward_z(z);
-    for (size_t i = 1; i < max_counter; i++){
-        value = -vm["synth_sigma_max"].as<float>() + (float)i * vm["synth_sigma_inter"].as<float>();
-        z = torch::full(z_shape, /*value=*/value, torch::TensorOptions().dtype(torch::kFloat)).to(device);
-        output = model->forward_z(z);
-        outputs = torch::cat({outputs, output}, /*dim=*/0);
+    z_shape.at(0) = max_counter;
+    z = values.view({(long int)max_counter, 1, 1, 1}).expand(z_shape);  // {M} ===> {M,Z,H',W'}
+    for (auto &z_batch : z.split(vm["synth_batch_size"].as<size_t>(), /*dim=*/0)){
+        outputs.push_back(model->forward_z(z_batch.contiguous()));  // {N,Z,H',W'} ===> {N,C,H,W}
     }
+    output = torch::cat(outputs, /*dim=*/0);  // {N,C,H,W} * B ===> {M,C,H,W}
     result_dir = vm["synth_result_dir"].as<std::string>();  fs::create_directories(result_dir);
     ss.str(""); ss.clear(std::stringstream::goodbit);
     ss << result_dir << "/Generated_Image."  << extension;
-    visualizer::save_image(outputs.detach(), ss.str(), /*range=*/output_range, /*cols=*/max_counter);
+    visualizer::save_image(output, ss.str(), /*range=*/output_range, /*cols=*/max_counter);
 
     // End Processing
     return;
@@ -6,6 +6,7 @@ DATA='celebA'
     --sample true \
     --dataset ${DATA} \
     --sample_total 100 \
+    --sample_batch_size 64 \
     --size 256 \
     --gpu_id 0 \
     --nc 3
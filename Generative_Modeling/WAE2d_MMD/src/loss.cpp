@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <cmath>
 // For External Library
 #include <torch/torch.h>
 // For Original Header
@@ -39,15 +40,14 @@ torch::Tensor Loss::operator()(torch::Tensor &input, torch::Tensor &target){
         static auto criterion = torch::nn::MSELoss(torch::nn::MSELossOptions().reduction(torch::kMean));
         return criterion(input, target);
     }
-    static auto criterion = Losses::SSIMLoss(input.size(1), input.device());
-    return criterion(input, target);
+    return this->ssim(input, target);
 }
 
 
 // -----------------------------------
 // class{MMDLoss} -> constructor
 // -----------------------------------
-MMDLoss::MMDLoss(const float var_){
+MMDLoss::MMDLoss(const float var_, const std::string mode, const size_t n_features_){
     if (var_ > 0.0){
         this->var = var_;
     }
@@ -55,6 +55,33 @@ MMDLoss::MMDLoss(const float var_){
         std::cerr << "Error : The variance value isn't defined right." << std::endl;
         std::exit(1);
     }
+    if (mode == "exact"){
+        this->judge = 0;
+    }
+    else if (mode == "linear"){
+        this->judge = 1;
+    }
+    else if (mode == "rff"){
+        this->judge = 2;
+    }
+    else{
+        std::cerr << "Error : The MMD estimator isn't defined right." << std::endl;
+        std::exit(1);
+    }
+    this->n_features = n_features_;
+}
+
+
+// ----------------------------------------------
+// class{MMDLoss} -> function{get_kernel_matrix}
+// ----------------------------------------------
+torch::Tensor MMDLoss::get_kernel_matrix(torch::Tensor &z1, torch::Tensor &z2, const float eps){
+    float C = 2.0 * (float)z1.size(1) * this->var;  // 2.0 * Z * var
+    torch::Tensor z1_sq = z1.pow(2.0).sum(/*dim=*/1);  // z1{N1,Z} ===> z1_sq{N1}
+    torch::Tensor z2_sq = z2.pow(2.0).sum(/*dim=*/1);  // z2{N2,Z} ===> z2_sq{N2}
+    torch::Tensor dist = torch::addmm(z1_sq.unsqueeze(1) + z2_sq.unsqueeze(0), z1, z2.t(), /*beta=*/1.0, /*alpha=*/-2.0).clamp_min(0.0);  // ||z1||^2{N1,1} + ||z2||^2{1,N2} - 2 * z1{N1,Z} * z2^T{Z,N2} ===> dist{N1,N2}
+    torch::Tensor kernel_matrix = C / (eps + C + dist);  // dist{N1,N2} ===> kernel_matrix{N1,N2}
+    return kernel_matrix;
 }
 
 
@@ -62,10 +89,7 @@ MMDLoss::MMDLoss(const float var_){
 // class{MMDLoss} -> function{get_kernel_sum}
 // -------------------------------------------
 torch::Tensor MMDLoss::get_kernel_sum(torch::Tensor &z1, torch::Tensor &z2, const bool exclude_diag, const float eps){
-    float C = 2.0 * (float)z1.size(1) * this->var;  // 2.0 * Z * var
-    torch::Tensor z11 = z1.unsqueeze(1).repeat({1, z2.size(0), 1});  // z1{N1,Z} ===> {N1,1,Z} ===> z11{N1,N2,Z}
-    torch::Tensor z22 = z2.unsqueeze(0).repeat({z1.size(0), 1, 1});  // z2{N2,Z} ===> {1,N2,Z} ===> z22{N1,N2,Z}
-    torch::Tensor kernel_matrix = C / (eps + C + (z11 - z22).pow(2.0).sum(/*dim=*/2));  // z11{N1,N2,Z}, z22{N1,N2,Z} ===> kernel_matrix{N1,N2}
+    torch::Tensor kernel_matrix = this->get_kernel_matrix(z1, z2, eps);  // z1{N1,Z}, z2{N2,Z} ===> kernel_matrix{N1,N2}
     torch::Tensor kernel_sum = kernel_matrix.sum();
     if (exclude_diag){
         kernel_sum = kernel_sum - kernel_matrix.diag().sum();
@@ -74,14 +98,99 @@ torch::Tensor MMDLoss::get_kernel_sum(torch::Tensor &z1, torch::Tensor &z2, cons
 }
 
 
+// -----------------------------------
+// class{MMDLoss} -> function{exact}
+// -----------------------------------
+torch::Tensor MMDLoss::exact(torch::Tensor &input, torch::Tensor &target, const float eps){
+
+    long int N = input.size(0);
+    torch::Tensor z = torch::cat({input, target}, /*dim=*/0);  // input{N,Z} + target{N,Z} ===> z{2N,Z}
+    torch::Tensor kernel_matrix = this->get_kernel_matrix(z, z, eps);  // z{2N,Z} ===> kernel_matrix{2N,2N}
+    torch::Tensor diag = kernel_matrix.diag();  // kernel_matrix{2N,2N} ===> diag{2N}
+
+    torch::Tensor k11 = kernel_matrix.slice(/*dim=*/0, 0, N).slice(/*dim=*/1, 0, N).sum() - diag.slice(/*dim=*/0, 0, N).sum();
+    torch::Tensor k22 = kernel_matrix.slice(/*dim=*/0, N, 2 * N).slice(/*dim=*/1, N, 2 * N).sum() - diag.slice(/*dim=*/0, N, 2 * N).sum();
+    torch::Tensor k12 = kernel_matrix.slice(/*dim=*/0, 0, N).slice(/*dim=*/1, N, 2 * N).sum();
+    torch::Tensor out = k11 / (float)(N * (N - 1)) + k22 / (float)(N * (N - 1)) - k12 * 2.0 / (float)(N * N);
+
+    return out;
+
+}
+
+
+// -----------------------------------
+// class{MMDLoss} -> function{linear}
+// -----------------------------------
+torch::Tensor MMDLoss::linear(torch::Tensor &input, torch::Tensor &target, const float eps){
+
+    // -------------------------------------------------------------------------------------
+    // Linear-time unbiased estimator (Gretton et al., 2012) :
+    //   MMD^2 = mean_i { k(x_2i,x_2i+1) + k(y_2i,y_2i+1) - k(x_2i,y_2i+1) - k(x_2i+1,y_2i) }
+    // -------------------------------------------------------------------------------------
+
+    float C = 2.0 * (float)input.size(1) * this->var;  // 2.0 * Z * var
+    long int M = input.size(0) / 2;
+    auto kernel = [&](torch::Tensor a, torch::Tensor b){ return C / (eps + C + (a - b).pow(2.0).sum(/*dim=*/1)); };  // a{M,Z}, b{M,Z} ===> {M}
+
+    torch::Tensor x1 = input.slice(/*dim=*/0, 0, 2 * M, 2);   // input{N,Z} ===> x1{M,Z}
+    torch::Tensor x2 = input.slice(/*dim=*/0, 1, 2 * M, 2);   // input{N,Z} ===> x2{M,Z}
+    torch::Tensor y1 = target.slice(/*dim=*/0, 0, 2 * M, 2);  // target{N,Z} ===> y1{M,Z}
+    torch::Tensor y2 = target.slice(/*dim=*/0, 1, 2 * M, 2);  // target{N,Z} ===> y2{M,Z}
+    torch::Tensor out = (kernel(x1, x2) + kernel(y1, y2) - kernel(x1, y2) - kernel(x2, y1)).mean();
+
+    return out;
+
+}
+
+
+// ---------------------------------------------
+// class{MMDLoss} -> function{random_features}
+// ---------------------------------------------
+torch::Tensor MMDLoss::random_features(torch::Tensor &input, torch::Tensor &target){
+
+    // -------------------------------------------------------------------------------------
+    // The kernel C/(C+||x-y||^2) is a scale mixture of Gaussian kernels :
+    //   C/(C+r^2) = E_{t~Exp(1)}[exp(-t*r^2/C)],
+    // so its frequencies are sampled as w = sqrt(2t/C) * g (g~N(0,I)),
+    // and phi(x) = sqrt(2/D) * cos(w^T x + b) (b~U(0,2pi)) gives k(x,y) ~ phi(x)^T phi(y).
+    // -------------------------------------------------------------------------------------
+
+    long int N = input.size(0);
+    long int nz = input.size(1);
+    long int D = this->n_features;
+    float C = 2.0 * (float)nz * this->var;  // 2.0 * Z * var
+    auto options = torch::TensorOptions().dtype(input.scalar_type()).device(input.device());
+
+    torch::Tensor t = torch::empty({1, D}, options).exponential_(1.0);  // t{1,D}
+    torch::Tensor w = torch::randn({nz, D}, options) * torch::sqrt(2.0 * t / C);  // g{Z,D}, t{1,D} ===> w{Z,D}
+    torch::Tensor b = torch::rand({1, D}, options) * 2.0 * M_PI;  // b{1,D}
+    torch::Tensor phi1 = torch::cos(torch::addmm(b, input, w)) * std::sqrt(2.0 / (double)D);   // input{N,Z}, w{Z,D} ===> phi1{N,D}
+    torch::Tensor phi2 = torch::cos(torch::addmm(b, target, w)) * std::sqrt(2.0 / (double)D);  // target{N,Z}, w{Z,D} ===> phi2{N,D}
+
+    torch::Tensor sum1 = phi1.sum(/*dim=*/0);  // phi1{N,D} ===> sum1{D}
+    torch::Tensor sum2 = phi2.sum(/*dim=*/0);  // phi2{N,D} ===> sum2{D}
+    torch::Tensor k11 = sum1.pow(2.0).sum() - phi1.pow(2.0).sum();  // sum_{i!=j} phi1_i^T phi1_j
+    torch::Tensor k22 = sum2.pow(2.0).sum() - phi2.pow(2.0).sum();  // sum_{i!=j} phi2_i^T phi2_j
+    torch::Tensor k12 = (sum1 * sum2).sum();                        // sum_{i,j} phi1_i^T phi2_j
+    torch::Tensor out = k11 / (float)(N * (N - 1)) + k22 / (float)(N * (N - 1)) - k12 * 2.0 / (float)(N * N);
+
+    return out;
+
+}
+
+
 // -----------------------------------
 // class{MMDLoss} -> operator
 // -----------------------------------
 torch::Tensor MMDLoss::operator()(torch::Tensor &input, torch::Tensor &target){
-    float N = (float)input.size(0);
-    torch::Tensor k11 = this->get_kernel_sum(input, input, /*exclude_diag=*/true);
-    torch::Tensor k22 = this->get_kernel_sum(target, target, /*exclude_diag=*/true);
-    torch::Tensor k12 = this->get_kernel_sum(input, target, /*exclude_diag=*/false);
-    torch::Tensor out = k11 / (N * (N - 1.0)) + k22 / (N * (N - 1.0)) - k12 * 2.0 / (N * N);
-    return out;
+    if (input.size(0) < 2){  // the unbiased estimators need at least two samples (e.g. the last mini batch of size 1)
+        return torch::zeros({}, input.options());
+    }
+    if (this->judge == 1){
+        return this->linear(input, target);
+    }
+    else if (this->judge == 2){
+        return this->random_features(input, target);
+    }
+    return this->exact(input, target);
 }
@@ -4,6 +4,8 @@
 #include <string>
 // For External Library
 #include <torch/torch.h>
+// For Original Header
+#include "losses.hpp"
 
 
 // -------------------
@@ -12,6 +14,7 @@
 class Loss{
 private:
     int judge;
+    Losses::SSIMLoss ssim;
 public:
     Loss(){}
     Loss(const std::string loss);
@@ -24,8 +27,14 @@ public:
 class MMDLoss{
 private:
     float var;
+    int judge;
+    size_t n_features;
+    torch::Tensor get_kernel_matrix(torch::Tensor &z1, torch::Tensor &z2, const float eps=1e-12);
+    torch::Tensor exact(torch::Tensor &input, torch::Tensor &target, const float eps=1e-12);
+    torch::Tensor linear(torch::Tensor &input, torch::Tensor &target, const float eps=1e-12);
+    torch::Tensor random_features(torch::Tensor &input, torch::Tensor &target);
 public:
-    MMDLoss(const float var_=1.0);
+    MMDLoss(const float var_=1.0, const std::string mode="exact", const size_t n_features_=1024);
     torch::Tensor get_kernel_sum(torch::Tensor &z1, torch::Tensor &z2, const bool exclude_diag=true, const float eps=1e-12);
     torch::Tensor operator()(torch::Tensor &input, torch::Tensor &target);
 };
@@ -18,6 +18,7 @@
 #include "dataloader.hpp"              // DataLoader::ImageFolderWithPaths
 #include "visualizer.hpp"              // visualizer
 #include "progress.hpp"                // progress
+#include "metrics.hpp"                 // metrics
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -62,6 +63,7 @@ void train(po::variables_map &vm, torch::Device &device, WAE_Encoder &enc, WAE_D
     DataLoader::ImageFolderWithPaths dataloader, valid_dataloader;
     visualizer::graph train_loss, valid_loss;
     progress::display *show_progress;
+    metrics::logger *logger;
     progress::irregular irreg_progress;
 
 
@@ -89,7 +91,7 @@ void train(po::variables_map &vm, torch::Device &device, WAE_Encoder &enc, WAE_D
 
     // (4) Set Loss Function
     auto criterion = Loss(vm["loss"].as<std::string>());
-    auto criterion_MMD = MMDLoss();
+    auto criterion_MMD = MMDLoss(/*var_=*/1.0, /*mode=*/vm["MMD"].as<std::string>(), /*n_features_=*/vm["MMD_features"].as<size_t>());
 
     // (5) Make Directories
     checkpoint_dir = "checkpoints/" + vm["dataset"].as<std::string>();
@@ -110,6 +112,8 @@ void train(po::variables_map &vm, torch::Device &device, WAE_Encoder &enc, WAE_D
         enc->apply(weights_init);
         dec->apply(weights_init);
         ofs.open(checkpoint_dir + "/log/train.txt", std::ios::out);
+        init.open(checkpoint_dir + "/log/train.jsonl", std::ios::trunc);
+        init.close();
         if (vm["valid"].as<bool>()){
             init.open(checkpoint_dir + "/log/valid.txt", std::ios::trunc);
             init.close();
@@ -165,6 +169,7 @@ void train(po::variables_map &vm, torch::Device &device, WAE_Encoder &enc, WAE_D
         dec->train();
         ofs << std::endl << "epoch:" << epoch << '/' << total_epoch << std::endl;
         show_progress = new progress::display(/*count_max_=*/total_iter, /*epoch=*/{epoch, total_epoch}, /*loss_=*/{"rec", "mmd"});
+        logger = new metrics::logger(show_progress, ofs, checkpoint_dir + "/log/train.jsonl", epoch, total_iter, /*loss_=*/{"rec", "mmd"}, vm["log_sync_iter"].as<size_t>());
 
         // -----------------------------------
         // b1. Mini Batch Learning
@@ -198,15 +203,12 @@ void train(po::variables_map &vm, torch::Device &device, WAE_Encoder &enc, WAE_D
             // -----------------------------------
             // c2. Record Loss (iteration)
             // -----------------------------------
-            show_progress->increment(/*loss_value=*/{rec_loss.item<float>(), mmd_loss.item<float>()});
-            ofs << "iters:" << show_progress->get_iters() << '/' << total_iter << ' ' << std::flush;
-            ofs << "rec:" << rec_loss.item<float>() << "(ave:" <<  show_progress->get_ave(0) << ") " << std::flush;
-            ofs << "mmd:" << mmd_loss.item<float>() << "(ave:" <<  show_progress->get_ave(1) << ")" << std::endl;
+            logger->push({rec_loss, mmd_loss});
 
             // -----------------------------------
             // c3. Save Sample Images
             // -----------------------------------
-            iter = show_progress->get_iters();
+            iter = logger->get_iters();
             if (iter % save_sample_iter == 1){
                 ss.str(""); ss.clear(std::stringstream::goodbit);
                 ss << save_images_dir << "/epoch_" << epoch << "-iter_" << iter << '.' << extension;
@@ -218,6 +220,7 @@ void train(po::variables_map &vm, torch::Device &device, WAE_Encoder &enc, WAE_D
         // -----------------------------------
         // b2. Record Loss (epoch)
         // -----------------------------------
+        delete logger;
         train_loss.plot(/*base=*/epoch, /*value=*/show_progress->get_ave());
 
         // -----------------------------------
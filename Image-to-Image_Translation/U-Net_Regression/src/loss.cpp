@@ -39,6 +39,5 @@ torch::Tensor Loss::operator()(torch::Tensor &input, torch::Tensor &target){
         static auto criterion = torch::nn::MSELoss(torch::nn::MSELossOptions().reduction(torch::kMean));
         return criterion(input, target);
     }
-    static auto criterion = Losses::SSIMLoss(input.size(1), input.device());
-    return criterion(input, target);
+    return this->ssim(input, target);
 }
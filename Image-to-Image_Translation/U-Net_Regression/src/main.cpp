@@ -12,6 +12,8 @@
 // For Original Header
 #include "networks.hpp"                // UNet
 #include "transforms.hpp"              // transforms
+#include "torchscript.hpp"             // torchscript
+#include "visualizer.hpp"              // visualizer
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -45,6 +47,7 @@ po::options_description parse_arguments(){
         ("gpu_id", po::value<int>()->default_value(0), "cuda device : 'x=-1' is cpu device")
         ("seed_random", po::value<bool>()->default_value(false), "whether to make the seed of random number in a random")
         ("seed", po::value<int>()->default_value(0), "seed of random number")
+        ("png_compression", po::value<int>()->default_value(-1), "zlib level of the saved PNG images from 0 (fastest) to 9 (smallest) : 'x=-1' is the default level of the encoder")
 
         // (2) Define for Training
         ("train", po::value<bool>()->default_value(false), "training mode on/off")
@@ -54,6 +57,8 @@ po::options_description parse_arguments(){
         ("batch_size", po::value<size_t>()->default_value(32), "training batch size")
         ("train_load_epoch", po::value<std::string>()->default_value(""), "epoch of model to resume learning")
         ("save_epoch", po::value<size_t>()->default_value(20), "frequency of epoch to save model and optimizer")
+        ("log_sync_iter", po::value<size_t>()->default_value(10), "frequency of iteration to copy the training losses to the host and write the log")
+        ("recompute_depths", po::value<std::string>()->default_value(""), "depths of U-Net blocks recomputed in backward to save activation memory : 'all' or 'd1,d2,...' (0 is the outermost)")
 
         // (3) Define for Validation
         ("valid", po::value<bool>()->default_value(false), "validation mode on/off")
@@ -68,6 +73,13 @@ po::options_description parse_arguments(){
         ("test_out_dir", po::value<std::string>()->default_value("testO"), "test output image directory : ./datasets/<dataset>/<test_out_dir>/<image files>")
         ("test_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for testing")
         ("test_result_dir", po::value<std::string>()->default_value("test_result"), "test result directory : ./<test_result_dir>")
+        ("test_archive", po::value<bool>()->default_value(false), "save the test images into ./<test_result_dir>/images.tar with its index images.tar.idx instead of one file per image")
+        ("test_batch_size", po::value<size_t>()->default_value(16), "test mini-batch size")
+        ("test_workers", po::value<size_t>()->default_value(4), "the number of workers to retrieve data from the test dataset")
+        ("test_tiled", po::value<bool>()->default_value(false), "sliding-window tiled inference at the original resolution of test images (tile size = size)")
+        ("tile_overlap", po::value<size_t>()->default_value(32), "overlap of neighboring tiles in tiled inference")
+        ("tile_batch_size", po::value<size_t>()->default_value(16), "the number of tiles forwarded at once in tiled inference")
+        ("test_fold_bn", po::value<bool>()->default_value(false), "fold BatchNorm into convolutions for inference and export the folded model : epoch_<test_load_epoch>_folded.pth")
 
         // (5) Define for Network Parameter
         ("lr", po::value<float>()->default_value(1e-4), "learning rate")
@@ -76,6 +88,11 @@ po::options_description parse_arguments(){
         ("nf", po::value<size_t>()->default_value(64), "the number of filters in convolution layer closest to image")
         ("no_dropout", po::value<bool>()->default_value(false), "Dropout off/on")
 
+        // (6) Define for Export
+        ("export", po::value<bool>()->default_value(false), "TorchScript export mode on/off")
+        ("export_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for exporting : ./checkpoints/<dataset>/models/epoch_<export_load_epoch>.pt")
+        ("export_batch_size", po::value<size_t>()->default_value(1), "batch size of the example input for tracing")
+
     ;
     
     // End Processing
@@ -97,6 +114,7 @@ int main(int argc, const char *argv[]){
         std::cout << args << std::endl;
         return 1;
     }
+    visualizer::set_writer(visualizer::writer::default_workers(), /*capacity=*/64, /*compression=*/vm["png_compression"].as<int>());
     
     // (2) Select Device
     torch::Device device = Set_Device(vm);
@@ -151,9 +169,22 @@ int main(int argc, const char *argv[]){
     // (8.2) Test Phase
     if (vm["test"].as<bool>()){
         Set_Options(vm, argc, argv, args, "test");
+        if (vm["test_tiled"].as<bool>()){
+            transformI.erase(transformI.end() - 3);  // {Resize,ToTensor,Normalize} ===> {ToTensor,Normalize}
+            transformO.erase(transformO.end() - 3);  // {Resize,ToTensor,Normalize} ===> {ToTensor,Normalize}
+        }
         test(vm, device, unet, transformI, transformO);
     }
 
+    // (8.3) Export Phase
+    if (vm["export"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "export");
+        torch::NoGradGuard no_grad;
+        std::string path = dir + "/models/epoch_" + vm["export_load_epoch"].as<std::string>();
+        torch::Tensor image = torch::zeros({(long int)vm["export_batch_size"].as<size_t>(), (long int)vm["input_nc"].as<size_t>(), (long int)vm["size"].as<size_t>(), (long int)vm["size"].as<size_t>()}).to(device);  // {N,C,H,W}
+        torchscript::export_model(unet, path, image);
+    }
+
     // End Processing
     return 0;
 
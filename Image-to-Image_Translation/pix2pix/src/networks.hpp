@@ -34,10 +34,11 @@ public:
 struct UNetBlockImpl : nn::Module{
 private:
     bool outermost;
+    bool recompute;
     nn::Sequential model;
 public:
     UNetBlockImpl(){}    
-    UNetBlockImpl(const std::pair<size_t, size_t> outside_nc, const size_t inside_nc, UNetBlockImpl &submodule, bool outermost_=false, bool innermost=false, bool use_dropout=false);
+    UNetBlockImpl(const std::pair<size_t, size_t> outside_nc, const size_t inside_nc, UNetBlockImpl &submodule, bool outermost_=false, bool innermost=false, bool use_dropout=false, bool recompute_=false);
     torch::Tensor forward(torch::Tensor x);
 };
 
@@ -1,8 +1,8 @@
 #include <iostream>                    // std::cout
-#include <fstream>                     // std::ifstream, std::ofstream
+#include <fstream>                     // std::ifstream
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
-#include <chrono>                      // std::chrono
+#include <vector>                      // std::vector
 #include <utility>                     // std::pair
 // For External Library
 #include <torch/torch.h>               // torch
@@ -14,6 +14,8 @@
 #include "datasets.hpp"                // datasets::ImageFolderPairWithPaths
 #include "dataloader.hpp"              // DataLoader::ImageFolderPairWithPaths
 #include "visualizer.hpp"              // visualizer
+#include "tiling.hpp"                  // tiling::SlidingWindow
+#include "evaluation.hpp"              // evaluation::Runner, evaluation::BufferedWriter
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -29,78 +31,85 @@ void test(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, std
 
     // (0) Initialization and Declaration
     float ave_loss_l1, ave_loss_l2;
-    double seconds, ave_time;
+    size_t i;
+    double ave_time;
     std::string path, result_dir, fname;
     std::string input_dir, output_dir;
-    std::ofstream ofs;
-    std::chrono::system_clock::time_point start, end;
+    std::vector<double> ave;
+    std::vector<std::vector<float>> rows;
     std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>, std::vector<std::string>> data;
     torch::Tensor realI, realO, fakeO;
     torch::Tensor loss_l1, loss_l2;
     datasets::ImageFolderPairWithPaths dataset;
     DataLoader::ImageFolderPairWithPaths dataloader;
+    evaluation::Runner runner;
+    evaluation::BufferedWriter ofs;
+    tiling::SlidingWindow tiler;
 
     // (1) Get Test Dataset
     input_dir = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_in_dir"].as<std::string>();
     output_dir = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_out_dir"].as<std::string>();
     dataset = datasets::ImageFolderPairWithPaths(input_dir, output_dir, transformI, transformO);
-    dataloader = DataLoader::ImageFolderPairWithPaths(dataset, /*batch_size_=*/1, /*shuffle_=*/false, /*num_workers_=*/0);
+    dataloader = DataLoader::ImageFolderPairWithPaths(dataset, /*batch_size_=*/(vm["test_tiled"].as<bool>() ? 1 : vm["test_batch_size"].as<size_t>()), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
     std::cout << "total test images : " << dataset.size() << std::endl << std::endl;
+    if (vm["test_tiled"].as<bool>()){
+        tiler = tiling::SlidingWindow(/*tile_=*/vm["size"].as<size_t>(), /*overlap_=*/vm["tile_overlap"].as<size_t>(), /*tile_batch_=*/vm["tile_batch_size"].as<size_t>());
+    }
 
     // (2) Get Model
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + "_gen.pth";
     torch::load(gen, path);
 
-    // (3) Set Loss Function
-    auto criterion_L1 = torch::nn::L1Loss(torch::nn::L1LossOptions().reduction(torch::kMean));
-    auto criterion_L2 = torch::nn::MSELoss(torch::nn::MSELossOptions().reduction(torch::kMean));
-
-    // (4) Initialization of Value
-    ave_loss_l1 = 0.0;
-    ave_loss_l2 = 0.0;
-    ave_time = 0.0;
-
-    // (5) Tensor Forward
+    // (3) Tensor Forward
+    torch::NoGradGuard no_grad;
     gen->train();  // Dropout is required to make the generated images diverse
     result_dir = vm["test_result_dir"].as<std::string>();  fs::create_directories(result_dir);
-    ofs.open(result_dir + "/loss.txt", std::ios::out);
+    if (vm["test_archive"].as<bool>()) visualizer::open_archive(result_dir + "/images.tar");
+    ofs.open(result_dir + "/loss.txt");
     while (dataloader(data)){
         
         realI = std::get<0>(data).to(device);
         realO = std::get<1>(data).to(device);
         
-        start = std::chrono::system_clock::now();
-        
-        fakeO = gen->forward(realI);
-
-        end = std::chrono::system_clock::now();
-        seconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 0.001 * 0.001;
-        
-        loss_l1 = criterion_L1(fakeO, realO);
-        loss_l2 = criterion_L2(fakeO, realO);
+        runner.start_timer();
         
-        ave_loss_l1 += loss_l1.item<float>();
-        ave_loss_l2 += loss_l2.item<float>();
-        ave_time += seconds;
-
-        std::cout << '<' << std::get<2>(data).at(0) << "> L1:" << loss_l1.item<float>() << " L2:" << loss_l2.item<float>() << std::endl;
-        ofs << '<' << std::get<2>(data).at(0) << "> L1:" << loss_l1.item<float>() << " L2:" << loss_l2.item<float>() << std::endl;
-
-        fname = result_dir + '/' + std::get<3>(data).at(0);
-        visualizer::save_image(fakeO.detach(), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        // (3.1) Metrics on Device
+        if (vm["test_tiled"].as<bool>()){
+            fakeO = tiler.blend([&](torch::Tensor tile){ return gen->forward(tile); }, realI);  // {N,C,H,W} ===> {N,C,H,W} (tiles of {size,size})
+        }
+        else{
+            fakeO = gen->forward(realI);
+        }
+        loss_l1 = (fakeO - realO).abs().view({fakeO.size(0), -1}).mean(/*dim=*/1);  // {N,C,H,W} ===> {N}
+        loss_l2 = (fakeO - realO).pow(2.0).view({fakeO.size(0), -1}).mean(/*dim=*/1);  // {N,C,H,W} ===> {N}
+
+        // (3.2) Synchronize Once per Mini Batch
+        rows = runner.push({loss_l1, loss_l2});  // {N} * 2 ===> {N,2}
+        fakeO = fakeO.to(torch::kCPU);
+
+        runner.stop_timer();
+
+        // (3.3) Write Results
+        for (i = 0; i < rows.size(); i++){
+            ofs << '<' << std::get<2>(data).at(i) << "> L1:" << rows.at(i).at(0) << " L2:" << rows.at(i).at(1) << '\n';
+            fname = result_dir + '/' + std::get<3>(data).at(i);
+            visualizer::save_image(fakeO.narrow(/*dim=*/0, i, 1), fname, /*range=*/output_range, /*cols=*/1, /*padding=*/0);
+        }
 
     }
 
-    // (6) Calculate Average
-    ave_loss_l1 = ave_loss_l1 / (float)dataset.size();
-    ave_loss_l2 = ave_loss_l2 / (float)dataset.size();
-    ave_time = ave_time / (double)dataset.size();
+    // (4) Calculate Average
+    ave = runner.get_ave();
+    ave_loss_l1 = (float)ave.at(0);
+    ave_loss_l2 = (float)ave.at(1);
+    ave_time = runner.get_ave_time();
 
-    // (7) Average Output
+    // (5) Average Output
     std::cout << "<All> L1:" << ave_loss_l1 << " L2:" << ave_loss_l2 << " (time:" << ave_time << ')' << std::endl;
-    ofs << "<All> L1:" << ave_loss_l1 << " L2:" << ave_loss_l2 << " (time:" << ave_time << ')' << std::endl;
+    ofs << "<All> L1:" << ave_loss_l1 << " L2:" << ave_loss_l2 << " (time:" << ave_time << ")\n";
 
     // Post Processing
+    if (vm["test_archive"].as<bool>()) visualizer::close_archive();
     ofs.close();
 
     // End Processing
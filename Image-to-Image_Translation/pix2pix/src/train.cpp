@@ -18,6 +18,7 @@
 #include "dataloader.hpp"              // DataLoader::ImageFolderPairWithPaths
 #include "visualizer.hpp"              // visualizer
 #include "progress.hpp"                // progress
+#include "metrics.hpp"                 // metrics
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -58,7 +59,7 @@ void train(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, Pa
     std::ofstream ofs, init, infoo;
     std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>, std::vector<std::string>> mini_batch;
     torch::Tensor realI, realO, fakeO, realP, fakeP, pair;
-    torch::Tensor dis_real_out, dis_fake_out;
+    torch::Tensor dis_out, dis_real_out, dis_fake_out;
     torch::Tensor gen_loss, G_L1_loss, G_GAN_loss;
     torch::Tensor dis_loss, dis_real_loss, dis_fake_loss;
     torch::Tensor label_real, label_fake;
@@ -67,6 +68,7 @@ void train(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, Pa
     visualizer::graph train_loss, train_loss_gen, train_loss_dis;
     visualizer::graph valid_loss, valid_loss_gen, valid_loss_dis;
     progress::display *show_progress;
+    metrics::logger *logger;
     progress::irregular irreg_progress;
 
 
@@ -121,6 +123,8 @@ void train(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, Pa
         gen->apply(weights_init);
         dis->apply(weights_init);
         ofs.open(checkpoint_dir + "/log/train.txt", std::ios::out);
+        init.open(checkpoint_dir + "/log/train.jsonl", std::ios::trunc);
+        init.close();
         if (vm["valid"].as<bool>()){
             init.open(checkpoint_dir + "/log/valid.txt", std::ios::trunc);
             init.close();
@@ -176,6 +180,7 @@ void train(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, Pa
         dis->train();
         ofs << std::endl << "epoch:" << epoch << '/' << total_epoch << std::endl;
         show_progress = new progress::display(/*count_max_=*/total_iter, /*epoch=*/{epoch, total_epoch}, /*loss_=*/{"G_GAN", "G_L1", "D_Real", "D_Fake"});
+        logger = new metrics::logger(show_progress, ofs, checkpoint_dir + "/log/train.jsonl", epoch, total_iter, /*loss_=*/{"G_GAN", "G_L1", "D_Real", "D_Fake"}, vm["log_sync_iter"].as<size_t>());
 
         // -----------------------------------
         // b1. Mini Batch Learning
@@ -190,18 +195,29 @@ void train(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, Pa
             // c1. Discriminator and Generator Training Phase
             // -----------------------------------
 
-            // (1) Generator and Discriminator Forward
+            // (1) Generator Forward
             fakeO = gen->forward(realI);
             fakeP = torch::cat({realI, fakeO.detach()}, /*dim=*/1);
-            dis_fake_out = dis->forward(fakeP);
+            realP = torch::cat({realI, realO}, /*dim=*/1);
 
-            // (2) Set Target Label
-            label_real = torch::full({dis_fake_out.size(0), dis_fake_out.size(1), dis_fake_out.size(2), dis_fake_out.size(3)}, /*value*/1.0, torch::TensorOptions().dtype(torch::kFloat)).to(device);
-            label_fake = torch::full({dis_fake_out.size(0), dis_fake_out.size(1), dis_fake_out.size(2), dis_fake_out.size(3)}, /*value*/0.0, torch::TensorOptions().dtype(torch::kFloat)).to(device);
+            // (2) Discriminator Forward
+            if (vm["dis_combined"].as<bool>()){
+                dis_out = dis->forward(torch::cat({fakeP, realP}, /*dim=*/0));                                    // {2N,IC+OC,256,256} ===> {2N,1,30,30}
+                dis_fake_out = dis_out.narrow(/*dim=*/0, /*start=*/0, /*length=*/mini_batch_size);                // {2N,1,30,30} ===> {N,1,30,30}
+                dis_real_out = dis_out.narrow(/*dim=*/0, /*start=*/mini_batch_size, /*length=*/mini_batch_size);  // {2N,1,30,30} ===> {N,1,30,30}
+            }
+            else{
+                dis_fake_out = dis->forward(fakeP);
+                dis_real_out = dis->forward(realP);
+            }
 
-            // (3) Discriminator Training
-            realP = torch::cat({realI, realO}, /*dim=*/1);
-            dis_real_out = dis->forward(realP);
+            // (3) Set Target Label (only when the shape of the discriminator output changes)
+            if (!label_real.defined() || (label_real.sizes() != dis_fake_out.sizes())){
+                label_real = torch::full(dis_fake_out.sizes(), /*value*/1.0, torch::TensorOptions().dtype(torch::kFloat).device(device));
+                label_fake = torch::full(dis_fake_out.sizes(), /*value*/0.0, torch::TensorOptions().dtype(torch::kFloat).device(device));
+            }
+
+            // (4) Discriminator Training
             dis_fake_loss = criterion_GAN(dis_fake_out, label_fake);
             dis_real_loss = criterion_GAN(dis_real_out, label_real);
             dis_loss = dis_real_loss + dis_fake_loss;
@@ -209,7 +225,7 @@ void train(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, Pa
             dis_loss.backward();
             dis_optimizer.step();
 
-            // (4) Generator Training
+            // (5) Generator Training
             fakeP = torch::cat({realI, fakeO}, /*dim=*/1);
             dis_fake_out = dis->forward(fakeP);
             G_GAN_loss = criterion_GAN(dis_fake_out, label_real);
@@ -222,17 +238,12 @@ void train(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, Pa
             // -----------------------------------
             // c2. Record Loss (iteration)
             // -----------------------------------
-            show_progress->increment(/*loss_value=*/{G_GAN_loss.item<float>(), G_L1_loss.item<float>(), dis_real_loss.item<float>(), dis_fake_loss.item<float>()});
-            ofs << "iters:" << show_progress->get_iters() << '/' << total_iter << ' ' << std::flush;
-            ofs << "G_GAN:" << G_GAN_loss.item<float>() << "(ave:" <<  show_progress->get_ave(0) << ") " << std::flush;
-            ofs << "G_L1:" << G_L1_loss.item<float>() << "(ave:" <<  show_progress->get_ave(1) << ") " << std::flush;
-            ofs << "D_Real:" << dis_real_loss.item<float>() << "(ave:" <<  show_progress->get_ave(2) << ") " << std::flush;
-            ofs << "D_Fake:" << dis_fake_loss.item<float>() << "(ave:" <<  show_progress->get_ave(3) << ")" << std::endl;
+            logger->push({G_GAN_loss, G_L1_loss, dis_real_loss, dis_fake_loss});
 
             // -----------------------------------
             // c3. Save Sample Images
             // -----------------------------------
-            iter = show_progress->get_iters();
+            iter = logger->get_iters();
             if (iter % save_sample_iter == 1){
                 ss.str(""); ss.clear(std::stringstream::goodbit);
                 ss << save_images_dir << "/epoch_" << epoch << "-iter_" << iter << '.' << extension;
@@ -256,6 +267,7 @@ void train(po::variables_map &vm, torch::Device &device, UNet_Generator &gen, Pa
         // -----------------------------------
         // b2. Record Loss (epoch)
         // -----------------------------------
+        delete logger;
         train_loss.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(0) + show_progress->get_ave(1), show_progress->get_ave(2) + show_progress->get_ave(3)});
         train_loss_gen.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(0) + show_progress->get_ave(1), show_progress->get_ave(0), show_progress->get_ave(1)});
         train_loss_dis.plot(/*base=*/epoch, /*value=*/{show_progress->get_ave(2) + show_progress->get_ave(3), show_progress->get_ave(2), show_progress->get_ave(3)});
@@ -0,0 +1,13 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./AlexNet \
+    --compress true \
+    --dataset ${DATA} \
+    --class_list "list/${DATA}.txt" \
+    --class_num 10 \
+    --size 227 \
+    --compress_energy 0.9 \
+    --gpu_id 0 \
+    --nc 1
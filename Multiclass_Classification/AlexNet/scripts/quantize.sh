@@ -0,0 +1,12 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./AlexNet \
+    --quantize true \
+    --dataset ${DATA} \
+    --class_list "list/${DATA}.txt" \
+    --class_num 10 \
+    --size 227 \
+    --gpu_id -1 \
+    --nc 1
@@ -12,6 +12,7 @@
 // For Original Header
 #include "networks.hpp"                // MC_AlexNet
 #include "transforms.hpp"              // transforms
+#include "torchscript.hpp"             // torchscript
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -20,6 +21,8 @@ namespace po = boost::program_options;
 // Function Prototype
 void train(po::variables_map &vm, torch::Device &device, MC_AlexNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
 void test(po::variables_map &vm, torch::Device &device, MC_AlexNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
+void quantize(po::variables_map &vm, MC_AlexNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
+void compress(po::variables_map &vm, torch::Device &device, MC_AlexNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
 torch::Device Set_Device(po::variables_map &vm);
 template <typename T> void Set_Model_Params(po::variables_map &vm, T &model, const std::string name);
 std::vector<std::string> Set_Class_Names(const std::string path, const size_t class_num);
@@ -53,6 +56,8 @@ po::options_description parse_arguments(){
         ("batch_size", po::value<size_t>()->default_value(32), "training batch size")
         ("train_load_epoch", po::value<std::string>()->default_value(""), "epoch of model to resume learning")
         ("save_epoch", po::value<size_t>()->default_value(20), "frequency of epoch to save model and optimizer")
+        ("log_sync_iter", po::value<size_t>()->default_value(10), "frequency of iteration to copy the training losses to the host and write the log")
+        ("train_init_path", po::value<std::string>()->default_value(""), "checkpoint to start new training from instead of the initialization (e.g. fine-tuning a factorized model)")
 
         // (3) Define for Validation
         ("valid", po::value<bool>()->default_value(false), "validation mode on/off")
@@ -65,11 +70,34 @@ po::options_description parse_arguments(){
         ("test_dir", po::value<std::string>()->default_value("test"), "test image directory : ./datasets/<dataset>/<test_dir>/<class name>/<image files>")
         ("test_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for testing")
         ("test_result_dir", po::value<std::string>()->default_value("test_result"), "test result directory : ./<test_result_dir>")
+        ("test_batch_size", po::value<size_t>()->default_value(16), "test mini-batch size")
+        ("test_workers", po::value<size_t>()->default_value(4), "the number of workers to retrieve data from the test dataset")
 
         // (5) Define for Network Parameter
         ("lr", po::value<float>()->default_value(1e-4), "learning rate")
         ("beta1", po::value<float>()->default_value(0.5), "beta 1 in Adam of optimizer method")
         ("beta2", po::value<float>()->default_value(0.999), "beta 2 in Adam of optimizer method")
+        ("fc_ranks", po::value<std::string>()->default_value(""), "ranks of the factorized fully connected layers : 'r1,r2,r3' (0 is full rank, and empty is all full rank)")
+
+        // (6) Define for Export
+        ("export", po::value<bool>()->default_value(false), "TorchScript export mode on/off")
+        ("export_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for exporting : ./checkpoints/<dataset>/models/epoch_<export_load_epoch>.pt")
+        ("export_batch_size", po::value<size_t>()->default_value(1), "batch size of the example input for tracing")
+
+        // (7) Define for Quantization
+        ("quantize", po::value<bool>()->default_value(false), "post-training int8 quantization mode on/off (CPU)")
+        ("quantize_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch to quantize into ./checkpoints/<dataset>/models/epoch_<quantize_load_epoch>_int8.pth")
+        ("quantize_engine", po::value<std::string>()->default_value("fbgemm"), "quantized kernels : fbgemm (x86) or qnnpack (ARM)")
+        ("quantize_calib_images", po::value<size_t>()->default_value(512), "the number of training images for calibration")
+        ("quantize_calib_batch_size", po::value<size_t>()->default_value(32), "calibration mini-batch size")
+        ("quantize_result_dir", po::value<std::string>()->default_value("quantize_result"), "quantization report directory : ./<quantize_result_dir>")
+
+        // (8) Define for Compression
+        ("compress", po::value<bool>()->default_value(false), "low-rank factorization mode of the fully connected layers on/off")
+        ("compress_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch to factorize into ./checkpoints/<dataset>/models/epoch_<compress_load_epoch>_lowrank.pth")
+        ("compress_rank", po::value<size_t>()->default_value(0), "rank of the factorized layers : 'x=0' uses the energy threshold")
+        ("compress_energy", po::value<float>()->default_value(0.9), "ratio of the squared singular values kept by the factorized layers")
+        ("compress_result_dir", po::value<std::string>()->default_value("compress_result"), "compression report directory : ./<compress_result_dir>")
 
     ;
     
@@ -144,6 +172,27 @@ int main(int argc, const char *argv[]){
         test(vm, device, model, transform, class_names);
     }
 
+    // (9.3) Export Phase
+    if (vm["export"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "export");
+        torch::NoGradGuard no_grad;
+        std::string path = dir + "/models/epoch_" + vm["export_load_epoch"].as<std::string>();
+        torch::Tensor image = torch::zeros({(long int)vm["export_batch_size"].as<size_t>(), (long int)vm["nc"].as<size_t>(), (long int)vm["size"].as<size_t>(), (long int)vm["size"].as<size_t>()}).to(device);  // {N,C,H,W}
+        torchscript::export_model(model, path, image);
+    }
+
+    // (9.4) Quantization Phase
+    if (vm["quantize"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "quantize");
+        quantize(vm, model, transform, class_names);
+    }
+
+    // (9.5) Compression Phase
+    if (vm["compress"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "compress");
+        compress(vm, device, model, transform, class_names);
+    }
+
     // End Processing
     return 0;
 
@@ -1,8 +1,10 @@
+#include <vector>
 #include <typeinfo>
 // For External Library
 #include <torch/torch.h>
 // For Original Header
 #include "networks.hpp"
+#include "lowrank.hpp"
 
 // Define Namespace
 namespace nn = torch::nn;
@@ -36,14 +38,15 @@ MC_AlexNetImpl::MC_AlexNetImpl(po::variables_map &vm){
     this->avgpool = nn::Sequential(nn::AdaptiveAvgPool2d(nn::AdaptiveAvgPool2dOptions({6, 6})));  // {256,X,X} ===> {256,6,6}
     register_module("avgpool", this->avgpool);
 
+    std::vector<long int> ranks = lowrank::parse_ranks(vm["fc_ranks"].as<std::string>(), /*num=*/3);  // low-rank factorization of the fully connected layers
     this->classifier = nn::Sequential(
         nn::Dropout(0.5),
-        nn::Linear(/*in_channels=*/256*6*6, /*out_channels=*/4096),                      // {256*6*6} ===> {4096}
+        lowrank::linear(/*in_features=*/256*6*6, /*out_features=*/4096, /*rank=*/ranks.at(0)),                         // {256*6*6} ===> {4096}
         nn::ReLU(nn::ReLUOptions().inplace(true)),
         nn::Dropout(0.5),
-        nn::Linear(/*in_channels=*/4096, /*out_channels=*/4096),                         // {4096} ===> {4096}
+        lowrank::linear(/*in_features=*/4096, /*out_features=*/4096, /*rank=*/ranks.at(1)),                            // {4096} ===> {4096}
         nn::ReLU(nn::ReLUOptions().inplace(true)),
-        nn::Linear(/*in_channels=*/4096, /*out_channels=*/vm["class_num"].as<size_t>())  // {4096} ===> {CN}
+        lowrank::linear(/*in_features=*/4096, /*out_features=*/vm["class_num"].as<size_t>(), /*rank=*/ranks.at(2))  // {4096} ===> {CN}
     );
     register_module("classifier", this->classifier);
 
@@ -0,0 +1,103 @@
+#include <iostream>                    // std::cout
+#include <fstream>                     // std::ofstream
+#include <filesystem>                  // std::filesystem
+#include <string>                      // std::string
+#include <vector>                      // std::vector
+#include <tuple>                       // std::tuple
+#include <utility>                     // std::pair
+#include <algorithm>                   // std::min
+// For External Library
+#include <torch/torch.h>               // torch
+#include <boost/program_options.hpp>   // boost::program_options
+// For Original Header
+#include "networks.hpp"                // MC_AlexNet
+#include "transforms.hpp"              // transforms::Compose
+#include "datasets.hpp"                // datasets::ImageFolderClassesWithPaths
+#include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
+#include "fusion.hpp"                  // fusion::fold_batchnorm
+#include "quantization.hpp"            // quantization
+#include "evaluate.hpp"                // evaluate
+
+// Define Namespace
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+// ---------------------------
+// Quantization Function
+// ---------------------------
+// The quantized kernels run on the CPU only, so the model is moved to the CPU regardless of "gpu_id".
+void quantize(po::variables_map &vm, MC_AlexNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names){
+
+    // (0) Initialization and Declaration
+    size_t calib_num;
+    size_t observed, converted;
+    float accuracy_fp32, accuracy_int8;
+    double time_fp32, time_int8;
+    std::string path, result_dir;
+    std::string dataroot;
+    std::ofstream ofs;
+    torch::Device device(torch::kCPU);
+    std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>> data;
+    torch::Tensor image;
+    datasets::ImageFolderClassesWithPaths calib_dataset, test_dataset;
+    DataLoader::ImageFolderClassesWithPaths calib_dataloader, test_dataloader;
+
+    // (1) Set Quantization Engine
+    quantization::set_engine(vm["quantize_engine"].as<std::string>());
+
+    // (2) Get Calibration and Test Dataset
+    dataroot = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["train_dir"].as<std::string>();
+    calib_dataset = datasets::ImageFolderClassesWithPaths(dataroot, transform, class_names);
+    calib_dataloader = DataLoader::ImageFolderClassesWithPaths(calib_dataset, /*batch_size_=*/vm["quantize_calib_batch_size"].as<size_t>(), /*shuffle_=*/true, /*num_workers_=*/vm["test_workers"].as<size_t>());
+    dataroot = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_dir"].as<std::string>();
+    test_dataset = datasets::ImageFolderClassesWithPaths(dataroot, transform, class_names);
+    test_dataloader = DataLoader::ImageFolderClassesWithPaths(test_dataset, /*batch_size_=*/vm["test_batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
+    std::cout << "total calibration images : " << std::min(calib_dataset.size(), vm["quantize_calib_images"].as<size_t>()) << std::endl;
+    std::cout << "total test images : " << test_dataset.size() << std::endl << std::endl;
+
+    // (3) Get Model
+    path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["quantize_load_epoch"].as<std::string>();
+    torch::load(model, path + ".pth");
+    model->to(device);
+    torch::NoGradGuard no_grad;
+    model->eval();
+
+    // (4) FP32 Evaluation
+    std::tie(accuracy_fp32, time_fp32) = evaluate(device, model, test_dataloader, class_names.size());
+    std::cout << "<FP32> accuracy:" << accuracy_fp32 << " (time:" << time_fp32 << ')' << std::endl;
+
+    // (5) Calibration
+    fusion::fold_batchnorm(model.ptr());
+    observed = quantization::prepare(model.ptr());
+    calib_num = 0;
+    while ((calib_num < vm["quantize_calib_images"].as<size_t>()) && calib_dataloader(data)){
+        image = std::get<0>(data);
+        model->forward(image);
+        calib_num += image.size(0);
+    }
+
+    // (6) Conversion
+    converted = quantization::convert(model.ptr());
+    quantization::pack(model.ptr());
+    torch::save(model, path + "_int8.pth");
+    std::cout << "quantized layers : " << converted << '/' << observed << " (" << path << "_int8.pth)" << std::endl;
+
+    // (7) INT8 Evaluation
+    std::tie(accuracy_int8, time_int8) = evaluate(device, model, test_dataloader, class_names.size());
+    std::cout << "<INT8> accuracy:" << accuracy_int8 << " (time:" << time_int8 << ')' << std::endl;
+
+    // (8) Report
+    result_dir = vm["quantize_result_dir"].as<std::string>();  fs::create_directories(result_dir);
+    ofs.open(result_dir + "/report.txt", std::ios::out);
+    ofs << "engine:" << vm["quantize_engine"].as<std::string>() << " calibration-images:" << calib_num << " quantized-layers:" << converted << std::endl;
+    ofs << "<FP32> accuracy:" << accuracy_fp32 << " time[s/image]:" << time_fp32 << " size[B]:" << fs::file_size(path + ".pth") << std::endl;
+    ofs << "<INT8> accuracy:" << accuracy_int8 << " time[s/image]:" << time_int8 << " size[B]:" << fs::file_size(path + "_int8.pth") << std::endl;
+    ofs << "accuracy-drop:" << accuracy_fp32 - accuracy_int8 << " speedup:" << time_fp32 / time_int8 << std::endl;
+    ofs.close();
+    std::cout << "accuracy-drop:" << accuracy_fp32 - accuracy_int8 << " speedup:" << time_fp32 / time_int8 << std::endl;
+
+    // End Processing
+    return;
+
+}
@@ -11,6 +11,7 @@
 #include "networks.hpp"                // MC_AlexNet
 #include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
 #include "visualizer.hpp"              // visualizer::graph
+#include "evaluation.hpp"              // evaluation::ConfusionMatrix
 
 // Define Namespace
 namespace po = boost::program_options;
@@ -22,71 +23,58 @@ namespace po = boost::program_options;
 void valid(po::variables_map &vm, DataLoader::ImageFolderClassesWithPaths &valid_dataloader, torch::Device &device, Loss &criterion, MC_AlexNet &model, const std::vector<std::string> class_names, const size_t epoch, visualizer::graph &writer, visualizer::graph &writer_accuracy, visualizer::graph &writer_each_accuracy){
 
     constexpr size_t class_num_thresh = 10;  // threshold for the number of classes for determining whether to display accuracy graph for each class
+    constexpr size_t topk = 5;  // the number of candidates for top-k accuracy
 
     // (0) Initialization and Declaration
     size_t iteration;
-    size_t mini_batch_size;
     size_t class_num;
-    size_t total_match, total_counter;
-    long int response, answer;
-    float total_accuracy;
-    float ave_loss, total_loss;
+    float total_accuracy, topk_accuracy, macro_f1;
+    float ave_loss;
     std::ofstream ofs;
-    std::vector<size_t> class_match, class_counter;
     std::vector<float> class_accuracy;
     std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>> mini_batch;
-    torch::Tensor loss, image, label, output, responses;
+    torch::Tensor loss, image, label, output;
+    torch::Tensor total_loss;
+    evaluation::ConfusionMatrix confusion;
 
     // (1) Memory Allocation
     class_num = class_names.size();
-    class_match = std::vector<size_t>(class_num, 0);
-    class_counter = std::vector<size_t>(class_num, 0);
-    class_accuracy = std::vector<float>(class_num, 0.0);
+    confusion = evaluation::ConfusionMatrix(class_num, /*k_=*/topk);
 
     // (2) Tensor Forward per Mini Batch
+    torch::NoGradGuard no_grad;
     model->eval();
     iteration = 0;
-    total_loss = 0.0;
-    total_match = 0; total_counter = 0;
+    total_loss = torch::zeros({}).to(device);
     while (valid_dataloader(mini_batch)){
         
         image = std::get<0>(mini_batch).to(device);
         label = std::get<1>(mini_batch).to(device);
-        mini_batch_size = image.size(0);
 
         output = model->forward(image);
         loss = criterion(output, label);
 
-        responses = output.exp().argmax(/*dim=*/1);
-        for (size_t i = 0; i < mini_batch_size; i++){
-            response = responses[i].item<long int>();
-            answer = label[i].item<long int>();
-            class_counter[answer]++;
-            total_counter++;
-            if (response == answer){
-                class_match[answer]++;
-                total_match++;
-            }
-        }
-
-        total_loss += loss.item<float>();
+        confusion.update(output, label);
+        total_loss += loss.detach();
         iteration++;
     }
 
     // (3) Calculate Average Loss
-    ave_loss = total_loss / (float)iteration;
+    ave_loss = total_loss.item<float>() / (float)iteration;
 
     // (4) Calculate Accuracy
-    for (size_t i = 0; i < class_num; i++){
-        class_accuracy[i] = (float)class_match[i] / (float)class_counter[i];
-    }
-    total_accuracy = (float)total_match / (float)total_counter;
+    class_accuracy = confusion.class_accuracy();
+    total_accuracy = confusion.accuracy();
+    topk_accuracy = confusion.topk_accuracy();
+    macro_f1 = confusion.macro_f1();
 
     // (5.1) Record Loss (Log/Loss)
     ofs.open("checkpoints/" + vm["dataset"].as<std::string>() + "/log/valid.txt", std::ios::app);
     ofs << "epoch:" << epoch << '/' << vm["epochs"].as<size_t>() << ' ' << std::flush;
     ofs << "classify:" << ave_loss << ' ' << std::flush;
-    ofs << "accuracy:" << total_accuracy << std::endl;
+    ofs << "accuracy:" << total_accuracy << ' ' << std::flush;
+    ofs << "top" << confusion.get_k() << "-accuracy:" << topk_accuracy << ' ' << std::flush;
+    ofs << "macro-F1:" << macro_f1 << std::endl;
     ofs.close();
 
     // (5.2) Record Loss (Log/Accuracy)
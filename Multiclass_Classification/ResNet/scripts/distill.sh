@@ -0,0 +1,19 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./ResNet \
+    --train true \
+    --n_layers 18 \
+    --nf 32 \
+    --teacher_checkpoint "checkpoints/${DATA}_teacher/models/epoch_latest.pth" \
+    --teacher_n_layers 152 \
+    --teacher_nf 64 \
+    --epochs 300 \
+    --dataset ${DATA} \
+    --class_list "list/${DATA}.txt" \
+    --class_num 10 \
+    --size 224 \
+    --batch_size 16 \
+    --gpu_id 0 \
+    --nc 1
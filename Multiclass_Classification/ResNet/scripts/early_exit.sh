@@ -0,0 +1,19 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./ResNet \
+    --train true \
+    --test true \
+    --early_exit true \
+    --exit_loss_weight 0.3 \
+    --test_exit_threshold 0.9 \
+    --n_layers 50 \
+    --epochs 300 \
+    --dataset ${DATA} \
+    --class_list "list/${DATA}.txt" \
+    --class_num 10 \
+    --size 224 \
+    --batch_size 16 \
+    --gpu_id 0 \
+    --nc 1
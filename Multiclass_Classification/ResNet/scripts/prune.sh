@@ -0,0 +1,16 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./ResNet \
+    --prune true \
+    --n_layers 50 \
+    --dataset ${DATA} \
+    --class_list "list/${DATA}.txt" \
+    --class_num 10 \
+    --size 224 \
+    --prune_ratio 0.3 \
+    --prune_cycles 3 \
+    --prune_finetune_epochs 5 \
+    --gpu_id 0 \
+    --nc 1
@@ -0,0 +1,13 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./ResNet \
+    --quantize true \
+    --n_layers 50 \
+    --dataset ${DATA} \
+    --class_list "list/${DATA}.txt" \
+    --class_num 10 \
+    --size 224 \
+    --gpu_id -1 \
+    --nc 1
@@ -0,0 +1,136 @@
+#include <iostream>                    // std::cout
+#include <fstream>                     // std::ifstream, std::ofstream
+#include <filesystem>                  // std::filesystem
+#include <string>                      // std::string
+#include <tuple>                       // std::tuple
+#include <vector>                      // std::vector
+#include <map>                         // std::map
+#include <sstream>                     // std::stringstream
+#include <iterator>                    // std::istreambuf_iterator
+// For External Library
+#include <torch/torch.h>               // torch
+#include <boost/program_options.hpp>   // boost::program_options
+// For Original Header
+#include "networks.hpp"                // MC_ResNet
+#include "datasets.hpp"                // datasets::ImageFolderClassesWithPaths
+#include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
+
+// Define Namespace
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+// -------------------------------
+// Teacher Model Function
+// -------------------------------
+// Build the teacher with its own depth and width, and freeze it in inference mode.
+MC_ResNet get_teacher(po::variables_map &vm, torch::Device &device){
+
+    po::variables_map vm_teacher = vm;
+    vm_teacher.at("n_layers").value() = vm["teacher_n_layers"].as<size_t>();
+    vm_teacher.at("nf").value() = vm["teacher_nf"].as<size_t>();
+    vm_teacher.at("block_widths").value() = std::string("");
+    vm_teacher.at("early_exit").value() = false;
+
+    MC_ResNet teacher(vm_teacher);
+    teacher->to(device);
+    torch::load(teacher, vm["teacher_checkpoint"].as<std::string>());
+    teacher->eval();
+    for (auto &param : teacher->parameters()){
+        param.set_requires_grad(false);
+    }
+    std::cout << "teacher model : ResNet-" << vm["teacher_n_layers"].as<size_t>() << " (" << vm["teacher_checkpoint"].as<std::string>() << ')' << std::endl;
+
+    return teacher;
+
+}
+
+
+// -------------------------------
+// Teacher Logits Cache Function
+// -------------------------------
+// Outputs of the teacher for every training image, computed once and saved to "<teacher_cache_dir>/{logits.pth,names.txt,config.txt}".
+// The cache assumes the deterministic transform of the training data, and is rebuilt when the teacher configuration differs or the teacher checkpoint is newer.
+torch::Tensor get_teacher_logits(po::variables_map &vm, torch::Device &device, MC_ResNet &teacher, datasets::ImageFolderClassesWithPaths &dataset, std::map<std::string, long int> &index){
+
+    // (0) Initialization and Declaration
+    long int i;
+    std::string cache_dir, path_logits, path_names, path_config, name, config, cached_config;
+    std::stringstream ss;
+    std::ifstream ifs;
+    std::ofstream ofs;
+    std::vector<torch::Tensor> outputs;
+    std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>> mini_batch;
+    torch::Tensor logits;
+    DataLoader::ImageFolderClassesWithPaths dataloader;
+
+    cache_dir = vm["teacher_cache_dir"].as<std::string>();
+    if (cache_dir == "") cache_dir = vm["checkpoint_dir"].as<std::string>() + "/teacher_cache";
+    path_logits = cache_dir + "/logits.pth";
+    path_names = cache_dir + "/names.txt";
+    path_config = cache_dir + "/config.txt";
+    index.clear();
+
+    // (1) Teacher Configuration as the Key of the Cache
+    ss << "teacher_checkpoint " << fs::weakly_canonical(vm["teacher_checkpoint"].as<std::string>()).string() << std::endl;
+    ss << "teacher_n_layers " << vm["teacher_n_layers"].as<size_t>() << std::endl;
+    ss << "teacher_nf " << vm["teacher_nf"].as<size_t>() << std::endl;
+    ss << "size " << vm["size"].as<size_t>() << std::endl;
+    ss << "nc " << vm["nc"].as<size_t>() << std::endl;
+    ss << "class_num " << vm["class_num"].as<size_t>() << std::endl;
+    ss << "train_dir " << fs::weakly_canonical("datasets/" + vm["dataset"].as<std::string>() + "/" + vm["train_dir"].as<std::string>()).string() << std::endl;
+    config = ss.str();
+    if (fs::exists(path_config)){
+        ifs.open(path_config, std::ios::in);
+        cached_config = std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        ifs.close();
+    }
+
+    // (2) Load Cache
+    if ((cached_config == config) && fs::exists(path_logits) && fs::exists(path_names) && (fs::last_write_time(path_logits) >= fs::last_write_time(vm["teacher_checkpoint"].as<std::string>()))){
+        torch::load(logits, path_logits);
+        ifs.open(path_names, std::ios::in);
+        i = 0;
+        while (std::getline(ifs, name)){
+            index[name] = i++;
+        }
+        ifs.close();
+        if ((i == logits.size(0)) && ((long int)index.size() == i) && ((size_t)i == dataset.size())){  // one row for each distinct training image
+            std::cout << "teacher logits : " << path_logits << " (cached)" << std::endl;
+            return logits;
+        }
+        index.clear();
+    }
+
+    // (3) Teacher Forward for All Training Images
+    torch::NoGradGuard no_grad;
+    dataloader = DataLoader::ImageFolderClassesWithPaths(dataset, vm["batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/4);
+    i = 0;
+    while (dataloader(mini_batch)){
+        outputs.push_back(teacher->forward(std::get<0>(mini_batch).to(device)).to(torch::kCPU, torch::kHalf));  // {N,C,H,W} ===> {N,CN}
+        for (auto &file : std::get<2>(mini_batch)){
+            index[file] = i++;
+        }
+    }
+    logits = torch::cat(outputs, /*dim=*/0);  // {N,CN} * B ===> {M,CN}
+
+    // (4) Save Cache
+    fs::create_directories(cache_dir);
+    torch::save(logits, path_logits);
+    std::vector<std::string> names(index.size());
+    for (auto &[file, row] : index){
+        names.at(row) = file;
+    }
+    ofs.open(path_names, std::ios::out);
+    for (auto &file : names){
+        ofs << file << std::endl;
+    }
+    ofs.close();
+    ofs.open(path_config, std::ios::out);
+    ofs << config;
+    ofs.close();
+    std::cout << "teacher logits : " << path_logits << " (" << logits.size(0) << " images)" << std::endl;
+
+    return logits;
+
+}
@@ -12,3 +12,27 @@ torch::Tensor Loss::operator()(torch::Tensor &input, torch::Tensor &target){
     static auto criterion = torch::nn::NLLLoss(torch::nn::NLLLossOptions().ignore_index(-100).reduction(torch::kMean));
     return criterion(input, target);
 }
+
+
+// -----------------------------------
+// class{DistillationLoss} -> constructor
+// -----------------------------------
+DistillationLoss::DistillationLoss(const float T_, const float alpha_){
+    this->T = T_;
+    this->alpha = alpha_;
+}
+
+
+// -----------------------------------
+// class{DistillationLoss} -> operator
+// -----------------------------------
+// alpha * T^2 * KL(teacher^T || student^T) + (1 - alpha) * NLL(student, label)
+// The inputs are log-probabilities, which give the same softmax as the logits after the temperature scaling.
+torch::Tensor DistillationLoss::operator()(torch::Tensor &input, torch::Tensor &teacher, torch::Tensor &target){
+    static auto criterion = torch::nn::NLLLoss(torch::nn::NLLLossOptions().ignore_index(-100).reduction(torch::kMean));
+    torch::Tensor student_T = torch::log_softmax(input / this->T, /*dim=*/1);   // {N,CN}
+    torch::Tensor teacher_T = torch::log_softmax(teacher / this->T, /*dim=*/1);  // {N,CN}
+    torch::Tensor soft = (teacher_T.exp() * (teacher_T - student_T)).sum(/*dim=*/1).mean() * this->T * this->T;
+    torch::Tensor hard = criterion(input, target);
+    return this->alpha * soft + (1.0 - this->alpha) * hard;
+}
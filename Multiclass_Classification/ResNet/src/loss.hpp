@@ -15,4 +15,17 @@ public:
 };
 
 
+// -------------------------
+// class{DistillationLoss}
+// -------------------------
+class DistillationLoss{
+private:
+    float T, alpha;
+public:
+    DistillationLoss(){}
+    DistillationLoss(const float T_, const float alpha_);
+    torch::Tensor operator()(torch::Tensor &input, torch::Tensor &teacher, torch::Tensor &target);
+};
+
+
 #endif
\ No newline at end of file
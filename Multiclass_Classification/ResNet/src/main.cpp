@@ -12,6 +12,7 @@
 // For Original Header
 #include "networks.hpp"                // MC_ResNet
 #include "transforms.hpp"              // transforms
+#include "torchscript.hpp"             // torchscript
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -20,6 +21,8 @@ namespace po = boost::program_options;
 // Function Prototype
 void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
 void test(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
+void quantize(po::variables_map &vm, MC_ResNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
+void prune(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
 torch::Device Set_Device(po::variables_map &vm);
 template <typename T> void Set_Model_Params(po::variables_map &vm, T &model, const std::string name);
 std::vector<std::string> Set_Class_Names(const std::string path, const size_t class_num);
@@ -38,6 +41,7 @@ po::options_description parse_arguments(){
         // (1) Define for General Parameter
         ("help", "produce help message")
         ("dataset", po::value<std::string>(), "dataset name")
+        ("checkpoint_dir", po::value<std::string>()->default_value(""), "directory of models, optimizers and logs : ./<checkpoint_dir> (default: ./checkpoints/<dataset>)")
         ("class_list", po::value<std::string>()->default_value("list/ImageNet.txt"), "file name in which class names are listed")
         ("class_num", po::value<size_t>()->default_value(1000), "total classes")
         ("size", po::value<size_t>()->default_value(224), "image width and height")
@@ -53,6 +57,16 @@ po::options_description parse_arguments(){
         ("batch_size", po::value<size_t>()->default_value(32), "training batch size")
         ("train_load_epoch", po::value<std::string>()->default_value(""), "epoch of model to resume learning")
         ("save_epoch", po::value<size_t>()->default_value(20), "frequency of epoch to save model and optimizer")
+        ("log_sync_iter", po::value<size_t>()->default_value(10), "frequency of iteration to copy the training losses to the host and write the log")
+        ("train_init_path", po::value<std::string>()->default_value(""), "checkpoint to start new training from instead of the initialization (e.g. fine-tuning a pruned model)")
+        ("teacher_checkpoint", po::value<std::string>()->default_value(""), "checkpoint of the teacher for knowledge distillation : empty is training without a teacher")
+        ("teacher_n_layers", po::value<size_t>()->default_value(152), "the number of layer in the teacher model")
+        ("teacher_nf", po::value<size_t>()->default_value(64), "the number of filters in convolution layer closest to image in the teacher model")
+        ("teacher_cache", po::value<bool>()->default_value(true), "whether to compute the teacher outputs once and cache them to disk (the training transform must be deterministic)")
+        ("teacher_cache_dir", po::value<std::string>()->default_value(""), "cache directory of the teacher outputs : empty is ./checkpoints/<dataset>/teacher_cache")
+        ("kd_temperature", po::value<float>()->default_value(4.0), "temperature of the soft targets")
+        ("kd_alpha", po::value<float>()->default_value(0.9), "weight of the soft targets against the hard labels")
+        ("exit_loss_weight", po::value<float>()->default_value(0.3), "weight of the loss of each early-exit classifier")
 
         // (3) Define for Validation
         ("valid", po::value<bool>()->default_value(false), "validation mode on/off")
@@ -65,6 +79,10 @@ po::options_description parse_arguments(){
         ("test_dir", po::value<std::string>()->default_value("test"), "test image directory : ./datasets/<dataset>/<test_dir>/<class name>/<image files>")
         ("test_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for testing")
         ("test_result_dir", po::value<std::string>()->default_value("test_result"), "test result directory : ./<test_result_dir>")
+        ("test_batch_size", po::value<size_t>()->default_value(16), "test mini-batch size")
+        ("test_workers", po::value<size_t>()->default_value(4), "the number of workers to retrieve data from the test dataset")
+        ("test_fold_bn", po::value<bool>()->default_value(false), "fold BatchNorm into convolutions for inference and export the folded model : epoch_<test_load_epoch>_folded.pth")
+        ("test_exit_threshold", po::value<float>()->default_value(0.9), "confidence for a sample to exit at an early-exit classifier")
 
         // (5) Define for Network Parameter
         ("lr", po::value<float>()->default_value(1e-4), "learning rate")
@@ -72,6 +90,31 @@ po::options_description parse_arguments(){
         ("beta2", po::value<float>()->default_value(0.999), "beta 2 in Adam of optimizer method")
         ("nf", po::value<size_t>()->default_value(64), "the number of filters in convolution layer closest to image")
         ("n_layers", po::value<size_t>(), "the number of layer in model")
+        ("early_exit", po::value<bool>()->default_value(false), "whether to add the early-exit classifiers after layer2 and layer3")
+        ("block_widths", po::value<std::string>()->default_value(""), "file of the inner widths of the residual blocks for the pruned model : ./<prune_checkpoint_dir>/models/epoch_<prune_load_epoch>_pruned.txt")
+
+        // (6) Define for Export
+        ("export", po::value<bool>()->default_value(false), "TorchScript export mode on/off")
+        ("export_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch used for exporting : ./checkpoints/<dataset>/models/epoch_<export_load_epoch>.pt")
+        ("export_batch_size", po::value<size_t>()->default_value(1), "batch size of the example input for tracing")
+
+        // (7) Define for Quantization
+        ("quantize", po::value<bool>()->default_value(false), "post-training int8 quantization mode on/off (CPU)")
+        ("quantize_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch to quantize into ./checkpoints/<dataset>/models/epoch_<quantize_load_epoch>_int8.pth")
+        ("quantize_engine", po::value<std::string>()->default_value("fbgemm"), "quantized kernels : fbgemm (x86) or qnnpack (ARM)")
+        ("quantize_calib_images", po::value<size_t>()->default_value(512), "the number of training images for calibration")
+        ("quantize_calib_batch_size", po::value<size_t>()->default_value(32), "calibration mini-batch size")
+        ("quantize_result_dir", po::value<std::string>()->default_value("quantize_result"), "quantization report directory : ./<quantize_result_dir>")
+
+        // (8) Define for Pruning
+        ("prune", po::value<bool>()->default_value(false), "structured channel pruning mode on/off")
+        ("prune_load_epoch", po::value<std::string>()->default_value("latest"), "training epoch to prune into ./<prune_checkpoint_dir>/models/epoch_<prune_load_epoch>_pruned.pth")
+        ("prune_criterion", po::value<std::string>()->default_value("bn"), "importance of channels : bn (BatchNorm gamma) or l1 (L1 norm of filters)")
+        ("prune_ratio", po::value<float>()->default_value(0.3), "ratio of the inner channels of residual blocks removed in each cycle")
+        ("prune_cycles", po::value<size_t>()->default_value(1), "the number of pruning and fine-tuning cycles")
+        ("prune_finetune_epochs", po::value<size_t>()->default_value(0), "training epochs of fine-tuning after each pruning : 'x=0' skips fine-tuning")
+        ("prune_result_dir", po::value<std::string>()->default_value("prune_result"), "pruning report directory : ./<prune_result_dir>")
+        ("prune_checkpoint_dir", po::value<std::string>()->default_value(""), "directory of the pruned and fine-tuned models : ./<prune_checkpoint_dir> (default: ./<checkpoint_dir>_pruned)")
 
     ;
     
@@ -94,6 +137,9 @@ int main(int argc, const char *argv[]){
         std::cout << args << std::endl;
         return 1;
     }
+    if (vm["checkpoint_dir"].as<std::string>() == ""){
+        vm.at("checkpoint_dir").value() = "checkpoints/" + vm["dataset"].as<std::string>();
+    }
     
     // (2) Select Device
     torch::Device device = Set_Device(vm);
@@ -125,7 +171,7 @@ int main(int argc, const char *argv[]){
     model->to(device);
     
     // (6) Make Directories
-    std::string dir = "checkpoints/" + vm["dataset"].as<std::string>();
+    std::string dir = vm["checkpoint_dir"].as<std::string>();
     fs::create_directories(dir);
 
     // (7) Save Model Parameters
@@ -146,6 +192,27 @@ int main(int argc, const char *argv[]){
         test(vm, device, model, transform, class_names);
     }
 
+    // (9.3) Export Phase
+    if (vm["export"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "export");
+        torch::NoGradGuard no_grad;
+        std::string path = dir + "/models/epoch_" + vm["export_load_epoch"].as<std::string>();
+        torch::Tensor image = torch::zeros({(long int)vm["export_batch_size"].as<size_t>(), (long int)vm["nc"].as<size_t>(), (long int)vm["size"].as<size_t>(), (long int)vm["size"].as<size_t>()}).to(device);  // {N,C,H,W}
+        torchscript::export_model(model, path, image);
+    }
+
+    // (9.4) Quantization Phase
+    if (vm["quantize"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "quantize");
+        quantize(vm, model, transform, class_names);
+    }
+
+    // (9.5) Pruning Phase
+    if (vm["prune"].as<bool>()){
+        Set_Options(vm, argc, argv, args, "prune");
+        prune(vm, device, model, transform, class_names);
+    }
+
     // End Processing
     return 0;
 
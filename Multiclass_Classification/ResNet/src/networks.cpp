@@ -1,11 +1,14 @@
 #include <iostream>
+#include <string>
 #include <vector>
+#include <memory>
 #include <typeinfo>
 #include <cstdlib>
 // For External Library
 #include <torch/torch.h>
 // For Original Header
 #include "networks.hpp"
+#include "pruning.hpp"
 
 // Define Namespace
 namespace nn = torch::nn;
@@ -47,6 +50,10 @@ MC_ResNetImpl::MC_ResNetImpl(po::variables_map &vm){
     }
     size_t feature = vm["nf"].as<size_t>();
     this->inplanes = vm["nf"].as<size_t>();
+    this->block_count = 0;
+    if (vm["block_widths"].as<std::string>() != ""){
+        this->widths = pruning::read_widths(vm["block_widths"].as<std::string>());  // inner widths of the pruned model
+    }
 
     // First Downsampling
     this->first = nn::Sequential(
@@ -75,6 +82,11 @@ MC_ResNetImpl::MC_ResNetImpl(po::variables_map &vm){
         this->layer3 = this->make_layers(block, feature*4, /*num_blocks=*/cfg.at(2), /*stride=*/2);  // {2F*E,28,28} ===> {4F*E,14,14}
         this->layer4 = this->make_layers(block, feature*8, /*num_blocks=*/cfg.at(3), /*stride=*/2);  // {4F*E,14,14} ===> {8F*E,7,7}
     }
+    if (!this->widths.empty() && (this->block_count != this->widths.size())){
+        std::cerr << "Error : The number of blocks in the widths file is " << this->widths.size() << '.' << std::endl;
+        std::cerr << "Error : Please give the widths of " << this->block_count << " blocks for this model." << std::endl;
+        std::exit(1);
+    }
     register_module("layer1", this->layer1);
     register_module("layer2", this->layer2);
     register_module("layer3", this->layer3);
@@ -88,6 +100,23 @@ MC_ResNetImpl::MC_ResNetImpl(po::variables_map &vm){
     this->classifier = nn::Sequential(nn::Linear(/*in_channels=*/feature*8*expansion, /*out_channels=*/vm["class_num"].as<size_t>()));  // {8F*E} ===> {CN}
     register_module("classifier", this->classifier);
 
+    // Early-Exit Classification
+    this->early_exit = vm["early_exit"].as<bool>();
+    if (this->early_exit){
+        this->exit2 = nn::Sequential(
+            nn::AdaptiveAvgPool2d(nn::AdaptiveAvgPool2dOptions({1, 1})),                                      // {2F*E,28,28} ===> {2F*E,1,1}
+            nn::Flatten(),                                                                                     // {2F*E,1,1} ===> {2F*E}
+            nn::Linear(/*in_channels=*/feature*2*expansion, /*out_channels=*/vm["class_num"].as<size_t>())  // {2F*E} ===> {CN}
+        );
+        register_module("exit2", this->exit2);
+        this->exit3 = nn::Sequential(
+            nn::AdaptiveAvgPool2d(nn::AdaptiveAvgPool2dOptions({1, 1})),                                      // {4F*E,14,14} ===> {4F*E,1,1}
+            nn::Flatten(),                                                                                     // {4F*E,1,1} ===> {4F*E}
+            nn::Linear(/*in_channels=*/feature*4*expansion, /*out_channels=*/vm["class_num"].as<size_t>())  // {4F*E} ===> {CN}
+        );
+        register_module("exit3", this->exit3);
+    }
+
 }
 
 
@@ -105,15 +134,48 @@ void MC_ResNetImpl::init(){
 // -----------------------------------------------------------
 template <typename T>
 nn::Sequential MC_ResNetImpl::make_layers(T &block, const size_t planes, const size_t num_blocks, const size_t stride){
-    nn::Sequential layers = nn::Sequential(T(this->inplanes, planes, stride));
+    nn::Sequential layers = nn::Sequential(T(this->inplanes, planes, stride, this->next_widths()));
     this->inplanes = planes * block.expansion;
     for (size_t i = 1; i < num_blocks; i++){
-        layers->push_back(T(this->inplanes, planes, /*stride=*/1));
+        layers->push_back(T(this->inplanes, planes, /*stride=*/1, this->next_widths()));
     }
     return layers;
 }
 
 
+// -----------------------------------------------------------
+// struct{MC_ResNetImpl}(nn::Module) -> function{next_widths}
+// -----------------------------------------------------------
+// Inner widths of the next residual block (empty for the model without pruning)
+std::vector<long int> MC_ResNetImpl::next_widths(){
+    this->block_count++;
+    if (this->widths.empty() || (this->block_count > this->widths.size())){
+        return {};
+    }
+    return this->widths.at(this->block_count - 1);
+}
+
+
+// -----------------------------------------------------------
+// struct{MC_ResNetImpl}(nn::Module) -> function{prune}
+// -----------------------------------------------------------
+// Remove the inner channels of every residual block, and return the widths of the smaller model for the option "block_widths".
+std::vector<std::vector<long int>> MC_ResNetImpl::prune(const float ratio, const std::string criterion){
+    this->widths.clear();
+    for (auto &layer : {this->layer1, this->layer2, this->layer3, this->layer4}){
+        for (auto &block : layer->children()){
+            if (auto basic = std::dynamic_pointer_cast<BasicBlockImpl>(block)){
+                this->widths.push_back(basic->prune(ratio, criterion));
+            }
+            else if (auto bottleneck = std::dynamic_pointer_cast<BottleneckImpl>(block)){
+                this->widths.push_back(bottleneck->prune(ratio, criterion));
+            }
+        }
+    }
+    return this->widths;
+}
+
+
 // ---------------------------------------------------------
 // struct{MC_ResNetImpl}(nn::Module) -> function{forward}
 // ---------------------------------------------------------
@@ -132,20 +194,114 @@ torch::Tensor MC_ResNetImpl::forward(torch::Tensor x){
 }
 
 
+// ---------------------------------------------------------------
+// struct{MC_ResNetImpl}(nn::Module) -> function{forward_exits}
+// ---------------------------------------------------------------
+// Outputs of all classifiers {exit2, exit3, final} for the joint training of the early exits
+std::vector<torch::Tensor> MC_ResNetImpl::forward_exits(torch::Tensor x){
+    if (!this->early_exit){
+        std::cerr << "Error : The model has no early-exit classifiers." << std::endl;
+        std::cerr << "Error : Please set the option '--early_exit true'." << std::endl;
+        std::exit(1);
+    }
+    torch::Tensor feature, out;
+    std::vector<torch::Tensor> outs;
+    feature = this->first->forward(x);                                    // {C,224,224} ===> {F,56,56}
+    feature = this->layer1->forward(feature);                             // {F,56,56} ===> {F*E,56,56}
+    feature = this->layer2->forward(feature);                             // {F*E,56,56} ===> {2F*E,28,28}
+    outs.push_back(F::log_softmax(this->exit2->forward(feature), /*dim=*/1));  // {2F*E,28,28} ===> {CN}
+    feature = this->layer3->forward(feature);                             // {2F*E,28,28} ===> {4F*E,14,14}
+    outs.push_back(F::log_softmax(this->exit3->forward(feature), /*dim=*/1));  // {4F*E,14,14} ===> {CN}
+    feature = this->layer4->forward(feature);                             // {4F*E,14,14} ===> {8F*E,7,7}
+    feature = this->avgpool->forward(feature);                            // {8F*E,7,7} ===> {8F*E,1,1}
+    feature = feature.view({feature.size(0), -1});                        // {8F*E,1,1} ===> {8F*E}
+    out = this->classifier->forward(feature);                             // {8F*E} ===> {CN}
+    outs.push_back(F::log_softmax(out, /*dim=*/1));
+    return outs;
+}
+
+
+// ---------------------------------------------------------------
+// function{exit_samples}
+// ---------------------------------------------------------------
+// Write the samples whose confidence clears the threshold into the output, and compact the mini batch to the remaining samples.
+static void exit_samples(torch::Tensor logp, const float threshold, const long int level, torch::Tensor &feature, torch::Tensor &remain, torch::Tensor &out, torch::Tensor &depth){
+    torch::Tensor exited = (std::get<0>(logp.max(/*dim=*/1)).exp() >= threshold);  // {N',CN} ===> {N'}
+    torch::Tensor index = remain.masked_select(exited);                           // {N'} ===> {E}
+    out.index_copy_(/*dim=*/0, index, logp.index({exited}));                       // {E,CN} ===> {N,CN}
+    depth.index_fill_(/*dim=*/0, index, level);                                    // {E} ===> {N}
+    torch::Tensor keep = exited.logical_not();
+    remain = remain.masked_select(keep);                                           // {N'} ===> {N'-E}
+    feature = feature.index({keep});                                               // {N',...} ===> {N'-E,...}
+    return;
+}
+
+
+// ---------------------------------------------------------------
+// struct{MC_ResNetImpl}(nn::Module) -> function{forward_early}
+// ---------------------------------------------------------------
+// Each sample exits at the first classifier whose confidence clears the threshold, and only the remaining samples go deeper.
+// The exit depth is 0 (after layer2), 1 (after layer3) or 2 (final).
+std::pair<torch::Tensor, torch::Tensor> MC_ResNetImpl::forward_early(torch::Tensor x, const float threshold){
+
+    if (!this->early_exit){
+        std::cerr << "Error : The model has no early-exit classifiers." << std::endl;
+        std::cerr << "Error : Please set the option '--early_exit true'." << std::endl;
+        std::exit(1);
+    }
+    torch::Tensor feature, logp, out, remain, depth;
+
+    // (1) Exit after layer2
+    feature = this->first->forward(x);                               // {C,224,224} ===> {F,56,56}
+    feature = this->layer1->forward(feature);                        // {F,56,56} ===> {F*E,56,56}
+    feature = this->layer2->forward(feature);                        // {F*E,56,56} ===> {2F*E,28,28}
+    logp = F::log_softmax(this->exit2->forward(feature), /*dim=*/1);  // {2F*E,28,28} ===> {CN}
+    out = torch::zeros_like(logp);                                   // {N,CN}
+    remain = torch::arange(x.size(0), torch::TensorOptions().dtype(torch::kLong).device(x.device()));  // {N}
+    depth = torch::full({x.size(0)}, 2, torch::TensorOptions().dtype(torch::kLong).device(x.device()));  // {N}
+    exit_samples(logp, threshold, /*level=*/0, feature, remain, out, depth);
+
+    // (2) Exit after layer3
+    if (remain.size(0) > 0){
+        feature = this->layer3->forward(feature);                        // {2F*E,28,28} ===> {4F*E,14,14}
+        logp = F::log_softmax(this->exit3->forward(feature), /*dim=*/1);  // {4F*E,14,14} ===> {CN}
+        exit_samples(logp, threshold, /*level=*/1, feature, remain, out, depth);
+    }
+
+    // (3) Final Classifier
+    if (remain.size(0) > 0){
+        feature = this->layer4->forward(feature);                        // {4F*E,14,14} ===> {8F*E,7,7}
+        feature = this->avgpool->forward(feature);                       // {8F*E,7,7} ===> {8F*E,1,1}
+        feature = feature.view({feature.size(0), -1});                   // {8F*E,1,1} ===> {8F*E}
+        logp = F::log_softmax(this->classifier->forward(feature), /*dim=*/1);  // {8F*E} ===> {CN}
+        out.index_copy_(/*dim=*/0, remain, logp);
+    }
+
+    return {out, depth};
+
+}
+
+
 // ----------------------------------------------------------------------
 // struct{BasicBlockImpl}(nn::Module) -> constructor
 // ----------------------------------------------------------------------
-BasicBlockImpl::BasicBlockImpl(const size_t inplanes, const size_t planes, const size_t stride){
+BasicBlockImpl::BasicBlockImpl(const size_t inplanes, const size_t planes, const size_t stride, const std::vector<long int> widths){
+
+    if (!widths.empty() && (widths.size() != 1)){
+        std::cerr << "Error : The basic block has 1 inner width, but " << widths.size() << " widths are given." << std::endl;
+        std::exit(1);
+    }
+    size_t width = widths.empty() ? planes : (size_t)widths.at(0);  // channels between the convolutions (reduced by pruning)
 
     this->layerA = nn::Sequential(
-        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/inplanes, /*out_channels=*/planes, /*kernel_size=*/3).stride(stride).padding(1).bias(false)),
-        nn::BatchNorm2d(planes),
+        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/inplanes, /*out_channels=*/width, /*kernel_size=*/3).stride(stride).padding(1).bias(false)),
+        nn::BatchNorm2d(width),
         nn::ReLU(nn::ReLUOptions().inplace(true))
     );
     register_module("layerA", this->layerA);
 
     this->layerB = nn::Sequential(
-        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/planes, /*out_channels=*/this->expansion*planes, /*kernel_size=*/3).stride(1).padding(1).bias(false)),
+        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/width, /*out_channels=*/this->expansion*planes, /*kernel_size=*/3).stride(1).padding(1).bias(false)),
         nn::BatchNorm2d(this->expansion*planes)
     );
     register_module("layerB", this->layerB);
@@ -181,27 +337,54 @@ torch::Tensor BasicBlockImpl::forward(torch::Tensor x){
 }
 
 
+// ---------------------------------------------------------
+// struct{BasicBlockImpl}(nn::Module) -> function{prune}
+// ---------------------------------------------------------
+// Only the channels between layerA and layerB are removed, so that the residual addition keeps its shape.
+std::vector<long int> BasicBlockImpl::prune(const float ratio, const std::string criterion){
+
+    nn::Conv2d convA(this->layerA->ptr<nn::Conv2dImpl>(0)), convB(this->layerB->ptr<nn::Conv2dImpl>(0));
+    nn::BatchNorm2d bnA(this->layerA->ptr<nn::BatchNorm2dImpl>(1)), bnB(this->layerB->ptr<nn::BatchNorm2dImpl>(1));
+    torch::Tensor index = pruning::select(pruning::importance(convA, bnA, criterion), ratio);  // {C'}
+
+    this->layerA = nn::Sequential(pruning::conv(convA, /*out_index=*/index, /*in_index=*/torch::Tensor()), pruning::batchnorm(bnA, index), nn::ReLU(nn::ReLUOptions().inplace(true)));
+    this->layerB = nn::Sequential(pruning::conv(convB, /*out_index=*/torch::Tensor(), /*in_index=*/index), bnB);
+    replace_module("layerA", this->layerA);
+    replace_module("layerB", this->layerB);
+
+    return {index.size(0)};
+
+}
+
+
 // ----------------------------------------------------------------------
 // struct{BottleneckImpl}(nn::Module) -> constructor
 // ----------------------------------------------------------------------
-BottleneckImpl::BottleneckImpl(const size_t inplanes, const size_t planes, const size_t stride){
+BottleneckImpl::BottleneckImpl(const size_t inplanes, const size_t planes, const size_t stride, const std::vector<long int> widths){
+
+    if (!widths.empty() && (widths.size() != 2)){
+        std::cerr << "Error : The bottleneck block has 2 inner widths, but " << widths.size() << " widths are given." << std::endl;
+        std::exit(1);
+    }
+    size_t widthA = widths.empty() ? planes : (size_t)widths.at(0);  // channels between the convolutions (reduced by pruning)
+    size_t widthB = widths.empty() ? planes : (size_t)widths.at(1);
 
     this->layerA = nn::Sequential(
-        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/inplanes, /*out_channels=*/planes, /*kernel_size=*/1).stride(1).padding(0).bias(false)),
-        nn::BatchNorm2d(planes),
+        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/inplanes, /*out_channels=*/widthA, /*kernel_size=*/1).stride(1).padding(0).bias(false)),
+        nn::BatchNorm2d(widthA),
         nn::ReLU(nn::ReLUOptions().inplace(true))
     );
     register_module("layerA", this->layerA);
 
     this->layerB = nn::Sequential(
-        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/planes, /*out_channels=*/planes, /*kernel_size=*/3).stride(stride).padding(1).bias(false)),
-        nn::BatchNorm2d(planes),
+        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/widthA, /*out_channels=*/widthB, /*kernel_size=*/3).stride(stride).padding(1).bias(false)),
+        nn::BatchNorm2d(widthB),
         nn::ReLU(nn::ReLUOptions().inplace(true))
     );
     register_module("layerB", this->layerB);
 
     this->layerC = nn::Sequential(
-        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/planes, /*out_channels=*/this->expansion*planes, /*kernel_size=*/1).stride(1).padding(0).bias(false)),
+        nn::Conv2d(nn::Conv2dOptions(/*in_channels=*/widthB, /*out_channels=*/this->expansion*planes, /*kernel_size=*/1).stride(1).padding(0).bias(false)),
         nn::BatchNorm2d(this->expansion*planes)
     );
     register_module("layerC", this->layerC);
@@ -238,6 +421,29 @@ torch::Tensor BottleneckImpl::forward(torch::Tensor x){
 }
 
 
+// ---------------------------------------------------------
+// struct{BottleneckImpl}(nn::Module) -> function{prune}
+// ---------------------------------------------------------
+// Only the channels of layerA and layerB are removed, so that the residual addition keeps its shape.
+std::vector<long int> BottleneckImpl::prune(const float ratio, const std::string criterion){
+
+    nn::Conv2d convA(this->layerA->ptr<nn::Conv2dImpl>(0)), convB(this->layerB->ptr<nn::Conv2dImpl>(0)), convC(this->layerC->ptr<nn::Conv2dImpl>(0));
+    nn::BatchNorm2d bnA(this->layerA->ptr<nn::BatchNorm2dImpl>(1)), bnB(this->layerB->ptr<nn::BatchNorm2dImpl>(1)), bnC(this->layerC->ptr<nn::BatchNorm2dImpl>(1));
+    torch::Tensor indexA = pruning::select(pruning::importance(convA, bnA, criterion), ratio);  // {CA'}
+    torch::Tensor indexB = pruning::select(pruning::importance(convB, bnB, criterion), ratio);  // {CB'}
+
+    this->layerA = nn::Sequential(pruning::conv(convA, /*out_index=*/indexA, /*in_index=*/torch::Tensor()), pruning::batchnorm(bnA, indexA), nn::ReLU(nn::ReLUOptions().inplace(true)));
+    this->layerB = nn::Sequential(pruning::conv(convB, /*out_index=*/indexB, /*in_index=*/indexA), pruning::batchnorm(bnB, indexB), nn::ReLU(nn::ReLUOptions().inplace(true)));
+    this->layerC = nn::Sequential(pruning::conv(convC, /*out_index=*/torch::Tensor(), /*in_index=*/indexB), bnC);
+    replace_module("layerA", this->layerA);
+    replace_module("layerB", this->layerB);
+    replace_module("layerC", this->layerC);
+
+    return {indexA.size(0), indexB.size(0)};
+
+}
+
+
 // ----------------------------
 // function{weights_init}
 // ----------------------------
@@ -1,6 +1,9 @@
 #ifndef NETWORKS_HPP
 #define NETWORKS_HPP
 
+#include <string>
+#include <vector>
+#include <utility>
 // For External Library
 #include <torch/torch.h>
 #include <boost/program_options.hpp>
@@ -19,15 +22,23 @@ void weights_init(nn::Module &m);
 struct MC_ResNetImpl : nn::Module{
 private:
     size_t inplanes;
+    size_t block_count;
+    bool early_exit;
+    std::vector<std::vector<long int>> widths;  // inner widths of the pruned residual blocks
     nn::Sequential first;
     nn::Sequential layer1, layer2, layer3, layer4;
     nn::Sequential avgpool, classifier;
+    nn::Sequential exit2, exit3;  // early-exit classifiers after layer2 and layer3
 public:
     MC_ResNetImpl(){}
     MC_ResNetImpl(po::variables_map &vm);
     void init();
     template <typename T> nn::Sequential make_layers(T &block, const size_t planes, const size_t num_blocks, const size_t stride);
+    std::vector<long int> next_widths();
+    std::vector<std::vector<long int>> prune(const float ratio, const std::string criterion);
     torch::Tensor forward(torch::Tensor x);
+    std::vector<torch::Tensor> forward_exits(torch::Tensor x);
+    std::pair<torch::Tensor, torch::Tensor> forward_early(torch::Tensor x, const float threshold);
 };
 
 // -------------------------------------------------
@@ -42,7 +53,8 @@ private:
 public:
     static const size_t expansion = 1;
     BasicBlockImpl(){}
-    BasicBlockImpl(const size_t inplanes, const size_t planes, const size_t stride);
+    BasicBlockImpl(const size_t inplanes, const size_t planes, const size_t stride, const std::vector<long int> widths={});
+    std::vector<long int> prune(const float ratio, const std::string criterion);
     torch::Tensor forward(torch::Tensor x);
 };
 
@@ -58,7 +70,8 @@ private:
 public:
     static const size_t expansion = 4;
     BottleneckImpl(){}
-    BottleneckImpl(const size_t inplanes, const size_t planes, const size_t stride);
+    BottleneckImpl(const size_t inplanes, const size_t planes, const size_t stride, const std::vector<long int> widths={});
+    std::vector<long int> prune(const float ratio, const std::string criterion);
     torch::Tensor forward(torch::Tensor x);
 };
 
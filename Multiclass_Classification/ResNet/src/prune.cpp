@@ -0,0 +1,136 @@
+#include <iostream>                    // std::cout, std::cerr
+#include <fstream>                     // std::ofstream
+#include <filesystem>                  // std::filesystem
+#include <string>                      // std::string
+#include <vector>                      // std::vector
+#include <utility>                     // std::pair
+#include <cstdlib>                     // std::exit
+// For External Library
+#include <torch/torch.h>               // torch
+#include <boost/program_options.hpp>   // boost::program_options
+// For Original Header
+#include "networks.hpp"                // MC_ResNet
+#include "transforms.hpp"              // transforms::Compose
+#include "datasets.hpp"                // datasets::ImageFolderClassesWithPaths
+#include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
+#include "evaluate.hpp"                // evaluate
+#include "pruning.hpp"                 // pruning
+
+// Define Namespace
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+// Function Prototype
+void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names);
+size_t count_params(MC_ResNet &model);
+
+
+// ---------------------------
+// Pruning Function
+// ---------------------------
+// Remove the inner channels of the residual blocks for "prune_cycles" times, with the fine-tuning by train() after each cycle.
+// The pruned model is saved as "<prune_checkpoint_dir>/models/epoch_<prune_load_epoch>_pruned.pth" with the widths file "epoch_<prune_load_epoch>_pruned.txt" for the option "block_widths".
+// The fine-tuning also writes its models, optimizers and logs there, so that the source checkpoint directory is never modified.
+void prune(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names){
+
+    // (0) Initialization and Declaration
+    size_t cycle;
+    size_t params_dense, params_pruned;
+    float accuracy_dense, accuracy_pruned;
+    double time_dense, time_pruned;
+    std::string path, result_dir;
+    std::string prune_dir, pruned_path;
+    std::string dataroot;
+    std::ofstream ofs;
+    std::vector<std::vector<long int>> widths;
+    po::variables_map vm_finetune;
+    datasets::ImageFolderClassesWithPaths dataset;
+    DataLoader::ImageFolderClassesWithPaths dataloader;
+
+    // (1) Get Test Dataset
+    dataroot = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_dir"].as<std::string>();
+    dataset = datasets::ImageFolderClassesWithPaths(dataroot, transform, class_names);
+    dataloader = DataLoader::ImageFolderClassesWithPaths(dataset, /*batch_size_=*/vm["test_batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
+    std::cout << "total test images : " << dataset.size() << std::endl << std::endl;
+
+    // (2) Get Model
+    path = vm["checkpoint_dir"].as<std::string>() + "/models/epoch_" + vm["prune_load_epoch"].as<std::string>();
+    torch::load(model, path + ".pth");
+    prune_dir = vm["prune_checkpoint_dir"].as<std::string>();
+    if (prune_dir == "") prune_dir = vm["checkpoint_dir"].as<std::string>() + "_pruned";
+    if (fs::weakly_canonical(prune_dir) == fs::weakly_canonical(vm["checkpoint_dir"].as<std::string>())){
+        std::cerr << "Error : The pruned model must not be saved in the source checkpoint directory '" << prune_dir << "'." << std::endl;
+        std::exit(1);
+    }
+    fs::create_directories(prune_dir + "/models");
+    pruned_path = prune_dir + "/models/epoch_" + vm["prune_load_epoch"].as<std::string>() + "_pruned";
+
+    // (3) File Pre-processing
+    result_dir = vm["prune_result_dir"].as<std::string>();  fs::create_directories(result_dir);
+    ofs.open(result_dir + "/report.txt", std::ios::out);
+    ofs << "criterion:" << vm["prune_criterion"].as<std::string>() << " ratio:" << vm["prune_ratio"].as<float>() << " cycles:" << vm["prune_cycles"].as<size_t>() << " fine-tuning-epochs:" << vm["prune_finetune_epochs"].as<size_t>() << std::endl;
+
+    // (4) Dense Evaluation
+    {
+        torch::NoGradGuard no_grad;
+        model->eval();
+        params_dense = count_params(model);
+        std::tie(accuracy_dense, time_dense) = evaluate(device, model, dataloader, class_names.size());
+    }
+    std::cout << "<Dense> accuracy:" << accuracy_dense << " params:" << params_dense << " (time:" << time_dense << ')' << std::endl;
+    ofs << "<Dense> accuracy:" << accuracy_dense << " time[s/image]:" << time_dense << " params:" << params_dense << std::endl;
+
+    // (5) Iterative Pruning and Fine-Tuning
+    for (cycle = 1; cycle <= vm["prune_cycles"].as<size_t>(); cycle++){
+
+        // (5.1) Pruning
+        {
+            torch::NoGradGuard no_grad;
+            widths = model->prune(vm["prune_ratio"].as<float>(), vm["prune_criterion"].as<std::string>());
+        }
+        torch::save(model, pruned_path + ".pth");
+        pruning::write_widths(pruned_path + ".txt", widths);
+
+        // (5.2) Fine-Tuning through the Training Phase
+        if (vm["prune_finetune_epochs"].as<size_t>() > 0){
+            vm_finetune = vm;
+            vm_finetune.at("epochs").value() = vm["prune_finetune_epochs"].as<size_t>();
+            vm_finetune.at("train_load_epoch").value() = std::string("");
+            vm_finetune.at("train_init_path").value() = pruned_path + ".pth";
+            vm_finetune.at("checkpoint_dir").value() = prune_dir;
+            train(vm_finetune, device, model, transform, class_names);
+            torch::save(model, pruned_path + ".pth");
+        }
+
+        // (5.3) Pruned Evaluation
+        {
+            torch::NoGradGuard no_grad;
+            model->eval();
+            params_pruned = count_params(model);
+            std::tie(accuracy_pruned, time_pruned) = evaluate(device, model, dataloader, class_names.size());
+        }
+        std::cout << "<Pruned " << cycle << "> accuracy:" << accuracy_pruned << " params:" << params_pruned << " (time:" << time_pruned << ')' << std::endl;
+        ofs << "<Pruned " << cycle << "> accuracy:" << accuracy_pruned << " time[s/image]:" << time_pruned << " params:" << params_pruned << " accuracy-drop:" << accuracy_dense - accuracy_pruned << " compression:" << (double)params_dense / (double)params_pruned << " speedup:" << time_dense / time_pruned << std::endl;
+
+    }
+    std::cout << "pruned checkpoint : " << pruned_path << ".pth (--checkpoint_dir " << prune_dir << " --block_widths " << pruned_path << ".txt)" << std::endl;
+
+    // Post Processing
+    ofs.close();
+
+    // End Processing
+    return;
+
+}
+
+
+// ---------------------------
+// Parameter Count Function
+// ---------------------------
+size_t count_params(MC_ResNet &model){
+    size_t total = 0;
+    for (auto &param : model->parameters()){
+        total += param.numel();
+    }
+    return total;
+}
@@ -6,18 +6,21 @@
 #include <tuple>                       // std::tuple
 #include <vector>                      // std::vector
 #include <utility>                     // std::pair
+#include <map>                         // std::map
 #include <cmath>                       // std::ceil
+#include <cstdlib>                     // std::exit
 // For External Library
 #include <torch/torch.h>               // torch
 #include <boost/program_options.hpp>   // boost::program_options
 // For Original Header
-#include "loss.hpp"                    // Loss
+#include "loss.hpp"                    // Loss, DistillationLoss
 #include "networks.hpp"                // MC_ResNet
 #include "transforms.hpp"              // transforms::Compose
 #include "datasets.hpp"                // datasets::ImageFolderClassesWithPaths
 #include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
 #include "visualizer.hpp"              // visualizer
 #include "progress.hpp"                // progress
+#include "metrics.hpp"                 // metrics
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -25,6 +28,8 @@ namespace po = boost::program_options;
 
 // Function Prototype
 void valid(po::variables_map &vm, DataLoader::ImageFolderClassesWithPaths &valid_dataloader, torch::Device &device, Loss &criterion, MC_ResNet &model, const std::vector<std::string> class_names, const size_t epoch, visualizer::graph &writer, visualizer::graph &writer_accuracy, visualizer::graph &writer_each_accuracy);
+MC_ResNet get_teacher(po::variables_map &vm, torch::Device &device);
+torch::Tensor get_teacher_logits(po::variables_map &vm, torch::Device &device, MC_ResNet &teacher, datasets::ImageFolderClassesWithPaths &dataset, std::map<std::string, long int> &index);
 
 
 // -------------------
@@ -41,6 +46,7 @@ void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::
     // a0. Initialization and Declaration
     // -----------------------------------
 
+    bool distill;
     size_t epoch;
     size_t total_iter;
     size_t start_epoch, total_epoch;
@@ -52,11 +58,18 @@ void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::
     std::ifstream infoi;
     std::ofstream ofs, init, infoo;
     std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>> mini_batch;
+    std::vector<long int> teacher_rows;
+    std::vector<torch::Tensor> exit_outputs;
+    std::map<std::string, long int> teacher_index;
     torch::Tensor loss, image, label, output;
+    torch::Tensor teacher_output, teacher_logits;
     datasets::ImageFolderClassesWithPaths dataset, valid_dataset;
     DataLoader::ImageFolderClassesWithPaths dataloader, valid_dataloader;
+    MC_ResNet teacher{nullptr};
+    DistillationLoss distill_criterion;
     visualizer::graph train_loss, valid_loss, valid_accuracy, valid_each_accuracy;
     progress::display *show_progress;
+    metrics::logger *logger;
     progress::irregular irreg_progress;
 
 
@@ -81,11 +94,22 @@ void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::
     // (3) Set Optimizer Method
     auto optimizer = torch::optim::Adam(model->parameters(), torch::optim::AdamOptions(vm["lr"].as<float>()).betas({vm["beta1"].as<float>(), vm["beta2"].as<float>()}));
 
-    // (4) Set Loss Function
+    // (4.1) Set Loss Function
     auto criterion = Loss();
 
+    // (4.2) Set Teacher Model for Knowledge Distillation
+    distill = (vm["teacher_checkpoint"].as<std::string>() != "");
+    if (distill){
+        distill_criterion = DistillationLoss(vm["kd_temperature"].as<float>(), vm["kd_alpha"].as<float>());
+        teacher = get_teacher(vm, device);
+        if (vm["teacher_cache"].as<bool>()){
+            teacher_logits = get_teacher_logits(vm, device, teacher, dataset, teacher_index);  // {M,CN}
+            teacher = nullptr;  // the teacher is not used any more, and its memory on the device is released
+        }
+    }
+
     // (5) Make Directories
-    checkpoint_dir = "checkpoints/" + vm["dataset"].as<std::string>();
+    checkpoint_dir = vm["checkpoint_dir"].as<std::string>();
     path = checkpoint_dir + "/models";  fs::create_directories(path);
     path = checkpoint_dir + "/optims";  fs::create_directories(path);
     path = checkpoint_dir + "/log";  fs::create_directories(path);
@@ -101,8 +125,15 @@ void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::
     
     // (7) Get Weights and File Processing
     if (vm["train_load_epoch"].as<std::string>() == ""){
-        model->init();
+        if (vm["train_init_path"].as<std::string>() == ""){
+            model->init();
+        }
+        else{
+            torch::load(model, vm["train_init_path"].as<std::string>());  // fine-tuning from a converted checkpoint (e.g. structured pruning)
+        }
         ofs.open(checkpoint_dir + "/log/train.txt", std::ios::out);
+        init.open(checkpoint_dir + "/log/train.jsonl", std::ios::trunc);
+        init.close();
         if (vm["valid"].as<bool>()){
             init.open(checkpoint_dir + "/log/valid.txt", std::ios::trunc);
             init.close();
@@ -154,6 +185,7 @@ void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::
         model->train();
         ofs << std::endl << "epoch:" << epoch << '/' << total_epoch << std::endl;
         show_progress = new progress::display(/*count_max_=*/total_iter, /*epoch=*/{epoch, total_epoch}, /*loss_=*/{"classify"});
+        logger = new metrics::logger(show_progress, ofs, checkpoint_dir + "/log/train.jsonl", epoch, total_iter, /*loss_=*/{"classify"}, vm["log_sync_iter"].as<size_t>());
 
         // -----------------------------------
         // b1. Mini Batch Learning
@@ -165,8 +197,40 @@ void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::
             // -----------------------------------
             image = std::get<0>(mini_batch).to(device);
             label = std::get<1>(mini_batch).to(device);
-            output = model->forward(image);
-            loss = criterion(output, label);
+            if (vm["early_exit"].as<bool>()){
+                exit_outputs = model->forward_exits(image);  // {N,C,H,W} ===> {N,CN} * 3
+                output = exit_outputs.back();
+                exit_outputs.pop_back();
+            }
+            else{
+                output = model->forward(image);
+            }
+            if (!distill){
+                loss = criterion(output, label);
+            }
+            else{
+                if (teacher_logits.defined()){
+                    teacher_rows.clear();
+                    for (auto &file : std::get<2>(mini_batch)){
+                        auto row = teacher_index.find(file);
+                        if (row == teacher_index.end()){
+                            std::cerr << "Error : The teacher logits of " << file << " are not cached." << std::endl;
+                            std::cerr << "Error : Please delete the teacher cache directory, or set teacher_cache to false." << std::endl;
+                            std::exit(1);
+                        }
+                        teacher_rows.push_back(row->second);
+                    }
+                    teacher_output = teacher_logits.index_select(/*dim=*/0, torch::tensor(teacher_rows, torch::kLong)).to(device, torch::kFloat);  // {M,CN} ===> {N,CN}
+                }
+                else{
+                    torch::NoGradGuard no_grad;
+                    teacher_output = teacher->forward(image);  // {N,C,H,W} ===> {N,CN}
+                }
+                loss = distill_criterion(output, teacher_output, label);
+            }
+            for (auto &exit_output : exit_outputs){
+                loss = loss + vm["exit_loss_weight"].as<float>() * criterion(exit_output, label);  // joint training of the early exits
+            }
             optimizer.zero_grad();
             loss.backward();
             optimizer.step();
@@ -174,15 +238,14 @@ void train(po::variables_map &vm, torch::Device &device, MC_ResNet &model, std::
             // -----------------------------------
             // c2. Record Loss (iteration)
             // -----------------------------------
-            show_progress->increment(/*loss_value=*/{loss.item<float>()});
-            ofs << "iters:" << show_progress->get_iters() << '/' << total_iter << ' ' << std::flush;
-            ofs << "classify:" << loss.item<float>() << "(ave:" <<  show_progress->get_ave(0) << ')' << std::endl;
+            logger->push({loss});
 
         }
 
         // -----------------------------------
         // b2. Record Loss (epoch)
         // -----------------------------------
+        delete logger;
         train_loss.plot(/*base=*/epoch, /*value=*/show_progress->get_ave());
         delete show_progress;
         
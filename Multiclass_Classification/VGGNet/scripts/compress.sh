@@ -0,0 +1,15 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./VGGNet \
+    --compress true \
+    --n_layers 16 \
+    --BN true \
+    --dataset ${DATA} \
+    --class_list "list/${DATA}.txt" \
+    --class_num 10 \
+    --size 224 \
+    --compress_energy 0.9 \
+    --gpu_id 0 \
+    --nc 1
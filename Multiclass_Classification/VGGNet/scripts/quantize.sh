@@ -0,0 +1,14 @@
+#!/bin/bash
+
+DATA='MNIST'
+
+./VGGNet \
+    --quantize true \
+    --n_layers 16 \
+    --BN true \
+    --dataset ${DATA} \
+    --class_list "list/${DATA}.txt" \
+    --class_num 10 \
+    --size 224 \
+    --gpu_id -1 \
+    --nc 1
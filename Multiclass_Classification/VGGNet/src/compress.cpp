@@ -0,0 +1,88 @@
+#include <iostream>                    // std::cout, std::cerr
+#include <fstream>                     // std::ofstream
+#include <filesystem>                  // std::filesystem
+#include <string>                      // std::string
+#include <vector>                      // std::vector
+#include <utility>                     // std::pair
+#include <cstdlib>                     // std::exit
+// For External Library
+#include <torch/torch.h>               // torch
+#include <boost/program_options.hpp>   // boost::program_options
+// For Original Header
+#include "networks.hpp"                // MC_VGGNet
+#include "transforms.hpp"              // transforms::Compose
+#include "datasets.hpp"                // datasets::ImageFolderClassesWithPaths
+#include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
+#include "evaluate.hpp"                // evaluate
+#include "lowrank.hpp"                 // lowrank
+
+// Define Namespace
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+// ---------------------------
+// Compression Function
+// ---------------------------
+// Factorize the fully connected layers with the truncated SVD, and compare the factorized model with the original one on the test set.
+// The factorized checkpoint is loaded by the network with "--fc_ranks", and can be fine-tuned by "--train true --train_init_path <checkpoint>".
+void compress(po::variables_map &vm, torch::Device &device, MC_VGGNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names){
+
+    // (0) Initialization and Declaration
+    size_t params_full, params_low;
+    float accuracy_full, accuracy_low;
+    double time_full, time_low;
+    std::string path, result_dir, fc_ranks;
+    std::string dataroot;
+    std::ofstream ofs;
+    std::vector<long int> ranks;
+    datasets::ImageFolderClassesWithPaths dataset;
+    DataLoader::ImageFolderClassesWithPaths dataloader;
+
+    // (1) Get Test Dataset
+    dataroot = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_dir"].as<std::string>();
+    dataset = datasets::ImageFolderClassesWithPaths(dataroot, transform, class_names);
+    dataloader = DataLoader::ImageFolderClassesWithPaths(dataset, /*batch_size_=*/vm["test_batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
+    std::cout << "total test images : " << dataset.size() << std::endl << std::endl;
+
+    // (2) Get Model
+    if (vm["fc_ranks"].as<std::string>() != ""){
+        std::cerr << "Error : The model to compress must be in full rank." << std::endl;
+        std::cerr << "Error : Please remove the option '--fc_ranks'." << std::endl;
+        std::exit(1);
+    }
+    path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["compress_load_epoch"].as<std::string>();
+    torch::load(model, path + ".pth");
+    torch::NoGradGuard no_grad;
+    model->eval();
+
+    // (3) Full-Rank Evaluation
+    params_full = lowrank::count_params(model.ptr());
+    std::tie(accuracy_full, time_full) = evaluate(device, model, dataloader, class_names.size());
+    std::cout << "<Full-Rank> accuracy:" << accuracy_full << " params:" << params_full << " (time:" << time_full << ')' << std::endl;
+
+    // (4) Factorization
+    ranks = lowrank::factorize(model.ptr(), /*rank=*/vm["compress_rank"].as<size_t>(), /*energy=*/vm["compress_energy"].as<float>());
+    fc_ranks = lowrank::format_ranks(ranks);
+    torch::save(model, path + "_lowrank.pth");
+    std::cout << "factorized checkpoint : " << path << "_lowrank.pth (--fc_ranks " << fc_ranks << ')' << std::endl;
+
+    // (5) Low-Rank Evaluation
+    params_low = lowrank::count_params(model.ptr());
+    std::tie(accuracy_low, time_low) = evaluate(device, model, dataloader, class_names.size());
+    std::cout << "<Low-Rank> accuracy:" << accuracy_low << " params:" << params_low << " (time:" << time_low << ')' << std::endl;
+
+    // (6) Report
+    result_dir = vm["compress_result_dir"].as<std::string>();  fs::create_directories(result_dir);
+    ofs.open(result_dir + "/report.txt", std::ios::out);
+    ofs << "fc_ranks:" << fc_ranks << " rank:" << vm["compress_rank"].as<size_t>() << " energy:" << vm["compress_energy"].as<float>() << std::endl;
+    ofs << "<Full-Rank> accuracy:" << accuracy_full << " time[s/image]:" << time_full << " params:" << params_full << " size[B]:" << fs::file_size(path + ".pth") << std::endl;
+    ofs << "<Low-Rank> accuracy:" << accuracy_low << " time[s/image]:" << time_low << " params:" << params_low << " size[B]:" << fs::file_size(path + "_lowrank.pth") << std::endl;
+    ofs << "accuracy-drop:" << accuracy_full - accuracy_low << " compression:" << (double)params_full / (double)params_low << " speedup:" << time_full / time_low << std::endl;
+    ofs.close();
+    std::cout << "accuracy-drop:" << accuracy_full - accuracy_low << " compression:" << (double)params_full / (double)params_low << " speedup:" << time_full / time_low << std::endl;
+
+    // End Processing
+    return;
+
+}
@@ -0,0 +1,37 @@
+#include <tuple>                       // std::tuple
+#include <vector>                      // std::vector
+#include <string>                      // std::string
+#include <utility>                     // std::pair
+// For External Library
+#include <torch/torch.h>               // torch
+// For Original Header
+#include "evaluate.hpp"                // evaluate
+#include "networks.hpp"                // MC_VGGNet
+#include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
+#include "evaluation.hpp"              // evaluation::Runner, evaluation::ConfusionMatrix
+
+
+// ---------------------------
+// Evaluation Function
+// ---------------------------
+std::pair<float, double> evaluate(torch::Device &device, MC_VGGNet &model, DataLoader::ImageFolderClassesWithPaths &dataloader, const size_t class_num){
+
+    std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>> data;
+    torch::Tensor image, label, output;
+    evaluation::Runner runner;
+    evaluation::ConfusionMatrix confusion(class_num, /*k_=*/0);
+
+    while (dataloader(data)){
+        image = std::get<0>(data).to(device);
+        label = std::get<1>(data).to(device);
+        runner.start_timer();
+        output = model->forward(image);  // {N,C,H,W} ===> {N,CN}
+        if (device.is_cuda()) torch::cuda::synchronize();
+        runner.stop_timer();
+        confusion.update(output, label);
+        runner.push({label});
+    }
+
+    return {confusion.accuracy(), runner.get_ave_time()};
+
+}
@@ -0,0 +1,19 @@
+#ifndef EVALUATE_HPP
+#define EVALUATE_HPP
+
+#include <utility>                     // std::pair
+// For External Library
+#include <torch/torch.h>               // torch
+// For Original Header
+#include "networks.hpp"                // MC_VGGNet
+#include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
+
+
+// -------------------------------
+// Function{evaluate}
+// -------------------------------
+// Accuracy and forward time per image, shared by the quantization and compression phases.
+std::pair<float, double> evaluate(torch::Device &device, MC_VGGNet &model, DataLoader::ImageFolderClassesWithPaths &dataloader, const size_t class_num);
+
+
+#endif
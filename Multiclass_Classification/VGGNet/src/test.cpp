@@ -1,17 +1,18 @@
 #include <iostream>                    // std::cout
-#include <fstream>                     // std::ifstream, std::ofstream
+#include <fstream>                     // std::ifstream
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
-#include <chrono>                      // std::chrono
+#include <vector>                      // std::vector
 // For External Library
 #include <torch/torch.h>               // torch
 #include <boost/program_options.hpp>   // boost::program_options
 // For Original Header
-#include "loss.hpp"                    // Loss
 #include "networks.hpp"                // MC_VGGNet
 #include "transforms.hpp"              // transforms::Compose
 #include "datasets.hpp"                // datasets::ImageFolderClassesWithPaths
 #include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
+#include "fusion.hpp"                  // fusion::load_folded
+#include "evaluation.hpp"              // evaluation::Runner, evaluation::ConfusionMatrix, evaluation::BufferedWriter, evaluation::EachLoss, evaluation::each
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -23,110 +24,137 @@ namespace po = boost::program_options;
 // ---------------
 void test(po::variables_map &vm, torch::Device &device, MC_VGGNet &model, std::vector<transforms::Compose*> &transform, const std::vector<std::string> class_names){
 
+    constexpr size_t topk = 5;  // the number of candidates for top-k accuracy
+
     // (0) Initialization and Declaration
+    size_t i, j;
     size_t class_num;
-    size_t match, counter;
     long int response, answer;
     char judge;
-    float accuracy;
+    float accuracy, topk_accuracy, macro_f1;
     float ave_loss;
-    double seconds, ave_time;
+    double ave_time;
     std::string path, result_dir;
     std::string dataroot;
-    std::ofstream ofs, ofs2;
-    std::chrono::system_clock::time_point start, end;
+    std::vector<double> ave;
+    std::vector<float> precision, recall, f1;
+    std::vector<std::vector<float>> rows;
     std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>> data;
     torch::Tensor image, label, output;
-    torch::Tensor loss;
+    torch::Tensor loss, match, matrix;
     datasets::ImageFolderClassesWithPaths dataset;
     DataLoader::ImageFolderClassesWithPaths dataloader;
+    evaluation::Runner runner;
+    evaluation::ConfusionMatrix confusion;
+    evaluation::BufferedWriter ofs, ofs2, ofs3;
 
     // (1) Get Test Dataset
     dataroot = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_dir"].as<std::string>();
     dataset = datasets::ImageFolderClassesWithPaths(dataroot, transform, class_names);
-    dataloader = DataLoader::ImageFolderClassesWithPaths(dataset, /*batch_size_=*/1, /*shuffle_=*/false, /*num_workers_=*/0);
+    dataloader = DataLoader::ImageFolderClassesWithPaths(dataset, /*batch_size_=*/vm["test_batch_size"].as<size_t>(), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
     std::cout << "total test images : " << dataset.size() << std::endl << std::endl;
 
     // (2) Get Model
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + ".pth";
-    torch::load(model, path);
+    if (vm["test_fold_bn"].as<bool>()){
+        fusion::load_folded(model, path);
+    }
+    else{
+        torch::load(model, path);
+    }
 
     // (3) Set Loss Function
-    auto criterion = Loss();
+    auto criterion = evaluation::EachLoss("nll");
 
     // (4) Initialization of Value
-    ave_loss = 0.0;
-    ave_time = 0.0;
-    match = 0;
-    counter = 0;
     class_num = class_names.size();
+    confusion = evaluation::ConfusionMatrix(class_num, /*k_=*/topk);
 
     // (5) File Pre-processing
     result_dir = vm["test_result_dir"].as<std::string>();  fs::create_directories(result_dir);
-    ofs.open(result_dir + "/loss.txt", std::ios::out);
-    ofs2.open(result_dir + "/likelihood.csv", std::ios::out);
-    ofs2 << "file name," << std::flush;
-    ofs2 << "judge," << std::flush;
-    for (size_t i = 0; i < class_num; i++){
-        ofs2 << i << "(" << class_names.at(i) << ")," << std::flush;
+    ofs.open(result_dir + "/loss.txt");
+    ofs2.open(result_dir + "/likelihood.csv");
+    ofs2 << "file name,";
+    ofs2 << "judge,";
+    for (i = 0; i < class_num; i++){
+        ofs2 << i << "(" << class_names.at(i) << "),";
     }
-    ofs2 << std::endl;
+    ofs2 << '\n';
 
     // (6) Tensor Forward
+    torch::NoGradGuard no_grad;
     model->eval();
     while (dataloader(data)){
         
         image = std::get<0>(data).to(device);
         label = std::get<1>(data).to(device);
         
-        start = std::chrono::system_clock::now();
-        
-        output = model->forward(image);
-
-        end = std::chrono::system_clock::now();
-        seconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 0.001 * 0.001;
-        
-        loss = criterion(output, label);
-        
-        ave_loss += loss.item<float>();
-        ave_time += seconds;
-
-        output = output.exp();
-        response = output.argmax(/*dim=*/1).item<long int>();
-        answer = label[0].item<long int>();
-        counter += 1;
-        judge = 'F';
-        if (response == answer){
-            match += 1;
-            judge = 'T';
+        runner.start_timer();
+
+        // (6.1) Metrics on Device
+        output = model->forward(image);                                         // {N,C,H,W} ===> {N,CN}
+        loss = evaluation::each(criterion, output, label);                      // {N,CN}, {N} ===> {N}
+        output = output.exp();                                                  // {N,CN} ===> {N,CN}
+        match = (output.argmax(/*dim=*/1) == label);                            // {N,CN} ===> {N}
+        confusion.update(output, label);                                        // {N,CN}, {N} ===> {CN,CN}
+
+        // (6.2) Synchronize Once per Mini Batch
+        rows = runner.push({loss, match, output.argmax(/*dim=*/1), label, output});  // {N} * 4 + {N,CN} ===> {N,4+CN}
+
+        runner.stop_timer();
+
+        // (6.3) Write Results
+        for (i = 0; i < rows.size(); i++){
+            response = (long int)rows.at(i).at(2);
+            answer = (long int)rows.at(i).at(3);
+            judge = (rows.at(i).at(1) > 0.5) ? 'T' : 'F';
+            ofs << '<' << std::get<2>(data).at(i) << "> cross-entropy:" << rows.at(i).at(0) << " judge:" << judge << " response:" << response << '(' << class_names.at(response) << ") answer:" << answer << '(' << class_names.at(answer) << ")\n";
+            ofs2 << std::get<2>(data).at(i) << ',';
+            ofs2 << judge << ',';
+            for (j = 0; j < class_num; j++){
+                ofs2 << rows.at(i).at(4 + j) << ',';
+            }
+            ofs2 << '\n';
         }
 
-        std::cout << '<' << std::get<2>(data).at(0) << "> cross-entropy:" << loss.item<float>() << " judge:" << judge << " response:" << response << '(' << class_names.at(response) << ") answer:" << answer << '(' << class_names.at(answer) << ')' << std::endl;
-        ofs << '<' << std::get<2>(data).at(0) << "> cross-entropy:" << loss.item<float>() << " judge:" << judge << " response:" << response << '(' << class_names.at(response) << ") answer:" << answer << '(' << class_names.at(answer) << ')' << std::endl;
-        ofs2 << std::get<2>(data).at(0) << ',' << std::flush;
-        ofs2 << judge << ',' << std::flush;
-        output = output[0];  // {1, CN} ===> {CN}
-        for (size_t i = 0; i < class_num; i++){
-            ofs2 << output[i].item<float>() << ',' << std::flush;
-        }
-        ofs2 << std::endl;
-
     }
 
-    // (7.1) Calculate Average
-    ave_loss = ave_loss / (float)dataset.size();
-    ave_time = ave_time / (double)dataset.size();
-
-    // (7.2) Calculate Accuracy
-    accuracy = (float)match / float(counter);
+    // (7) Calculate Average and Accuracy
+    ave = runner.get_ave();
+    ave_loss = (float)ave.at(0);
+    accuracy = confusion.accuracy();
+    topk_accuracy = confusion.topk_accuracy();
+    macro_f1 = confusion.macro_f1();
+    precision = confusion.precision();
+    recall = confusion.recall();
+    f1 = confusion.f1();
+    matrix = confusion.get_matrix();
+    ave_time = runner.get_ave_time();
 
     // (8) Average Output
-    std::cout << "<All> cross-entropy:" << ave_loss << " accuracy:" << accuracy << " (time:" << ave_time << ')' << std::endl;
-    ofs << "<All> cross-entropy:" << ave_loss << " accuracy:" << accuracy << " (time:" << ave_time << ')' << std::endl;
+    std::cout << "<All> cross-entropy:" << ave_loss << " accuracy:" << accuracy << " top" << confusion.get_k() << "-accuracy:" << topk_accuracy << " macro-F1:" << macro_f1 << " (time:" << ave_time << ')' << std::endl;
+    ofs << "<All> cross-entropy:" << ave_loss << " accuracy:" << accuracy << " top" << confusion.get_k() << "-accuracy:" << topk_accuracy << " macro-F1:" << macro_f1 << " (time:" << ave_time << ")\n";
+
+    // (9) Class-wise Output
+    ofs3.open(result_dir + "/class_metrics.csv");
+    ofs3 << "class,precision,recall,F1,";
+    for (i = 0; i < class_num; i++){
+        ofs3 << i << "(" << class_names.at(i) << "),";
+    }
+    ofs3 << '\n';
+    auto matrix_a = matrix.accessor<long int, 2>();  // {C,C} on the CPU from get_matrix(), read without a tensor per cell
+    for (i = 0; i < class_num; i++){
+        ofs3 << i << "(" << class_names.at(i) << ")," << precision.at(i) << ',' << recall.at(i) << ',' << f1.at(i) << ',';
+        for (j = 0; j < class_num; j++){
+            ofs3 << matrix_a[i][j] << ',';
+        }
+        ofs3 << '\n';
+    }
 
     // Post Processing
     ofs.close();
     ofs2.close();
+    ofs3.close();
 
     // End Processing
     return;
@@ -18,6 +18,7 @@
 #include "dataloader.hpp"              // DataLoader::ImageFolderClassesWithPaths
 #include "visualizer.hpp"              // visualizer
 #include "progress.hpp"                // progress
+#include "metrics.hpp"                 // metrics
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -57,6 +58,7 @@ void train(po::variables_map &vm, torch::Device &device, MC_VGGNet &model, std::
     DataLoader::ImageFolderClassesWithPaths dataloader, valid_dataloader;
     visualizer::graph train_loss, valid_loss, valid_accuracy, valid_each_accuracy;
     progress::display *show_progress;
+    metrics::logger *logger;
     progress::irregular irreg_progress;
 
 
@@ -101,8 +103,15 @@ void train(po::variables_map &vm, torch::Device &device, MC_VGGNet &model, std::
     
     // (7) Get Weights and File Processing
     if (vm["train_load_epoch"].as<std::string>() == ""){
-        model->init();
+        if (vm["train_init_path"].as<std::string>() == ""){
+            model->init();
+        }
+        else{
+            torch::load(model, vm["train_init_path"].as<std::string>());  // fine-tuning from a converted checkpoint (e.g. low-rank factorization)
+        }
         ofs.open(checkpoint_dir + "/log/train.txt", std::ios::out);
+        init.open(checkpoint_dir + "/log/train.jsonl", std::ios::trunc);
+        init.close();
         if (vm["valid"].as<bool>()){
             init.open(checkpoint_dir + "/log/valid.txt", std::ios::trunc);
             init.close();
@@ -154,6 +163,7 @@ void train(po::variables_map &vm, torch::Device &device, MC_VGGNet &model, std::
         model->train();
         ofs << std::endl << "epoch:" << epoch << '/' << total_epoch << std::endl;
         show_progress = new progress::display(/*count_max_=*/total_iter, /*epoch=*/{epoch, total_epoch}, /*loss_=*/{"classify"});
+        logger = new metrics::logger(show_progress, ofs, checkpoint_dir + "/log/train.jsonl", epoch, total_iter, /*loss_=*/{"classify"}, vm["log_sync_iter"].as<size_t>());
 
         // -----------------------------------
         // b1. Mini Batch Learning
@@ -174,15 +184,14 @@ void train(po::variables_map &vm, torch::Device &device, MC_VGGNet &model, std::
             // -----------------------------------
             // c2. Record Loss (iteration)
             // -----------------------------------
-            show_progress->increment(/*loss_value=*/{loss.item<float>()});
-            ofs << "iters:" << show_progress->get_iters() << '/' << total_iter << ' ' << std::flush;
-            ofs << "classify:" << loss.item<float>() << "(ave:" <<  show_progress->get_ave(0) << ')' << std::endl;
+            logger->push({loss});
 
         }
 
         // -----------------------------------
         // b2. Record Loss (epoch)
         // -----------------------------------
+        delete logger;
         train_loss.plot(/*base=*/epoch, /*value=*/show_progress->get_ave());
         delete show_progress;
         
@@ -1,6 +1,7 @@
 #include <tuple>
 #include <vector>
 #include <typeinfo>
+#include <utility>
 // For External Library
 #include <torch/torch.h>
 // For Original Header
@@ -29,6 +30,7 @@ SegNetImpl::SegNetImpl(po::variables_map &vm){
     std::vector<size_t> dec_n_layers = {2, 2, 2, 2, 1};
     std::vector<bool> enc_use_dropout;
     std::vector<bool> dec_use_dropout;
+    bool compact = vm["compact_indices"].as<bool>();
     if (vm["no_dropout"].as<bool>()){
         enc_use_dropout = {false, false, false, false, false};
         dec_use_dropout = {false, false, false, false, false};
@@ -40,10 +42,10 @@ SegNetImpl::SegNetImpl(po::variables_map &vm){
     
     for (size_t i = 0; i < this->num_downs; i++){
         this->encoder->push_back(
-            DownSamplingImpl(enc_features.at(i), enc_features.at(i + 1), enc_n_layers.at(i), enc_use_dropout.at(i))
+            DownSamplingImpl(enc_features.at(i), enc_features.at(i + 1), enc_n_layers.at(i), enc_use_dropout.at(i), compact)
         );
         this->decoder->push_back(
-            UpSamplingImpl(dec_features.at(i), dec_features.at(i + 1), dec_n_layers.at(i), dec_use_dropout.at(i))
+            UpSamplingImpl(dec_features.at(i), dec_features.at(i + 1), dec_n_layers.at(i), dec_use_dropout.at(i), compact)
         );
     }
     register_module("encoder", this->encoder);
@@ -88,8 +90,10 @@ torch::Tensor SegNetImpl::forward(torch::Tensor x){
 // ----------------------------------------------------------------------
 // struct{DownSamplingImpl}(nn::Module) -> constructor
 // ----------------------------------------------------------------------
-DownSamplingImpl::DownSamplingImpl(const size_t in_nc, const size_t out_nc, const size_t n_layers, const bool use_dropout){
+DownSamplingImpl::DownSamplingImpl(const size_t in_nc, const size_t out_nc, const size_t n_layers, const bool use_dropout, const bool compact_){
     
+    this->compact = compact_;
+
     this->features = nn::Sequential(
         nn::Conv2d(nn::Conv2dOptions(in_nc, out_nc, 3).stride(1).padding(1).bias(true)),
         nn::BatchNorm2d(out_nc),
@@ -123,7 +127,12 @@ std::tuple<torch::Tensor, torch::Tensor, std::vector<long int>> DownSamplingImpl
     std::tuple<torch::Tensor, torch::Tensor, std::vector<long int>> out;
     
     feature = this->features->forward(x);
-    tensor_with_indices = this->pool->forward_with_indices(feature);
+    if (this->compact){
+        tensor_with_indices = compact_max_pool2d(feature);  // {C,H,W} ===> {C,H/2,W/2} + uint8 offsets
+    }
+    else{
+        tensor_with_indices = this->pool->forward_with_indices(feature);  // {C,H,W} ===> {C,H/2,W/2} + int64 indices
+    }
     sizes_size = feature.sizes().size();
     for (size_t i = 0; i < sizes_size; i++){
         sizes_list.push_back(feature.size(i));
@@ -137,8 +146,10 @@ std::tuple<torch::Tensor, torch::Tensor, std::vector<long int>> DownSamplingImpl
 // ----------------------------------------------------------------------
 // struct{UpSamplingImpl}(nn::Module) -> constructor
 // ----------------------------------------------------------------------
-UpSamplingImpl::UpSamplingImpl(const size_t in_nc, const size_t out_nc, const size_t n_layers, const bool use_dropout){
+UpSamplingImpl::UpSamplingImpl(const size_t in_nc, const size_t out_nc, const size_t n_layers, const bool use_dropout, const bool compact_){
     
+    this->compact = compact_;
+
     for (size_t i = 0; i < n_layers - 1; i++){
         this->features->push_back(nn::Conv2d(nn::Conv2dOptions(in_nc, in_nc, 3).stride(1).padding(1).bias(true)));
         this->features->push_back(nn::BatchNorm2d(in_nc));
@@ -162,8 +173,14 @@ UpSamplingImpl::UpSamplingImpl(const size_t in_nc, const size_t out_nc, const si
 // struct{UpSamplingImpl}(nn::Module) -> function{forward}
 // ----------------------------------------------------------------------
 torch::Tensor UpSamplingImpl::forward(torch::Tensor x, torch::Tensor indices, const std::vector<long int> unpool_sizes){
-    torch::Tensor feature = this->unpool->forward(x, indices, unpool_sizes);
-    torch::Tensor out = this->features->forward(feature);
+    torch::Tensor feature, out;
+    if (this->compact){
+        feature = compact_max_unpool2d(x, indices, unpool_sizes);  // {C,H/2,W/2} ===> {C,H,W}
+    }
+    else{
+        feature = this->unpool->forward(x, indices, unpool_sizes);  // {C,H/2,W/2} ===> {C,H,W}
+    }
+    out = this->features->forward(feature);
     return out;
 }
 
@@ -188,3 +205,118 @@ void weights_init(nn::Module &m){
     }
     return;
 }
+
+
+// ----------------------------
+// function{pool_offsets}
+// ----------------------------
+// 2x2 max pooling with the position of the maximum in each window as the offset dy*2+dx in {0,1,2,3} of uint8
+static std::tuple<torch::Tensor, torch::Tensor> pool_offsets(torch::Tensor x){
+    long int width = x.size(3);
+    torch::Tensor out, indices, offsets;
+    std::tie(out, indices) = torch::max_pool2d_with_indices(x, /*kernel_size=*/{2, 2}, /*stride=*/{2, 2});  // {C,H,W} ===> {C,H/2,W/2}
+    offsets = (indices.remainder(2 * width) >= width).to(torch::kUInt8).mul_(2);  // dy : odd row of the input
+    offsets.add_(indices.remainder(width).remainder(2).to(torch::kUInt8));       // dx : odd column of the input
+    return {out, offsets};
+}
+
+
+// ----------------------------
+// function{unpool_offsets}
+// ----------------------------
+// Place each value at the offset in its 2x2 window, and fill the others with 0 : {C,H/2,W/2} ===> {C,H,W}
+static torch::Tensor unpool_offsets(torch::Tensor x, torch::Tensor offsets, const std::vector<long int> unpool_sizes){
+    torch::Tensor positions, out;
+    positions = torch::arange(4, offsets.options()).view({1, 1, 4, 1, 1});                   // {4}
+    out = x.unsqueeze(/*dim=*/2) * (offsets.unsqueeze(/*dim=*/2) == positions);               // {C,H/2,W/2} ===> {C,4,H/2,W/2}
+    out = out.view({x.size(0), x.size(1) * 4, x.size(2), x.size(3)});                         // {C,4,H/2,W/2} ===> {4C,H/2,W/2}
+    out = torch::pixel_shuffle(out, /*upscale_factor=*/2);                                     // {4C,H/2,W/2} ===> {C,H',W'}
+    if ((out.size(2) != unpool_sizes.at(2)) || (out.size(3) != unpool_sizes.at(3))){
+        out = F::pad(out, F::PadFuncOptions({0, unpool_sizes.at(3) - out.size(3), 0, unpool_sizes.at(2) - out.size(2)}));  // {C,H',W'} ===> {C,H,W} (odd sizes)
+    }
+    return out;
+}
+
+
+// ----------------------------
+// function{gather_offsets}
+// ----------------------------
+// Take the value at the offset in each 2x2 window : {C,H,W} ===> {C,H/2,W/2}
+static torch::Tensor gather_offsets(torch::Tensor x, torch::Tensor offsets){
+    long int mini_batch_size = offsets.size(0);
+    long int channels = offsets.size(1);
+    long int height = offsets.size(2);
+    long int width = offsets.size(3);
+    torch::Tensor windows;
+    windows = x.narrow(/*dim=*/2, /*start=*/0, /*length=*/height * 2).narrow(/*dim=*/3, /*start=*/0, /*length=*/width * 2);  // {C,H,W} ===> {C,H',W'}
+    windows = windows.reshape({mini_batch_size, channels, height, 2, width, 2}).permute({0, 1, 2, 4, 3, 5});                   // {C,H',W'} ===> {C,H/2,W/2,2,2}
+    windows = windows.reshape({mini_batch_size, channels, height, width, 4});                                                   // {C,H/2,W/2,2,2} ===> {C,H/2,W/2,4}
+    return windows.gather(/*dim=*/4, offsets.to(torch::kLong).unsqueeze(/*dim=*/4)).squeeze(/*dim=*/4);                        // {C,H/2,W/2,4} ===> {C,H/2,W/2}
+}
+
+
+// ----------------------------
+// function{compact_max_pool2d}
+// ----------------------------
+// The offsets take 1 byte for each output instead of 8 bytes of int64 indices, and the autograd graph keeps only them.
+std::tuple<torch::Tensor, torch::Tensor> compact_max_pool2d(torch::Tensor x){
+    if (!torch::GradMode::is_enabled()){
+        return pool_offsets(x);
+    }
+    torch::autograd::variable_list out = CompactMaxPool2dFunction::apply(x);
+    return {out.at(0), out.at(1)};
+}
+
+
+// ----------------------------
+// function{compact_max_unpool2d}
+// ----------------------------
+torch::Tensor compact_max_unpool2d(torch::Tensor x, torch::Tensor offsets, const std::vector<long int> unpool_sizes){
+    if (!torch::GradMode::is_enabled()){
+        return unpool_offsets(x, offsets, unpool_sizes);
+    }
+    return CompactMaxUnpool2dFunction::apply(x, offsets, unpool_sizes);
+}
+
+
+// -------------------------------------------------------------------------------
+// struct{CompactMaxPool2dFunction}(autograd::Function) -> function{forward}
+// -------------------------------------------------------------------------------
+torch::autograd::variable_list CompactMaxPool2dFunction::forward(torch::autograd::AutogradContext *ctx, torch::Tensor x){
+    torch::Tensor out, offsets;
+    std::tie(out, offsets) = pool_offsets(x);
+    ctx->save_for_backward({offsets});
+    ctx->saved_data["sizes"] = x.sizes().vec();
+    ctx->mark_non_differentiable({offsets});
+    return {out, offsets};
+}
+
+
+// -------------------------------------------------------------------------------
+// struct{CompactMaxPool2dFunction}(autograd::Function) -> function{backward}
+// -------------------------------------------------------------------------------
+// The gradient goes to the position of the maximum in each window.
+torch::autograd::variable_list CompactMaxPool2dFunction::backward(torch::autograd::AutogradContext *ctx, torch::autograd::variable_list grad_output){
+    torch::Tensor offsets = ctx->get_saved_variables().at(0);
+    std::vector<long int> sizes = ctx->saved_data["sizes"].toIntVector();
+    return {unpool_offsets(grad_output.at(0), offsets, sizes)};
+}
+
+
+// -------------------------------------------------------------------------------
+// struct{CompactMaxUnpool2dFunction}(autograd::Function) -> function{forward}
+// -------------------------------------------------------------------------------
+torch::Tensor CompactMaxUnpool2dFunction::forward(torch::autograd::AutogradContext *ctx, torch::Tensor x, torch::Tensor offsets, const std::vector<long int> unpool_sizes){
+    ctx->save_for_backward({offsets});
+    return unpool_offsets(x, offsets, unpool_sizes);
+}
+
+
+// -------------------------------------------------------------------------------
+// struct{CompactMaxUnpool2dFunction}(autograd::Function) -> function{backward}
+// -------------------------------------------------------------------------------
+// The gradient comes from the position of the offset in each window : one gradient for each of {x, offsets, unpool_sizes}
+torch::autograd::variable_list CompactMaxUnpool2dFunction::backward(torch::autograd::AutogradContext *ctx, torch::autograd::variable_list grad_output){
+    torch::Tensor offsets = ctx->get_saved_variables().at(0);
+    return {gather_offsets(grad_output.at(0), offsets), torch::Tensor(), torch::Tensor()};
+}
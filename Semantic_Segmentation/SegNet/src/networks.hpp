@@ -13,6 +13,8 @@ namespace po = boost::program_options;
 
 // Function Prototype
 void weights_init(nn::Module &m);
+std::tuple<torch::Tensor, torch::Tensor> compact_max_pool2d(torch::Tensor x);
+torch::Tensor compact_max_unpool2d(torch::Tensor x, torch::Tensor offsets, const std::vector<long int> unpool_sizes);
 
 
 // --------------------------------
@@ -34,11 +36,12 @@ public:
 // -------------------------------------
 struct DownSamplingImpl : nn::Module{
 private:
+    bool compact;
     nn::Sequential features;
     nn::MaxPool2d pool{nullptr};
 public:
     DownSamplingImpl(){}
-    DownSamplingImpl(const size_t in_nc, const size_t out_nc, const size_t n_layers=2, const bool use_dropout=false);
+    DownSamplingImpl(const size_t in_nc, const size_t out_nc, const size_t n_layers=2, const bool use_dropout=false, const bool compact_=false);
     std::tuple<torch::Tensor, torch::Tensor, std::vector<long int>> forward(torch::Tensor x);
 };
 
@@ -47,15 +50,34 @@ public:
 // -----------------------------------
 struct UpSamplingImpl : nn::Module{
 private:
+    bool compact;
     nn::Sequential features;
     nn::MaxUnpool2d unpool{nullptr};
 public:
     UpSamplingImpl(){}
-    UpSamplingImpl(const size_t in_nc, const size_t out_nc, const size_t n_layers=2, const bool use_dropout=false);
+    UpSamplingImpl(const size_t in_nc, const size_t out_nc, const size_t n_layers=2, const bool use_dropout=false, const bool compact_=false);
     torch::Tensor forward(torch::Tensor x, torch::Tensor indices, const std::vector<long int> unpool_sizes);
 };
 
 
+// -------------------------------------------------------------
+// struct{CompactMaxPool2dFunction}(autograd::Function)
+// -------------------------------------------------------------
+// The backward pass keeps only the uint8 offsets instead of the int64 indices of MaxPool2d.
+struct CompactMaxPool2dFunction : public torch::autograd::Function<CompactMaxPool2dFunction>{
+    static torch::autograd::variable_list forward(torch::autograd::AutogradContext *ctx, torch::Tensor x);
+    static torch::autograd::variable_list backward(torch::autograd::AutogradContext *ctx, torch::autograd::variable_list grad_output);
+};
+
+// -------------------------------------------------------------
+// struct{CompactMaxUnpool2dFunction}(autograd::Function)
+// -------------------------------------------------------------
+struct CompactMaxUnpool2dFunction : public torch::autograd::Function<CompactMaxUnpool2dFunction>{
+    static torch::Tensor forward(torch::autograd::AutogradContext *ctx, torch::Tensor x, torch::Tensor offsets, const std::vector<long int> unpool_sizes);
+    static torch::autograd::variable_list backward(torch::autograd::AutogradContext *ctx, torch::autograd::variable_list grad_output);
+};
+
+
 TORCH_MODULE(SegNet);
 TORCH_MODULE(DownSampling);
 TORCH_MODULE(UpSampling);
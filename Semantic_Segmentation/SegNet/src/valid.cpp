@@ -11,6 +11,7 @@
 #include "networks.hpp"                // SegNet
 #include "dataloader.hpp"              // DataLoader::ImageFolderSegmentWithPaths
 #include "visualizer.hpp"              // visualizer::graph
+#include "evaluation.hpp"              // evaluation::ConfusionMatrix
 
 // Define Namespace
 namespace po = boost::program_options;
@@ -22,22 +23,20 @@ namespace po = boost::program_options;
 void valid(po::variables_map &vm, DataLoader::ImageFolderSegmentWithPaths &valid_dataloader, torch::Device &device, Loss &criterion, SegNet &model, const size_t epoch, visualizer::graph &writer){
 
     // (0) Initialization and Declaration
-    size_t correct, correct_per_class, total_class_pixel, class_count;
     size_t iteration;
-    float ave_loss, total_loss;
-    double pixel_wise_accuracy, ave_pixel_wise_accuracy, total_pixel_wise_accuracy;
-    double mean_accuracy, ave_mean_accuracy, total_mean_accuracy;
+    float ave_loss;
+    double pixel_wise_accuracy, mean_accuracy, mean_iou;
     std::ofstream ofs;
     std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>, std::vector<std::string>, std::vector<std::tuple<unsigned char, unsigned char, unsigned char>>> mini_batch;
-    torch::Tensor image, label, output, output_argmax, answer_mask, response_mask;
-    torch::Tensor loss;
+    torch::Tensor image, label, output;
+    torch::Tensor loss, total_loss;
+    evaluation::ConfusionMatrix confusion;
 
     // (1) Tensor Forward per Mini Batch
+    torch::NoGradGuard no_grad;
     model->eval();
     iteration = 0;
-    total_loss = 0.0;
-    total_pixel_wise_accuracy = 0.0;
-    total_mean_accuracy = 0.0;
+    total_loss = torch::zeros({}).to(device);
     while (valid_dataloader(mini_batch)){
 
         image = std::get<0>(mini_batch).to(device);
@@ -46,41 +45,27 @@ void valid(po::variables_map &vm, DataLoader::ImageFolderSegmentWithPaths &valid
         output = model->forward(image);
         loss = criterion(output, label);
 
-        output_argmax = output.exp().argmax(/*dim=*/1, /*keepdim=*/true);
-        correct = (label == output_argmax).sum().item<long int>();
-        pixel_wise_accuracy = (double)correct / (double)(label.size(0) * label.size(1) * label.size(2));
-
-        class_count = 0;
-        mean_accuracy = 0.0;
-        for (size_t i = 0; i < std::get<4>(mini_batch).size(); i++){
-            answer_mask = torch::full({label.size(0), label.size(1), label.size(2)}, /*value=*/(long int)i, torch::TensorOptions().dtype(torch::kLong)).to(device);
-            total_class_pixel = (label == answer_mask).sum().item<long int>();
-            if (total_class_pixel != 0){
-                response_mask = torch::full({label.size(0), label.size(1), label.size(2)}, /*value=*/2, torch::TensorOptions().dtype(torch::kLong)).to(device);
-                correct_per_class = (((label == output_argmax).to(torch::kLong) + (label == answer_mask).to(torch::kLong)) == response_mask).sum().item<long int>();
-                mean_accuracy += (double)correct_per_class / (double)total_class_pixel;
-                class_count++;
-            }
+        if (iteration == 0){
+            confusion = evaluation::ConfusionMatrix(/*class_num_=*/output.size(1), /*k_=*/0);
         }
-        mean_accuracy = mean_accuracy / (double)class_count;
-
-        total_loss += loss.item<float>();
-        total_pixel_wise_accuracy += pixel_wise_accuracy;
-        total_mean_accuracy += mean_accuracy;
+        confusion.update(output, label);  // {N,K,H,W}, {N,H,W} ===> {K,K}
+        total_loss += loss.detach();
         iteration++;
     }
 
-    // (2) Calculate Average Loss
-    ave_loss = total_loss / (float)iteration;
-    ave_pixel_wise_accuracy = total_pixel_wise_accuracy / (double)iteration;
-    ave_mean_accuracy = total_mean_accuracy / (double)iteration;
+    // (2) Calculate Average Loss and Accuracy
+    ave_loss = total_loss.item<float>() / (float)iteration;
+    pixel_wise_accuracy = confusion.accuracy();
+    mean_accuracy = confusion.mean_accuracy();
+    mean_iou = confusion.mean_iou();
 
     // (3.1) Record Loss (Log)
     ofs.open("checkpoints/" + vm["dataset"].as<std::string>() + "/log/valid.txt", std::ios::app);
     ofs << "epoch:" << epoch << '/' << vm["epochs"].as<size_t>() << ' ' << std::flush;
     ofs << "classify:" << ave_loss << ' ' << std::flush;
-    ofs << "pixel-wise-accuracy:" << ave_pixel_wise_accuracy << ' ' << std::flush;
-    ofs << "mean-accuracy:" << ave_mean_accuracy << std::endl;
+    ofs << "pixel-wise-accuracy:" << pixel_wise_accuracy << ' ' << std::flush;
+    ofs << "mean-accuracy:" << mean_accuracy << ' ' << std::flush;
+    ofs << "mIoU:" << mean_iou << std::endl;
     ofs.close();
 
     // (3.2) Record Loss (Graph)
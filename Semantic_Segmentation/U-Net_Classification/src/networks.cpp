@@ -1,10 +1,13 @@
 #include <utility>
+#include <vector>
 #include <typeinfo>
 #include <cmath>
 // For External Library
 #include <torch/torch.h>
 // For Original Header
 #include "networks.hpp"
+#include "checkpointing.hpp"
+#include "skipconnection.hpp"
 
 // Define Namespace
 namespace nn = torch::nn;
@@ -19,16 +22,17 @@ UNetImpl::UNetImpl(po::variables_map &vm){
     size_t feature = vm["nf"].as<size_t>();
     size_t num_downs = (size_t)(std::log2(vm["size"].as<size_t>()));
     bool use_dropout = !vm["no_dropout"].as<bool>();
+    std::vector<bool> recompute = checkpointing::parse_depths(vm["recompute_depths"].as<std::string>(), num_downs);  // depth 0 (outermost) to num_downs-1 (innermost)
 
     UNetBlockImpl blocks, fake;
-    blocks = UNetBlockImpl({feature*8, feature*8}, vm["nz"].as<size_t>(), /*submodule_=*/fake, /*outermost_=*/false, /*innermost=*/true);
+    blocks = UNetBlockImpl({feature*8, feature*8}, vm["nz"].as<size_t>(), /*submodule_=*/fake, /*outermost_=*/false, /*innermost=*/true, /*use_dropout=*/false, /*recompute_=*/recompute.at(num_downs - 1));
     for (size_t i = 0; i < num_downs - 5; i++){
-        blocks = UNetBlockImpl({feature*8, feature*8}, feature*8, /*submodule_=*/blocks, /*outermost_=*/false, /*innermost=*/false, /*use_dropout=*/use_dropout);
+        blocks = UNetBlockImpl({feature*8, feature*8}, feature*8, /*submodule_=*/blocks, /*outermost_=*/false, /*innermost=*/false, /*use_dropout=*/use_dropout, /*recompute_=*/recompute.at(num_downs - 2 - i));
     }
-    blocks = UNetBlockImpl({feature*4, feature*4}, feature*8, /*submodule_=*/blocks);
-    blocks = UNetBlockImpl({feature*2, feature*2}, feature*4, /*submodule_=*/blocks);
-    blocks = UNetBlockImpl({feature, feature}, feature*2, /*submodule_=*/blocks);
-    blocks = UNetBlockImpl({vm["nc"].as<size_t>(), vm["class_num"].as<size_t>()}, feature, /*submodule_=*/blocks, /*outermost_=*/true);
+    blocks = UNetBlockImpl({feature*4, feature*4}, feature*8, /*submodule_=*/blocks, /*outermost_=*/false, /*innermost=*/false, /*use_dropout=*/false, /*recompute_=*/recompute.at(3));
+    blocks = UNetBlockImpl({feature*2, feature*2}, feature*4, /*submodule_=*/blocks, /*outermost_=*/false, /*innermost=*/false, /*use_dropout=*/false, /*recompute_=*/recompute.at(2));
+    blocks = UNetBlockImpl({feature, feature}, feature*2, /*submodule_=*/blocks, /*outermost_=*/false, /*innermost=*/false, /*use_dropout=*/false, /*recompute_=*/recompute.at(1));
+    blocks = UNetBlockImpl({vm["nc"].as<size_t>(), vm["class_num"].as<size_t>()}, feature, /*submodule_=*/blocks, /*outermost_=*/true, /*innermost=*/false, /*use_dropout=*/false, /*recompute_=*/recompute.at(0));
     
     this->model->push_back(blocks);
     register_module("U-Net", this->model);
@@ -49,9 +53,10 @@ torch::Tensor UNetImpl::forward(torch::Tensor x){
 // ----------------------------------------------------------------------
 // struct{UNetBlockImpl}(nn::Module) -> constructor
 // ----------------------------------------------------------------------
-UNetBlockImpl::UNetBlockImpl(const std::pair<size_t, size_t> outside_nc, const size_t inside_nc, UNetBlockImpl &submodule, bool outermost_, bool innermost, bool use_dropout){
+UNetBlockImpl::UNetBlockImpl(const std::pair<size_t, size_t> outside_nc, const size_t inside_nc, UNetBlockImpl &submodule, bool outermost_, bool innermost, bool use_dropout, bool recompute_){
 
     this->outermost = outermost_;
+    this->recompute = recompute_;
 
     if (this->outermost){  // {IC,256,256} ===> {F,128,128} ===> ... ===> {2F,128,128} ===> {OC,256,256}
         DownSampling(this->model, outside_nc.first, inside_nc, /*BN=*/false, /*ReLU=*/false);  // {IC,256,256} ===> {F,128,128}
@@ -79,14 +84,18 @@ UNetBlockImpl::UNetBlockImpl(const std::pair<size_t, size_t> outside_nc, const s
 // ----------------------------------------------------------------------
 // struct{UNetBlockImpl}(nn::Module) -> function{forward}
 // ----------------------------------------------------------------------
+// With "recompute", the activations inside the block are not kept, and are computed again in the backward pass.
+// ----------------------------------------------------------------------
 torch::Tensor UNetBlockImpl::forward(torch::Tensor x){
     torch::Tensor out;
-    if (this->outermost){
-        out = this->model->forward(x);
+    if (!this->outermost){
+        return skipconnection::forward(this->model, x, this->recompute);  // {NF,H,W} ===> {2NF,H,W}
+    }
+    if (this->recompute){
+        out = checkpointing::forward(this->model, x);
     }
     else{
         out = this->model->forward(x);
-        out = torch::cat({x, out}, /*dim=*/1);
     }
     return out;
 }
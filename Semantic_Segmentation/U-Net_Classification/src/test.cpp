@@ -1,18 +1,21 @@
 #include <iostream>                    // std::cout
-#include <fstream>                     // std::ifstream, std::ofstream
+#include <fstream>                     // std::ifstream
 #include <filesystem>                  // std::filesystem
 #include <string>                      // std::string
-#include <chrono>                      // std::chrono
+#include <vector>                      // std::vector
+#include <algorithm>                   // std::max
 // For External Library
 #include <torch/torch.h>               // torch
 #include <boost/program_options.hpp>   // boost::program_options
 // For Original Header
-#include "loss.hpp"                    // Loss
 #include "networks.hpp"                // UNet
 #include "transforms.hpp"              // transforms::Compose
 #include "datasets.hpp"                // datasets::ImageFolderSegmentWithPaths
 #include "dataloader.hpp"              // DataLoader::ImageFolderSegmentWithPaths
 #include "visualizer.hpp"              // visualizer
+#include "tiling.hpp"                  // tiling::SlidingWindow
+#include "fusion.hpp"                  // fusion::load_folded
+#include "evaluation.hpp"              // evaluation::Runner, evaluation::ConfusionMatrix, evaluation::BufferedWriter, evaluation::EachLoss, evaluation::each
 
 // Define Namespace
 namespace fs = std::filesystem;
@@ -25,104 +28,149 @@ namespace po = boost::program_options;
 void test(po::variables_map &vm, torch::Device &device, UNet &model, std::vector<transforms::Compose*> &transformI, std::vector<transforms::Compose*> &transformO){
 
     // (0) Initialization and Declaration
-    size_t correct, correct_per_class, total_class_pixel, class_count;
+    size_t i, m;
+    bool tiled;
+    long int mini_batch_size, class_num;
     float ave_loss;
-    double seconds, ave_time;
-    double pixel_wise_accuracy, ave_pixel_wise_accuracy;
-    double mean_accuracy, ave_mean_accuracy;
+    double ave_time;
+    double ave_pixel_wise_accuracy;
+    double ave_mean_accuracy;
+    double mean_iou;
     std::string path, result_dir, fname;
     std::string input_dir, output_dir;
-    std::ofstream ofs;
-    std::chrono::system_clock::time_point start, end;
+    std::vector<double> ave;
+    std::vector<float> class_accuracy, iou;
+    std::vector<std::vector<float>> rows;
     std::tuple<torch::Tensor, torch::Tensor, std::vector<std::string>, std::vector<std::string>, std::vector<std::tuple<unsigned char, unsigned char, unsigned char>>> data;
-    torch::Tensor image, label, output, output_argmax, answer_mask, response_mask;
-    torch::Tensor loss;
+    torch::Tensor image, label, output, output_argmax;
+    torch::Tensor loss, valid, index, confusion_each, correct, correct_per_class, total_class_pixel, exist;
+    torch::Tensor pixel_wise_accuracy, mean_accuracy;
     datasets::ImageFolderSegmentWithPaths dataset;
     DataLoader::ImageFolderSegmentWithPaths dataloader;
+    evaluation::Runner runner;
+    evaluation::ConfusionMatrix confusion;
+    evaluation::BufferedWriter ofs, ofs2;
+    tiling::SlidingWindow tiler;
 
     // (1) Get Test Dataset
     input_dir = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_in_dir"].as<std::string>();
     output_dir = "datasets/" + vm["dataset"].as<std::string>() + '/' + vm["test_out_dir"].as<std::string>();
     dataset = datasets::ImageFolderSegmentWithPaths(input_dir, output_dir, transformI, transformO);
-    dataloader = DataLoader::ImageFolderSegmentWithPaths(dataset, /*batch_size_=*/1, /*shuffle_=*/false, /*num_workers_=*/0);
+    dataloader = DataLoader::ImageFolderSegmentWithPaths(dataset, /*batch_size_=*/(vm["test_tiled"].as<bool>() ? 1 : vm["test_batch_size"].as<size_t>()), /*shuffle_=*/false, /*num_workers_=*/vm["test_workers"].as<size_t>());
     std::cout << "total test images : " << dataset.size() << std::endl << std::endl;
+    tiled = vm["test_tiled"].as<bool>();
+    if (tiled){
+        tiler = tiling::SlidingWindow(/*tile_=*/vm["size"].as<size_t>(), /*overlap_=*/vm["tile_overlap"].as<size_t>(), /*tile_batch_=*/vm["tile_batch_size"].as<size_t>());
+    }
+    m = tiled ? 0 : 1;  // column of pixel-wise accuracy (cross-entropy is not available in tiled inference)
 
     // (2) Get Model
     path = "checkpoints/" + vm["dataset"].as<std::string>() + "/models/epoch_" + vm["test_load_epoch"].as<std::string>() + ".pth";
-    torch::load(model, path);
+    if (vm["test_fold_bn"].as<bool>()){
+        fusion::load_folded(model, path);
+    }
+    else{
+        torch::load(model, path);
+    }
 
     // (3) Set Loss Function
-    auto criterion = Loss();
-
-    // (4) Initialization of Value
-    ave_loss = 0.0;
-    ave_pixel_wise_accuracy = 0.0;
-    ave_mean_accuracy = 0.0;
-    ave_time = 0.0;
+    auto criterion = evaluation::EachLoss("nll");
 
-    // (5) Tensor Forward
+    // (4) Tensor Forward
+    torch::NoGradGuard no_grad;
     model->eval();
     result_dir = vm["test_result_dir"].as<std::string>();  fs::create_directories(result_dir);
-    ofs.open(result_dir + "/loss.txt", std::ios::out);
+    if (vm["test_archive"].as<bool>()) visualizer::open_archive(result_dir + "/images.tar");
+    ofs.open(result_dir + "/loss.txt");
     while (dataloader(data)){
         
         image = std::get<0>(data).to(device);
         label = std::get<1>(data).to(device);
+        mini_batch_size = image.size(0);
         
-        start = std::chrono::system_clock::now();
+        runner.start_timer();
         
-        output = model->forward(image);
-
-        end = std::chrono::system_clock::now();
-        seconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 0.001 * 0.001;
-
-        loss = criterion(output, label);
-        
-        output_argmax = output.exp().argmax(/*dim=*/1, /*keepdim=*/true);
-        correct = (label == output_argmax).sum().item<long int>();
-        pixel_wise_accuracy = (double)correct / (double)(label.size(0) * label.size(1) * label.size(2));
-
-        class_count = 0;
-        mean_accuracy = 0.0;
-        for (size_t i = 0; i < std::get<4>(data).size(); i++){
-            answer_mask = torch::full({label.size(0), label.size(1), label.size(2)}, /*value=*/(long int)i, torch::TensorOptions().dtype(torch::kLong)).to(device);
-            total_class_pixel = (label == answer_mask).sum().item<long int>();
-            if (total_class_pixel != 0){
-                response_mask = torch::full({label.size(0), label.size(1), label.size(2)}, /*value=*/2, torch::TensorOptions().dtype(torch::kLong)).to(device);
-                correct_per_class = (((label == output_argmax).to(torch::kLong) + (label == answer_mask).to(torch::kLong)) == response_mask).sum().item<long int>();
-                mean_accuracy += (double)correct_per_class / (double)total_class_pixel;
-                class_count++;
-            }
+        // (4.1) Metrics on Device
+        if (tiled){
+            output_argmax = tiler.vote([&](torch::Tensor tile){ return model->forward(tile); }, image).unsqueeze(1);  // {N,C,H,W} ===> {N,1,H,W} (tiles of {size,size})
+            class_num = std::max((long int)std::get<4>(data).size(), (long int)vm["class_num"].as<size_t>());
+        }
+        else{
+            output = model->forward(image);                                     // {N,C,H,W} ===> {N,K,H,W}
+            loss = evaluation::each(criterion, output, label);                  // {N,K,H,W}, {N,H,W} ===> {N}
+            output_argmax = output.argmax(/*dim=*/1, /*keepdim=*/true);         // {N,K,H,W} ===> {N,1,H,W}
+            class_num = std::max((long int)std::get<4>(data).size(), output.size(1));
         }
-        mean_accuracy = mean_accuracy / (double)class_count;
+        valid = (label >= 0).logical_and(label < class_num);            // {N,H,W}
+        index = torch::arange(mini_batch_size, label.options()).view({mini_batch_size, 1, 1}) * class_num * class_num + label.clamp(0, class_num - 1) * class_num + output_argmax.squeeze(1);  // {N,H,W}
+        index = torch::where(valid, index, mini_batch_size * class_num * class_num);  // {N,H,W} (invalid pixels go to the last bin, without a data-dependent size)
+        confusion_each = torch::bincount(index.flatten(), /*weights=*/{}, /*minlength=*/mini_batch_size * class_num * class_num + 1).narrow(/*dim=*/0, /*start=*/0, /*length=*/mini_batch_size * class_num * class_num).view({mini_batch_size, class_num, class_num});  // {N*K*K+1} ===> {N,K,K}
+        correct_per_class = confusion_each.diagonal(/*offset=*/0, /*dim1=*/1, /*dim2=*/2).to(torch::kDouble);  // {N,K,K} ===> {N,K}
+        total_class_pixel = confusion_each.sum(/*dim=*/2).to(torch::kDouble);   // {N,K,K} ===> {N,K}
+        correct = correct_per_class.sum(/*dim=*/1);                            // {N,K} ===> {N}
+        pixel_wise_accuracy = correct / (double)(label.size(1) * label.size(2));  // {N}
+        exist = (total_class_pixel > 0).to(torch::kDouble);                    // {N,K}
+        mean_accuracy = (correct_per_class / total_class_pixel.clamp_min(1.0) * exist).sum(/*dim=*/1) / exist.sum(/*dim=*/1);  // {N}
+        if (runner.size() == 0){
+            confusion = evaluation::ConfusionMatrix(/*class_num_=*/class_num, /*k_=*/0);
+        }
+        confusion.update_index(output_argmax.squeeze(1), label);               // {N,H,W}, {N,H,W} ===> {K,K}
 
-        ave_loss += loss.item<float>();
-        ave_pixel_wise_accuracy += pixel_wise_accuracy;
-        ave_mean_accuracy += mean_accuracy;
-        ave_time += seconds;
+        // (4.2) Synchronize Once per Mini Batch
+        if (tiled){
+            rows = runner.push({pixel_wise_accuracy, mean_accuracy});          // {N} * 2 ===> {N,2}
+        }
+        else{
+            rows = runner.push({loss, pixel_wise_accuracy, mean_accuracy});    // {N} * 3 ===> {N,3}
+        }
+        output_argmax = output_argmax.to(torch::kCPU);
 
-        std::cout << '<' << std::get<2>(data).at(0) << "> cross-entropy:" << loss.item<float>() << " pixel-wise-accuracy:" << pixel_wise_accuracy << " mean-accuracy:" << mean_accuracy << std::endl;
-        ofs << '<' << std::get<2>(data).at(0) << "> cross-entropy:" << loss.item<float>() << " pixel-wise-accuracy:" << pixel_wise_accuracy << " mean-accuracy:" << mean_accuracy << std::endl;
+        runner.stop_timer();
 
-        fname = result_dir + '/' + std::get<3>(data).at(0);
-        visualizer::save_label(output_argmax.detach(), fname, std::get<4>(data), /*cols=*/1, /*padding=*/0);
+        // (4.3) Write Results
+        for (i = 0; i < rows.size(); i++){
+            ofs << '<' << std::get<2>(data).at(i) << '>';
+            if (!tiled) ofs << " cross-entropy:" << rows.at(i).at(0);
+            ofs << " pixel-wise-accuracy:" << rows.at(i).at(m) << " mean-accuracy:" << rows.at(i).at(m + 1) << '\n';
+            fname = result_dir + '/' + std::get<3>(data).at(i);
+            visualizer::save_label(output_argmax.narrow(/*dim=*/0, i, 1), fname, std::get<4>(data), /*cols=*/1, /*padding=*/0);
+        }
 
     }
 
-    // (6) Calculate Average
-    ave_loss = ave_loss / (float)dataset.size();
-    ave_pixel_wise_accuracy = ave_pixel_wise_accuracy / (double)dataset.size();
-    ave_mean_accuracy = ave_mean_accuracy / (double)dataset.size();
-    ave_time = ave_time / (double)dataset.size();
-
-    // (7) Average Output
-    std::cout << "<All> cross-entropy:" << ave_loss << " pixel-wise-accuracy:" << ave_pixel_wise_accuracy << " mean-accuracy:" << ave_mean_accuracy << " (time:" << ave_time << ')' << std::endl;
-    ofs << "<All> cross-entropy:" << ave_loss << " pixel-wise-accuracy:" << ave_pixel_wise_accuracy << " mean-accuracy:" << ave_mean_accuracy << " (time:" << ave_time << ')' << std::endl;
+    // (5) Calculate Average
+    ave = runner.get_ave();
+    ave_loss = tiled ? 0.0 : (float)ave.at(0);
+    ave_pixel_wise_accuracy = ave.at(m);
+    ave_mean_accuracy = ave.at(m + 1);
+    mean_iou = confusion.mean_iou();
+    class_accuracy = confusion.class_accuracy();
+    iou = confusion.iou();
+    ave_time = runner.get_ave_time();
+
+    // (6) Average Output
+    std::cout << "<All>";
+    ofs << "<All>";
+    if (!tiled){
+        std::cout << " cross-entropy:" << ave_loss;
+        ofs << " cross-entropy:" << ave_loss;
+    }
+    std::cout << " pixel-wise-accuracy:" << ave_pixel_wise_accuracy << " mean-accuracy:" << ave_mean_accuracy << " mIoU:" << mean_iou << " (time:" << ave_time << ')' << std::endl;
+    ofs << " pixel-wise-accuracy:" << ave_pixel_wise_accuracy << " mean-accuracy:" << ave_mean_accuracy << " mIoU:" << mean_iou << " (time:" << ave_time << ")\n";
+
+    // (7) Class-wise Output
+    ofs2.open(result_dir + "/class_metrics.csv");
+    ofs2 << "class,accuracy,IoU\n";
+    for (i = 0; i < iou.size(); i++){
+        ofs2 << i << ',' << class_accuracy.at(i) << ',' << iou.at(i) << '\n';
+    }
 
     // Post Processing
+    if (vm["test_archive"].as<bool>()) visualizer::close_archive();
     ofs.close();
+    ofs2.close();
 
     // End Processing
     return;
 
-}
\ No newline at end of file
+}
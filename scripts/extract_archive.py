@@ -0,0 +1,65 @@
+import os
+import sys
+import tarfile
+import argparse
+
+
+parser = argparse.ArgumentParser()
+
+# Define parameter
+parser.add_argument('--archive', type=str, help='the archive written with "--test_archive true"')
+parser.add_argument('--output_dir', type=str)
+parser.add_argument('--names', type=str, nargs='*', default=[], help='the names to extract through the index (all entries if not given)')
+parser.add_argument('--list', action='store_true', help='whether to only list the names in the index')
+
+args = parser.parse_args()
+
+def is_safe(name):
+    parts = name.replace('\\', '/').split('/')
+    return (not os.path.isabs(name)) and ('..' not in parts)
+
+index = {}
+with open(f'{args.archive}.idx') as f:
+    for line in f:
+        name, offset, size = line.rstrip('\n').rsplit(' ', 2)
+        if not is_safe(name):
+            print(f'Error : {name} is an absolute path or goes out of the output directory.')
+            sys.exit(1)
+        index[name] = (int(offset), int(size))
+
+if args.list:
+    for name, (offset, size) in index.items():
+        print(f'{name} {size}')
+    sys.exit()
+
+os.makedirs(f'{args.output_dir}', exist_ok=True)
+if len(args.names) == 0:
+    with tarfile.open(args.archive, 'r') as tar:
+        if hasattr(tarfile, 'data_filter'):
+            try:
+                tar.extractall(args.output_dir, filter='data')
+            except tarfile.FilterError as e:
+                print(f'Error : {e}')
+                sys.exit(1)
+        else:
+            members = tar.getmembers()
+            for member in members:
+                if (not member.isreg()) or (not is_safe(member.name)):
+                    print(f'Error : {member.name} is not a regular file inside the output directory.')
+                    sys.exit(1)
+            tar.extractall(args.output_dir, members=members)
+    print(f'{len(index)} files extracted')
+    sys.exit()
+
+with open(args.archive, 'rb') as f:
+    for name in args.names:
+        if name not in index:
+            print(f'Error : {name} is not in the archive.')
+            sys.exit(1)
+        offset, size = index[name]
+        f.seek(offset)
+        path = f'{args.output_dir}/{name}'
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, 'wb') as g:
+            g.write(f.read(size))
+print(f'{len(args.names)} files extracted')
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+python3 ../../scripts/extract_archive.py \
+    --archive test_result/images.tar \
+    --output_dir test_result/images
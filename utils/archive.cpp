@@ -0,0 +1,163 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+// For Original Header
+#include "archive.hpp"
+
+// Define Namespace
+namespace fs = std::filesystem;
+
+// Define Constant
+constexpr size_t block_size = 512;
+
+// Function Prototype
+static bool split_name(const std::string name, std::string &prefix, std::string &base);
+static void octal(char *field, const size_t length, const size_t value);
+
+
+// ----------------------------------------------------------
+// namespace{archive} -> class{tar} -> constructor
+// ----------------------------------------------------------
+archive::tar::tar(const std::string path_, const size_t buffer_size_){
+
+    this->path = path_;
+    this->buffer_size = buffer_size_;
+    this->offset = 0;
+    fs::path dir = fs::path(this->path).parent_path();
+    if (!dir.empty()) fs::create_directories(dir);
+
+    this->ofs.open(this->path, std::ios::out | std::ios::binary | std::ios::trunc);
+    this->ofs_index.open(this->path + ".idx", std::ios::out | std::ios::trunc);
+    if (!this->ofs.is_open() || !this->ofs_index.is_open()){
+        std::cerr << "Error : Couldn't open the archive '" << this->path << "'." << std::endl;
+        std::exit(1);
+    }
+    this->buffer.reserve(this->buffer_size + block_size);
+
+}
+
+
+// ----------------------------------------------------------
+// namespace{archive} -> class{tar} -> function{append}
+// ----------------------------------------------------------
+// {header (512 bytes), data, zero padding to 512 bytes} is added for each entry.
+bool archive::tar::append(const std::string name, const std::vector<unsigned char> &data){
+
+    // (0) Initialization and Declaration
+    size_t i, checksum, data_offset;
+    std::string prefix, base;
+    char header[block_size];
+
+    // (1) Header of ustar Format
+    if (!split_name(name, prefix, base)){
+        std::cerr << "Error : The name '" << name << "' is too long for the archive." << std::endl;
+        return false;
+    }
+    std::memset(header, 0, block_size);
+    std::memcpy(header, base.c_str(), base.size());                   // name
+    octal(header + 100, 8, 0644);                                     // mode
+    octal(header + 108, 8, 0);                                        // uid
+    octal(header + 116, 8, 0);                                        // gid
+    octal(header + 124, 12, data.size());                             // size
+    octal(header + 136, 12, (size_t)std::time(nullptr));              // mtime
+    std::memset(header + 148, ' ', 8);                                // checksum (spaces while summing)
+    header[156] = '0';                                                // typeflag (regular file)
+    std::memcpy(header + 257, "ustar", 6);                            // magic
+    std::memcpy(header + 263, "00", 2);                               // version
+    std::memcpy(header + 345, prefix.c_str(), prefix.size());         // prefix
+    checksum = 0;
+    for (i = 0; i < block_size; i++){
+        checksum += (unsigned char)header[i];
+    }
+    std::snprintf(header + 148, 8, "%06zo", checksum);
+    header[155] = ' ';
+
+    // (2) Append the Entry to the Buffer
+    std::lock_guard<std::mutex> lock(this->mtx);
+    if (!this->ofs.is_open()) return false;
+    this->buffer.insert(this->buffer.end(), header, header + block_size);
+    data_offset = this->offset + this->buffer.size();
+    this->buffer.insert(this->buffer.end(), data.begin(), data.end());
+    this->buffer.resize(this->buffer.size() + (block_size - data.size() % block_size) % block_size, 0);
+    this->index += name + ' ' + std::to_string(data_offset) + ' ' + std::to_string(data.size()) + '\n';
+
+    // (3) Sequential Output for the Full Buffer
+    if (this->buffer.size() >= this->buffer_size) this->write_buffer();
+
+    return true;
+
+}
+
+
+// ----------------------------------------------------------
+// namespace{archive} -> class{tar} -> function{write_buffer}
+// ----------------------------------------------------------
+void archive::tar::write_buffer(){
+    this->ofs.write(this->buffer.data(), this->buffer.size());
+    this->ofs.flush();
+    this->ofs_index << this->index << std::flush;
+    this->offset += this->buffer.size();
+    this->buffer.clear();
+    this->index.clear();
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{archive} -> class{tar} -> function{close}
+// ----------------------------------------------------------
+// Two zero blocks mark the end of the archive.
+void archive::tar::close(){
+    std::lock_guard<std::mutex> lock(this->mtx);
+    if (!this->ofs.is_open()) return;
+    this->buffer.resize(this->buffer.size() + block_size * 2, 0);
+    this->write_buffer();
+    this->ofs.close();
+    this->ofs_index.close();
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{archive} -> class{tar} -> destructor
+// ----------------------------------------------------------
+archive::tar::~tar(){
+    this->close();
+}
+
+
+// ----------------------------------------------------------
+// function{split_name}
+// ----------------------------------------------------------
+// ustar keeps up to 100 bytes in "name" and 155 bytes in "prefix", split at '/'.
+static bool split_name(const std::string name, std::string &prefix, std::string &base){
+    size_t pos;
+    if (name.size() <= 100){
+        prefix = "";
+        base = name;
+        return true;
+    }
+    pos = name.rfind('/', 155);  // the shortest name for the prefix within 155 bytes
+    if ((pos == std::string::npos) || (pos == 0) || (name.size() - pos - 1 > 100) || (pos + 1 == name.size())){
+        return false;
+    }
+    prefix = name.substr(0, pos);
+    base = name.substr(pos + 1);
+    return true;
+}
+
+
+// ----------------------------------------------------------
+// function{octal}
+// ----------------------------------------------------------
+static void octal(char *field, const size_t length, const size_t value){
+    std::snprintf(field, length, "%0*zo", (int)(length - 1), value);
+    return;
+}
@@ -0,0 +1,40 @@
+#ifndef ARCHIVE_HPP
+#define ARCHIVE_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+
+
+// --------------------
+// namespace{archive}
+// --------------------
+namespace archive{
+
+    // ---------------------------------------
+    // namespace{archive} -> class{tar}
+    // ---------------------------------------
+    // Append-only ustar archive, readable by "tar -xf", with the index "<path>.idx" of "name offset size" for each entry.
+    // The entries are gathered in memory and written sequentially in chunks of "buffer_size" bytes.
+    class tar{
+    private:
+        size_t offset, buffer_size;
+        std::string path;
+        std::vector<char> buffer;
+        std::string index;
+        std::ofstream ofs, ofs_index;
+        std::mutex mtx;
+        void write_buffer();
+    public:
+        tar(){}
+        tar(const std::string path_, const size_t buffer_size_=(64 << 20));
+        bool append(const std::string name, const std::vector<unsigned char> &data);
+        void close();
+        ~tar();
+    };
+
+}
+
+
+#endif
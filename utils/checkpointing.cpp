@@ -0,0 +1,189 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <mutex>
+#include <cstdlib>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "checkpointing.hpp"
+
+// Define Namespace
+namespace nn = torch::nn;
+
+// Function Prototype
+static torch::Tensor run(nn::SequentialImpl *seq, const size_t begin, torch::Tensor x);
+static std::vector<torch::Tensor> parameters(nn::SequentialImpl *seq, const size_t begin);
+static std::vector<torch::Tensor> buffers(nn::SequentialImpl *seq, const size_t begin);
+
+
+// ------------------------------------------------
+// namespace{checkpointing} -> function{parse_depths}
+// ------------------------------------------------
+// "d1,d2,..." ===> {false,true,...} for the depths 0 (outermost) to num-1 (innermost), "all" for all depths, and an empty string for none
+std::vector<bool> checkpointing::parse_depths(const std::string depths, const size_t num){
+
+    long int depth;
+    std::vector<bool> out(num, false);
+    std::stringstream ss(depths);
+    std::string item;
+
+    if (depths == "all"){
+        return std::vector<bool>(num, true);
+    }
+    while (std::getline(ss, item, ',')){
+        depth = std::stol(item);
+        if ((depth < 0) || (depth >= (long int)num)){
+            std::cerr << "Error : The depth to recompute is " << depth << '.' << std::endl;
+            std::cerr << "Error : Please give the depths from 0 (outermost) to " << num - 1 << " (innermost)." << std::endl;
+            std::exit(1);
+        }
+        out.at(depth) = true;
+    }
+
+    return out;
+
+}
+
+
+// ------------------------------------------------
+// namespace{checkpointing} -> function{forward}
+// ------------------------------------------------
+// The segment must not modify its input in place, since the input is kept for the recomputation.
+torch::Tensor checkpointing::forward(nn::Sequential &seq, torch::Tensor x, const size_t begin){
+    if (!torch::GradMode::is_enabled()){
+        return run(seq.get(), begin, x);
+    }
+    std::vector<torch::Tensor> params = parameters(seq.get(), begin);
+    return checkpointing::CheckpointFunction::apply(seq.get(), (int64_t)begin, x, torch::TensorList(params));
+}
+
+
+// ------------------------------------------------------------------------------
+// namespace{checkpointing} -> struct{CheckpointFunction} -> function{forward}
+// ------------------------------------------------------------------------------
+torch::Tensor checkpointing::CheckpointFunction::forward(torch::autograd::AutogradContext *ctx, nn::SequentialImpl *seq, const int64_t begin, torch::Tensor x, torch::TensorList params){
+
+    // (1) Keep the Random State for Dropout
+    at::Generator generator = at::globalContext().defaultGenerator(x.device());
+    {
+        std::lock_guard<std::mutex> lock(generator.mutex());
+        ctx->saved_data["rng_state"] = generator.get_state();
+    }
+
+    // (2) Keep only the Input
+    ctx->saved_data["module"] = reinterpret_cast<int64_t>(seq);
+    ctx->saved_data["begin"] = begin;
+    ctx->save_for_backward({x});
+
+    // (3) Forward without Graph
+    return run(seq, begin, x);
+
+}
+
+
+// ------------------------------------------------------------------------------
+// namespace{checkpointing} -> struct{CheckpointFunction} -> function{backward}
+// ------------------------------------------------------------------------------
+torch::autograd::variable_list checkpointing::CheckpointFunction::backward(torch::autograd::AutogradContext *ctx, torch::autograd::variable_list grad_output){
+
+    // (0) Initialization and Declaration
+    size_t i, j;
+    size_t begin;
+    nn::SequentialImpl *seq;
+    torch::Tensor x, out, rng_state;
+    std::vector<torch::Tensor> params, bufs, saved_bufs, inputs, grads;
+    torch::autograd::variable_list grad_input;
+
+    seq = reinterpret_cast<nn::SequentialImpl*>(ctx->saved_data["module"].toInt());
+    begin = (size_t)ctx->saved_data["begin"].toInt();
+    x = ctx->get_saved_variables().at(0);
+    params = parameters(seq, begin);
+    bufs = buffers(seq, begin);
+
+    // (1) Recompute Forward with the Same Random State
+    x = x.detach().requires_grad_(x.requires_grad());
+    for (auto &buf : bufs){
+        saved_bufs.push_back(buf.clone());
+    }
+    at::Generator generator = at::globalContext().defaultGenerator(x.device());
+    {
+        std::lock_guard<std::mutex> lock(generator.mutex());
+        rng_state = generator.get_state();
+        generator.set_state(ctx->saved_data["rng_state"].toTensor());
+    }
+    {
+        torch::AutoGradMode enable_grad(true);
+        out = run(seq, begin, x);
+    }
+    {
+        std::lock_guard<std::mutex> lock(generator.mutex());
+        generator.set_state(rng_state);
+    }
+
+    // (2) Restore the Running Statistics updated twice
+    {
+        torch::NoGradGuard no_grad;
+        for (i = 0; i < bufs.size(); i++){
+            bufs.at(i).copy_(saved_bufs.at(i));
+        }
+    }
+
+    // (3) Gradients of Input and Parameters
+    if (x.requires_grad()) inputs.push_back(x);
+    for (auto &param : params){
+        if (param.requires_grad()) inputs.push_back(param);
+    }
+    grads = torch::autograd::grad({out}, inputs, {grad_output.at(0)}, /*retain_graph=*/false, /*create_graph=*/false, /*allow_unused=*/true);
+
+    // (4) One Gradient for each Argument of forward : {seq, begin, x, params...}
+    j = 0;
+    grad_input = {torch::Tensor(), torch::Tensor()};
+    grad_input.push_back(x.requires_grad() ? grads.at(j++) : torch::Tensor());
+    for (auto &param : params){
+        grad_input.push_back(param.requires_grad() ? grads.at(j++) : torch::Tensor());
+    }
+
+    return grad_input;
+
+}
+
+
+// ----------------------------
+// function{run}
+// ----------------------------
+static torch::Tensor run(nn::SequentialImpl *seq, const size_t begin, torch::Tensor x){
+    for (auto it = seq->begin() + begin; it != seq->end(); ++it){
+        x = it->forward(x);
+    }
+    return x;
+}
+
+
+// ----------------------------
+// function{parameters}
+// ----------------------------
+static std::vector<torch::Tensor> parameters(nn::SequentialImpl *seq, const size_t begin){
+    std::vector<torch::Tensor> out;
+    for (auto it = seq->begin() + begin; it != seq->end(); ++it){
+        for (auto &param : it->ptr()->parameters()){
+            out.push_back(param);
+        }
+    }
+    return out;
+}
+
+
+// ----------------------------
+// function{buffers}
+// ----------------------------
+static std::vector<torch::Tensor> buffers(nn::SequentialImpl *seq, const size_t begin){
+    std::vector<torch::Tensor> out;
+    for (auto it = seq->begin() + begin; it != seq->end(); ++it){
+        for (auto &buf : it->ptr()->buffers()){
+            out.push_back(buf);
+        }
+    }
+    return out;
+}
@@ -0,0 +1,31 @@
+#ifndef CHECKPOINTING_HPP
+#define CHECKPOINTING_HPP
+
+#include <string>
+#include <vector>
+// For External Library
+#include <torch/torch.h>
+
+
+// -----------------------
+// namespace{checkpointing}
+// -----------------------
+namespace checkpointing{
+
+    // Function Prototype
+    std::vector<bool> parse_depths(const std::string depths, const size_t num);
+    torch::Tensor forward(torch::nn::Sequential &seq, torch::Tensor x, const size_t begin=0);
+
+    // ------------------------------------------------------------------------------
+    // namespace{checkpointing} -> struct{CheckpointFunction}(autograd::Function)
+    // ------------------------------------------------------------------------------
+    // The modules [begin, end) of the Sequential are run without keeping their activations, and are run again in the backward pass.
+    struct CheckpointFunction : public torch::autograd::Function<CheckpointFunction>{
+        static torch::Tensor forward(torch::autograd::AutogradContext *ctx, torch::nn::SequentialImpl *seq, const int64_t begin, torch::Tensor x, torch::TensorList params);
+        static torch::autograd::variable_list backward(torch::autograd::AutogradContext *ctx, torch::autograd::variable_list grad_output);
+    };
+
+}
+
+
+#endif
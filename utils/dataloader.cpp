@@ -333,7 +333,8 @@ bool DataLoader::ImageFolderSegmentWithPaths::operator()(std::tuple<torch::Tenso
     size_t index_start = this->batch_size * this->count;
     size_t index_end = std::min(this->size, (index_start + this->batch_size));
     size_t mini_batch_size = index_end - index_start;
-    torch::Tensor data1, data2, tensor1, tensor2;
+    torch::Tensor data1, data2;
+    std::vector<torch::Tensor> tensor1, tensor2;
     std::vector<std::string> data3, data4;
     std::vector<std::tuple<unsigned char, unsigned char, unsigned char>> data5;
     std::tuple<torch::Tensor, torch::Tensor, std::string, std::string, std::vector<std::tuple<unsigned char, unsigned char, unsigned char>>> group;
@@ -366,24 +367,16 @@ bool DataLoader::ImageFolderSegmentWithPaths::operator()(std::tuple<torch::Tenso
     }
 
     // (3) Organize Data
-    data1 = std::get<0>(data_before[0]);
-    data1 = torch::unsqueeze(data1, /*dim=*/0);
-    data2 = std::get<1>(data_before[0]);
-    data2 = torch::unsqueeze(data2, /*dim=*/0);
-    data3.push_back(std::get<2>(data_before[0]));
-    data4.push_back(std::get<3>(data_before[0]));
     data5 = std::get<4>(data_before[0]);
-    for (i = 1; i < mini_batch_size; i++){
+    for (i = 0; i < mini_batch_size; i++){
         group = data_before[i];
-        tensor1 = std::get<0>(group);
-        tensor1 = torch::unsqueeze(tensor1, /*dim=*/0);  // {C,H,W} ===> {1,C,H,W}
-        data1 = torch::cat({data1, tensor1}, /*dim=*/0);  // {i,C,H,W} + {1,C,H,W} ===> {i+1,C,H,W}
-        tensor2 = std::get<1>(group);
-        tensor2 = torch::unsqueeze(tensor2, /*dim=*/0);  // {H,W} ===> {1,H,W}
-        data2 = torch::cat({data2, tensor2}, /*dim=*/0);  // {i,H,W} + {1,H,W} ===> {i+1,H,W}
+        tensor1.push_back(std::get<0>(group));  // {C,H,W}
+        tensor2.push_back(std::get<1>(group));  // {H,W} (uint8 or int32)
         data3.push_back(std::get<2>(group));
         data4.push_back(std::get<3>(group));
     }
+    data1 = torch::stack(tensor1, /*dim=*/0);  // {C,H,W} * N ===> {N,C,H,W}
+    data2 = torch::stack(tensor2, /*dim=*/0).to(torch::kLong);  // {H,W} * N ===> {N,H,W} (widened once per mini batch)
 
     // Post Processing
     this->count++;
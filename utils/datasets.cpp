@@ -1,8 +1,12 @@
+#include <iostream>
 #include <string>
 #include <sstream>
 #include <tuple>
 #include <vector>
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <csetjmp>
 // For External Library
 #include <torch/torch.h>
 #include <opencv2/opencv.hpp>
@@ -32,22 +36,58 @@ cv::Mat datasets::RGB_Loader(std::string &path){
 // -----------------------------------------------
 cv::Mat datasets::Index_Loader(std::string &path){
 
-    size_t i, j;    
-    size_t width, height;
+    size_t j;
+    png_uint_32 width, height;
+    int bit_depth, color_type;
+    FILE *fp;
+    png_structp png_ptr;
+    png_infop info_ptr;
     cv::Mat Index;
+    std::vector<png_bytep> rows;
 
-    png::image<png::index_pixel> Index_png(path);  // path ===> index image
+    // (1) Open Index Image
+    fp = std::fopen(path.c_str(), "rb");
+    if (fp == nullptr){
+        std::cerr << "Error : Couldn't open the index image '" << path << "'." << std::endl;
+        std::exit(1);
+    }
+    png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    info_ptr = png_create_info_struct(png_ptr);
+    if (setjmp(png_jmpbuf(png_ptr))){
+        std::cerr << "Error : Couldn't decode the index image '" << path << "'." << std::endl;
+        std::exit(1);
+    }
+    png_init_io(png_ptr, fp);
+    png_read_info(png_ptr, info_ptr);
+
+    // (2) Decode Settings : {1,2,4,8} bits ===> 8 bits (uint8), 16 bits ===> 16 bits (uint16, for more than 256 classes)
+    png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
+    if ((color_type != PNG_COLOR_TYPE_PALETTE) && (color_type != PNG_COLOR_TYPE_GRAY)){
+        std::cerr << "Error : The label image '" << path << "' is not an index (palette or grayscale) image." << std::endl;
+        std::exit(1);
+    }
+    if (bit_depth < 8) png_set_packing(png_ptr);
+    if (bit_depth == 16){
+        const unsigned short probe = 1;
+        if (*(const unsigned char*)&probe == 1) png_set_swap(png_ptr);  // PNG stores 16 bits in big endian
+    }
+    png_set_interlace_handling(png_ptr);
+    png_read_update_info(png_ptr, info_ptr);
 
-    width = Index_png.get_width();
-    height = Index_png.get_height();
-    Index = cv::Mat(cv::Size(width, height), CV_32SC1);
+    // (3) Row-wise Decode into Index Image
+    Index = cv::Mat(cv::Size(width, height), (bit_depth == 16) ? CV_16UC1 : CV_8UC1);
+    rows = std::vector<png_bytep>(height);
     for (j = 0; j < height; j++){
-        for (i = 0; i < width; i++){
-            Index.at<int>(j, i) = (int)Index_png[j][i];
-        }
+        rows.at(j) = Index.ptr<unsigned char>(j);
     }
+    png_read_image(png_ptr, rows.data());  // path ===> index image {H,W} (uint8 or uint16)
+    png_read_end(png_ptr, nullptr);
+
+    // (4) Close Index Image
+    png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+    std::fclose(fp);
 
-    return Index.clone();
+    return Index;
 
 }
 
@@ -0,0 +1,397 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "evaluation.hpp"
+
+
+// ---------------------------------------------------------
+// namespace{evaluation} -> class{EachLoss} -> constructor
+// ---------------------------------------------------------
+evaluation::EachLoss::EachLoss(const std::string loss){
+    if (loss == "l1"){
+        this->judge = 0;
+    }
+    else if (loss == "l2"){
+        this->judge = 1;
+    }
+    else if (loss == "ssim"){
+        this->judge = 2;
+    }
+    else if (loss == "nll"){
+        this->judge = 3;
+    }
+    else{
+        std::cerr << "Error : The loss fuction isn't defined right." << std::endl;
+        std::exit(1);
+    }
+}
+
+
+// -------------------------------------------------------------
+// namespace{evaluation} -> class{EachLoss} -> function{each}
+// -------------------------------------------------------------
+torch::Tensor evaluation::EachLoss::each(torch::Tensor &input, torch::Tensor &target){
+    long int mini_batch_size = input.size(0);
+    if (this->judge == 0){
+        return (input - target).abs().view({mini_batch_size, -1}).mean(/*dim=*/1);  // {N,C,H,W} ===> {N}
+    }
+    else if (this->judge == 1){
+        return (input - target).pow(2.0).view({mini_batch_size, -1}).mean(/*dim=*/1);  // {N,C,H,W} ===> {N}
+    }
+    else if (this->judge == 2){
+        return this->ssim.each(input, target);  // {N,C,H,W} ===> {N}
+    }
+    torch::Tensor loss = torch::nn::functional::nll_loss(input, target, torch::nn::functional::NLLLossFuncOptions().ignore_index(-100).reduction(torch::kNone)).view({mini_batch_size, -1});  // {N,K,...}, {N,...} ===> {N,M}
+    torch::Tensor count = (target != -100).view({mini_batch_size, -1}).sum(/*dim=*/1);  // {N,...} ===> {N}
+    return loss.sum(/*dim=*/1) / count;  // {N,M} ===> {N}  (Note: NaN for samples whose labels are all ignored, as the mean reduction.)
+}
+
+
+// -------------------------------------------------------
+// namespace{evaluation} -> class{Runner} -> constructor
+// -------------------------------------------------------
+evaluation::Runner::Runner(){
+    this->count = 0;
+    this->seconds = 0.0;
+}
+
+
+// -------------------------------------------------------------
+// namespace{evaluation} -> class{Runner} -> function{start_timer}
+// -------------------------------------------------------------
+void evaluation::Runner::start_timer(){
+    this->start = std::chrono::system_clock::now();
+}
+
+
+// -------------------------------------------------------------
+// namespace{evaluation} -> class{Runner} -> function{stop_timer}
+// -------------------------------------------------------------
+void evaluation::Runner::stop_timer(){
+    this->end = std::chrono::system_clock::now();
+    this->seconds += (double)std::chrono::duration_cast<std::chrono::microseconds>(this->end - this->start).count() * 0.001 * 0.001;
+}
+
+
+// -------------------------------------------------------
+// namespace{evaluation} -> class{Runner} -> function{push}
+// -------------------------------------------------------
+std::vector<std::vector<float>> evaluation::Runner::push(const std::vector<torch::Tensor> values){
+
+    // (0) Initialization and Declaration
+    long int i, j;
+    long int mini_batch_size, cols;
+    std::vector<torch::Tensor> columns;
+    std::vector<std::vector<float>> rows;
+    torch::Tensor table, table_cpu;
+
+    // (1) Arrange Values into Table on Device
+    for (auto &value : values){
+        torch::Tensor column = value.detach().to(torch::kFloat);
+        column = column.view({column.size(0), -1});  // {N} or {N,K} ===> {N,K'}
+        columns.push_back(column);
+    }
+    table = torch::cat(columns, /*dim=*/1);  // {N,K1} + {N,K2} + ... ===> {N,M}
+    mini_batch_size = table.size(0);
+    cols = table.size(1);
+
+    // (2) Accumulate Total on Device
+    if (this->total.defined()){
+        this->total = this->total + table.to(torch::kDouble).sum(/*dim=*/0);
+    }
+    else{
+        this->total = table.to(torch::kDouble).sum(/*dim=*/0);  // {N,M} ===> {M}
+    }
+    this->count += mini_batch_size;
+
+    // (3) Synchronize with Host only Once
+    table_cpu = table.to(torch::kCPU).contiguous();
+    auto table_a = table_cpu.accessor<float, 2>();
+    rows = std::vector<std::vector<float>>(mini_batch_size, std::vector<float>(cols));
+    for (i = 0; i < mini_batch_size; i++){
+        for (j = 0; j < cols; j++){
+            rows.at(i).at(j) = table_a[i][j];
+        }
+    }
+
+    // End Processing
+    return rows;
+
+}
+
+
+// ----------------------------------------------------------
+// namespace{evaluation} -> class{Runner} -> function{get_ave}
+// ----------------------------------------------------------
+std::vector<double> evaluation::Runner::get_ave(){
+    std::vector<double> ave;
+    if (!this->total.defined()){
+        return ave;
+    }
+    torch::Tensor total_cpu = (this->total / (double)this->count).to(torch::kCPU);
+    for (long int i = 0; i < total_cpu.size(0); i++){
+        ave.push_back(total_cpu[i].item<double>());
+    }
+    return ave;
+}
+
+
+// ---------------------------------------------------------------
+// namespace{evaluation} -> class{Runner} -> function{get_ave_time}
+// ---------------------------------------------------------------
+double evaluation::Runner::get_ave_time(){
+    return this->seconds / (double)this->count;
+}
+
+
+// -------------------------------------------------------
+// namespace{evaluation} -> class{Runner} -> function{size}
+// -------------------------------------------------------
+size_t evaluation::Runner::size(){
+    return this->count;
+}
+
+
+// ----------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> constructor
+// ----------------------------------------------------------------
+evaluation::ConfusionMatrix::ConfusionMatrix(const size_t class_num_, const size_t k_){
+    this->class_num = class_num_;
+    this->k = std::min((long int)k_, this->class_num);  // (Note: Top-k matching is skipped when k = 0.)
+    this->reset();
+}
+
+
+// ---------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{reset}
+// ---------------------------------------------------------------------
+void evaluation::ConfusionMatrix::reset(){
+    this->matrix = torch::zeros({this->class_num, this->class_num}, torch::TensorOptions().dtype(torch::kLong));
+    this->topk_match = torch::zeros({}, torch::TensorOptions().dtype(torch::kLong));
+}
+
+
+// ----------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{update}
+// ----------------------------------------------------------------------
+void evaluation::ConfusionMatrix::update(torch::Tensor output, torch::Tensor label){
+
+    torch::NoGradGuard no_grad;
+
+    // (1) Confusion Matrix
+    this->update_index(output.argmax(/*dim=*/1), label);  // {N,C,...} ===> {N,...}
+
+    // (2) Top-k Match
+    if (this->k == 0){
+        return;
+    }
+    torch::Tensor topk_response = std::get<1>(output.topk(this->k, /*dim=*/1));  // {N,C,...} ===> {N,k,...}
+    this->topk_match += (topk_response == label.to(torch::kLong).unsqueeze(1)).any(/*dim=*/1).sum();  // {N,k,...} ===> {}
+
+    return;
+
+}
+
+
+// -----------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{update_index}
+// -----------------------------------------------------------------------------
+// Accumulate class indices that are already decided (e.g. argmax votes of tiled inference).
+void evaluation::ConfusionMatrix::update_index(torch::Tensor response, torch::Tensor label){
+
+    torch::NoGradGuard no_grad;
+
+    // (1) Transfer Accumulators to Device of Response
+    if (this->matrix.device() != response.device()){
+        this->matrix = this->matrix.to(response.device());
+        this->topk_match = this->topk_match.to(response.device());
+    }
+
+    // (2) Confusion Matrix with a Single Bincount
+    torch::Tensor response_flat = response.to(torch::kLong).flatten();  // {N,...} ===> {N*...}
+    torch::Tensor answer = label.to(torch::kLong).flatten();  // {N,...} ===> {N*...}
+    torch::Tensor valid = (answer >= 0).logical_and(answer < this->class_num);  // {N*...}
+    torch::Tensor index = torch::where(valid, answer * this->class_num + response_flat, this->class_num * this->class_num);  // {N*...} (invalid labels go to the last bin, without a data-dependent size)
+    torch::Tensor counts = torch::bincount(index, /*weights=*/{}, /*minlength=*/this->class_num * this->class_num + 1);  // {N*...} ===> {C*C+1}
+    this->matrix += counts.narrow(/*dim=*/0, /*start=*/0, /*length=*/this->class_num * this->class_num).view({this->class_num, this->class_num});  // {C*C+1} ===> {C,C}
+
+    return;
+
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{get_matrix}
+// ---------------------------------------------------------------------------
+torch::Tensor evaluation::ConfusionMatrix::get_matrix(){
+    return this->matrix.to(torch::kCPU);
+}
+
+
+// -------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{accuracy}
+// -------------------------------------------------------------------------
+float evaluation::ConfusionMatrix::accuracy(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kDouble);
+    return (float)(matrix_cpu.trace() / matrix_cpu.sum().clamp_min(1.0)).item<double>();
+}
+
+
+// ------------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{topk_accuracy}
+// ------------------------------------------------------------------------------
+float evaluation::ConfusionMatrix::topk_accuracy(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kDouble);
+    return (float)(this->topk_match.to(torch::kCPU).to(torch::kDouble) / matrix_cpu.sum().clamp_min(1.0)).item<double>();
+}
+
+
+// -------------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{class_accuracy}
+// -------------------------------------------------------------------------------
+std::vector<float> evaluation::ConfusionMatrix::class_accuracy(){
+    return this->recall();
+}
+
+
+// --------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{precision}
+// --------------------------------------------------------------------------
+std::vector<float> evaluation::ConfusionMatrix::precision(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kFloat);
+    torch::Tensor out = matrix_cpu.diagonal() / matrix_cpu.sum(/*dim=*/0).clamp_min(1.0);  // {C,C} ===> {C}  (Note: 0 for classes that were never responded.)
+    return std::vector<float>(out.data_ptr<float>(), out.data_ptr<float>() + out.numel());
+}
+
+
+// -----------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{recall}
+// -----------------------------------------------------------------------
+std::vector<float> evaluation::ConfusionMatrix::recall(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kFloat);
+    torch::Tensor out = matrix_cpu.diagonal() / matrix_cpu.sum(/*dim=*/1).clamp_min(1.0);  // {C,C} ===> {C}  (Note: 0 for classes without samples.)
+    return std::vector<float>(out.data_ptr<float>(), out.data_ptr<float>() + out.numel());
+}
+
+
+// -------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{f1}
+// -------------------------------------------------------------------
+std::vector<float> evaluation::ConfusionMatrix::f1(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kFloat);
+    torch::Tensor tp = matrix_cpu.diagonal();  // {C,C} ===> {C}
+    torch::Tensor out = 2.0 * tp / (matrix_cpu.sum(/*dim=*/0) + matrix_cpu.sum(/*dim=*/1)).clamp_min(1.0);  // {C}
+    return std::vector<float>(out.data_ptr<float>(), out.data_ptr<float>() + out.numel());
+}
+
+
+// -------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{macro_f1}
+// -------------------------------------------------------------------------
+float evaluation::ConfusionMatrix::macro_f1(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kDouble);
+    torch::Tensor exist = (matrix_cpu.sum(/*dim=*/1) > 0);  // {C,C} ===> {C}
+    torch::Tensor out = 2.0 * matrix_cpu.diagonal() / (matrix_cpu.sum(/*dim=*/0) + matrix_cpu.sum(/*dim=*/1)).clamp_min(1.0);  // {C}
+    return (float)(torch::where(exist, out, torch::zeros_like(out)).sum() / exist.sum().clamp_min(1)).item<double>();
+}
+
+
+// ------------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{mean_accuracy}
+// ------------------------------------------------------------------------------
+float evaluation::ConfusionMatrix::mean_accuracy(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kDouble);
+    torch::Tensor total = matrix_cpu.sum(/*dim=*/1);  // {C,C} ===> {C}
+    torch::Tensor exist = (total > 0);  // {C}
+    torch::Tensor out = matrix_cpu.diagonal() / total.clamp_min(1.0);  // {C}
+    return (float)(torch::where(exist, out, torch::zeros_like(out)).sum() / exist.sum().clamp_min(1)).item<double>();
+}
+
+
+// --------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{iou}
+// --------------------------------------------------------------------
+std::vector<float> evaluation::ConfusionMatrix::iou(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kFloat);
+    torch::Tensor tp = matrix_cpu.diagonal();  // {C,C} ===> {C}
+    torch::Tensor out = tp / (matrix_cpu.sum(/*dim=*/0) + matrix_cpu.sum(/*dim=*/1) - tp).clamp_min(1.0);  // {C}  (Note: 0 for classes that neither appear nor are responded.)
+    return std::vector<float>(out.data_ptr<float>(), out.data_ptr<float>() + out.numel());
+}
+
+
+// -------------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{mean_iou}
+// -------------------------------------------------------------------------
+float evaluation::ConfusionMatrix::mean_iou(){
+    torch::Tensor matrix_cpu = this->get_matrix().to(torch::kDouble);
+    torch::Tensor tp = matrix_cpu.diagonal();  // {C,C} ===> {C}
+    torch::Tensor uni = matrix_cpu.sum(/*dim=*/0) + matrix_cpu.sum(/*dim=*/1) - tp;  // {C}
+    torch::Tensor exist = (uni > 0);  // {C}
+    torch::Tensor out = tp / uni.clamp_min(1.0);  // {C}
+    return (float)(torch::where(exist, out, torch::zeros_like(out)).sum() / exist.sum().clamp_min(1)).item<double>();
+}
+
+
+// ----------------------------------------------------------------------
+// namespace{evaluation} -> class{ConfusionMatrix} -> function{get_k}
+// ----------------------------------------------------------------------
+size_t evaluation::ConfusionMatrix::get_k(){
+    return (size_t)this->k;
+}
+
+
+// ----------------------------------------------------------------
+// namespace{evaluation} -> class{BufferedWriter} -> constructor
+// ----------------------------------------------------------------
+evaluation::BufferedWriter::BufferedWriter(const std::string path, const size_t capacity_){
+    this->open(path, capacity_);
+}
+
+
+// ------------------------------------------------------------------
+// namespace{evaluation} -> class{BufferedWriter} -> function{open}
+// ------------------------------------------------------------------
+void evaluation::BufferedWriter::open(const std::string path, const size_t capacity_){
+    this->capacity = capacity_;
+    this->buffer.str(""); this->buffer.clear(std::ostringstream::goodbit);
+    this->ofs.open(path, std::ios::out);
+}
+
+
+// -------------------------------------------------------------------
+// namespace{evaluation} -> class{BufferedWriter} -> function{flush}
+// -------------------------------------------------------------------
+void evaluation::BufferedWriter::flush(){
+    if (this->ofs.is_open()){
+        this->ofs << this->buffer.str();
+        this->ofs.flush();
+    }
+    this->buffer.str(""); this->buffer.clear(std::ostringstream::goodbit);
+}
+
+
+// -------------------------------------------------------------------
+// namespace{evaluation} -> class{BufferedWriter} -> function{close}
+// -------------------------------------------------------------------
+void evaluation::BufferedWriter::close(){
+    if (this->ofs.is_open()){
+        this->flush();
+        this->ofs.close();
+    }
+}
+
+
+// ---------------------------------------------------------------
+// namespace{evaluation} -> class{BufferedWriter} -> destructor
+// ---------------------------------------------------------------
+evaluation::BufferedWriter::~BufferedWriter(){
+    this->close();
+}
@@ -0,0 +1,146 @@
+#ifndef EVALUATION_HPP
+#define EVALUATION_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <utility>
+#include <type_traits>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "losses.hpp"
+
+
+// -----------------------
+// namespace{evaluation}
+// -----------------------
+namespace evaluation{
+
+    // Function Prototype
+    template <typename Criterion> torch::Tensor each(Criterion &criterion, torch::Tensor input, torch::Tensor target);
+
+    // Whether the criterion has "torch::Tensor each(torch::Tensor&, torch::Tensor&)" for the loss of every sample
+    template <typename Criterion, typename = void> struct has_each : std::false_type{};
+    template <typename Criterion> struct has_each<Criterion, std::void_t<decltype(std::declval<Criterion&>().each(std::declval<torch::Tensor&>(), std::declval<torch::Tensor&>()))>> : std::true_type{};
+
+    // -------------------------------------------
+    // namespace{evaluation} -> class{EachLoss}
+    // -------------------------------------------
+    // The mean-reduced losses of the models for every sample {N} in one call : "l1", "l2", "ssim" and "nll" (ignoring the label -100)
+    class EachLoss{
+    private:
+        int judge;
+        Losses::SSIMLoss ssim;
+    public:
+        EachLoss(){}
+        EachLoss(const std::string loss);
+        torch::Tensor each(torch::Tensor &input, torch::Tensor &target);
+    };
+
+    // -------------------------------------------
+    // namespace{evaluation} -> class{Runner}
+    // -------------------------------------------
+    class Runner{
+    private:
+        size_t count;
+        double seconds;
+        torch::Tensor total;
+        std::chrono::system_clock::time_point start, end;
+    public:
+        Runner();
+        void start_timer();
+        void stop_timer();
+        std::vector<std::vector<float>> push(const std::vector<torch::Tensor> values);
+        std::vector<double> get_ave();
+        double get_ave_time();
+        size_t size();
+    };
+
+    // --------------------------------------------------
+    // namespace{evaluation} -> class{ConfusionMatrix}
+    // --------------------------------------------------
+    class ConfusionMatrix{
+    private:
+        long int class_num, k;
+        torch::Tensor matrix;      // {C,C} (row: answer, column: response)
+        torch::Tensor topk_match;  // {}
+    public:
+        ConfusionMatrix(){}
+        ConfusionMatrix(const size_t class_num_, const size_t k_=5);
+        void reset();
+        void update(torch::Tensor output, torch::Tensor label);
+        void update_index(torch::Tensor response, torch::Tensor label);
+        torch::Tensor get_matrix();
+        float accuracy();
+        float topk_accuracy();
+        std::vector<float> class_accuracy();
+        std::vector<float> precision();
+        std::vector<float> recall();
+        std::vector<float> f1();
+        float macro_f1();
+        float mean_accuracy();
+        std::vector<float> iou();
+        float mean_iou();
+        size_t get_k();
+    };
+
+    // -------------------------------------------------
+    // namespace{evaluation} -> class{BufferedWriter}
+    // -------------------------------------------------
+    class BufferedWriter{
+    private:
+        size_t capacity;
+        std::ofstream ofs;
+        std::ostringstream buffer;
+    public:
+        BufferedWriter(){}
+        BufferedWriter(const std::string path, const size_t capacity_=1048576);
+        void open(const std::string path, const size_t capacity_=1048576);
+        template <typename T> BufferedWriter &operator<<(const T &value);
+        void flush();
+        void close();
+        ~BufferedWriter();
+    };
+
+}
+
+
+// ----------------------------------------------------------------------------
+// namespace{evaluation} -> function{each}
+// ----------------------------------------------------------------------------
+// Apply a mean-reduced criterion to every sample of the mini batch without host synchronization.
+// A criterion with "each(input, target)" gives all the samples {N} in one call, and the others are called once per sample.
+template <typename Criterion>
+torch::Tensor evaluation::each(Criterion &criterion, torch::Tensor input, torch::Tensor target){
+    if constexpr (evaluation::has_each<Criterion>::value){
+        return criterion.each(input, target);  // {N,...} ===> {N}
+    }
+    else{
+        std::vector<torch::Tensor> out;
+        for (long int i = 0; i < input.size(0); i++){
+            torch::Tensor input_one = input.narrow(/*dim=*/0, i, 1);    // {N,...} ===> {1,...}
+            torch::Tensor target_one = target.narrow(/*dim=*/0, i, 1);  // {N,...} ===> {1,...}
+            out.push_back(criterion(input_one, target_one));
+        }
+        return torch::stack(out, /*dim=*/0);  // {} * N ===> {N}
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// namespace{evaluation} -> class{BufferedWriter} -> operator
+// ----------------------------------------------------------------------------
+template <typename T>
+evaluation::BufferedWriter &evaluation::BufferedWriter::operator<<(const T &value){
+    this->buffer << value;
+    if ((size_t)this->buffer.tellp() >= this->capacity){
+        this->flush();
+    }
+    return *this;
+}
+
+
+#endif
@@ -0,0 +1,125 @@
+#include <string>
+#include <memory>
+#include <utility>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "fusion.hpp"
+
+// Define Namespace
+namespace nn = torch::nn;
+
+
+// ---------------------------------------------
+// namespace{fusion} -> function{replace}
+// ---------------------------------------------
+// Replace both the forward slot and the registered child of the Sequential, so that saved parameters follow the new module.
+template <typename T>
+static void replace(nn::Sequential &seq, const size_t index, T module){
+    *(seq->begin() + index) = nn::AnyModule(module);
+    seq->replace_module(std::to_string(index), module);
+    return;
+}
+
+
+// ----------------------------------------------------
+// namespace{fusion} -> function{fold_batchnorm}
+// ----------------------------------------------------
+// Fold every "Conv2d/ConvTranspose2d -> BatchNorm2d" pair in the Sequentials of the model into a single convolution.
+// The folded model is for inference only, because the running statistics of BatchNorm are fixed into the convolution.
+size_t fusion::fold_batchnorm(std::shared_ptr<nn::Module> model){
+
+    torch::NoGradGuard no_grad;
+
+    size_t i;
+    size_t folded = 0;
+
+    for (auto &module : model->modules(/*include_self=*/true)){
+        auto seq_ptr = std::dynamic_pointer_cast<nn::SequentialImpl>(module);
+        if (!seq_ptr) continue;
+        nn::Sequential seq(seq_ptr);
+        for (i = 0; i + 1 < seq->size(); i++){
+            auto bn_ptr = std::dynamic_pointer_cast<nn::BatchNorm2dImpl>(seq->ptr(i + 1));
+            if (!bn_ptr) continue;
+            nn::BatchNorm2d bn(bn_ptr);
+            if (auto conv_ptr = std::dynamic_pointer_cast<nn::Conv2dImpl>(seq->ptr(i))){
+                nn::Conv2d conv(conv_ptr);
+                replace(seq, i, fusion::fold_conv(conv, bn));
+            }
+            else if (auto conv_ptr = std::dynamic_pointer_cast<nn::ConvTranspose2dImpl>(seq->ptr(i))){
+                nn::ConvTranspose2d conv(conv_ptr);
+                replace(seq, i, fusion::fold_conv(conv, bn));
+            }
+            else{
+                continue;
+            }
+            replace(seq, i + 1, nn::Identity());
+            folded++;
+        }
+    }
+
+    return folded;
+
+}
+
+
+// ------------------------------------------------------
+// namespace{fusion} -> function{batchnorm_affine}
+// ------------------------------------------------------
+// BN(x) = gamma * (x - mean) / sqrt(var + eps) + beta = scale * x + shift
+std::pair<torch::Tensor, torch::Tensor> fusion::batchnorm_affine(nn::BatchNorm2d &bn){
+    torch::Tensor gamma = bn->options.affine() ? bn->weight : torch::ones_like(bn->running_mean);
+    torch::Tensor beta = bn->options.affine() ? bn->bias : torch::zeros_like(bn->running_mean);
+    torch::Tensor scale = gamma / torch::sqrt(bn->running_var + bn->options.eps());  // {C}
+    torch::Tensor shift = beta - bn->running_mean * scale;  // {C}
+    return {scale, shift};
+}
+
+
+// ----------------------------------------------------------
+// namespace{fusion} -> function{fold_conv}(Conv2d)
+// ----------------------------------------------------------
+nn::Conv2d fusion::fold_conv(nn::Conv2d &conv, nn::BatchNorm2d &bn){
+
+    torch::NoGradGuard no_grad;
+
+    // (1) Convolution with Bias
+    auto &o = conv->options;
+    nn::Conv2d out(nn::Conv2dOptions(o.in_channels(), o.out_channels(), o.kernel_size()).stride(o.stride()).padding(o.padding()).dilation(o.dilation()).groups(o.groups()).bias(true).padding_mode(o.padding_mode()));
+    out->to(conv->weight.device(), conv->weight.scalar_type());
+
+    // (2) Folding : W' = W * scale, b' = b * scale + shift
+    auto [scale, shift] = fusion::batchnorm_affine(bn);
+    torch::Tensor bias = conv->bias.defined() ? conv->bias : torch::zeros_like(shift);
+    out->weight.copy_(conv->weight * scale.view({-1, 1, 1, 1}));  // {OC,IC/G,KH,KW} * {OC,1,1,1}
+    out->bias.copy_(bias * scale + shift);  // {OC}
+
+    return out;
+
+}
+
+
+// ----------------------------------------------------------------
+// namespace{fusion} -> function{fold_conv}(ConvTranspose2d)
+// ----------------------------------------------------------------
+nn::ConvTranspose2d fusion::fold_conv(nn::ConvTranspose2d &conv, nn::BatchNorm2d &bn){
+
+    torch::NoGradGuard no_grad;
+
+    // (1) Transposed Convolution with Bias
+    auto &o = conv->options;
+    nn::ConvTranspose2d out(nn::ConvTranspose2dOptions(o.in_channels(), o.out_channels(), o.kernel_size()).stride(o.stride()).padding(o.padding()).output_padding(o.output_padding()).dilation(o.dilation()).groups(o.groups()).bias(true).padding_mode(o.padding_mode()));
+    out->to(conv->weight.device(), conv->weight.scalar_type());
+
+    // (2) Folding : W' = W * scale, b' = b * scale + shift (output channels are the second axis of the weight in each group)
+    auto [scale, shift] = fusion::batchnorm_affine(bn);
+    torch::Tensor bias = conv->bias.defined() ? conv->bias : torch::zeros_like(shift);
+    long int G = o.groups();
+    torch::Tensor weight = conv->weight.view({G, conv->weight.size(0) / G, conv->weight.size(1), conv->weight.size(2), conv->weight.size(3)});  // {IC,OC/G,KH,KW} ===> {G,IC/G,OC/G,KH,KW}
+    weight = weight * scale.view({G, 1, -1, 1, 1});  // {G,IC/G,OC/G,KH,KW} * {G,1,OC/G,1,1}
+    out->weight.copy_(weight.view_as(conv->weight));  // {IC,OC/G,KH,KW}
+    out->bias.copy_(bias * scale + shift);  // {OC}
+
+    return out;
+
+}
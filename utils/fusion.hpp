@@ -0,0 +1,56 @@
+#ifndef FUSION_HPP
+#define FUSION_HPP
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <utility>
+#include <filesystem>
+// For External Library
+#include <torch/torch.h>
+
+
+// -------------------
+// namespace{fusion}
+// -------------------
+namespace fusion{
+
+    // Function Prototype
+    size_t fold_batchnorm(std::shared_ptr<torch::nn::Module> model);
+    std::pair<torch::Tensor, torch::Tensor> batchnorm_affine(torch::nn::BatchNorm2d &bn);
+    torch::nn::Conv2d fold_conv(torch::nn::Conv2d &conv, torch::nn::BatchNorm2d &bn);
+    torch::nn::ConvTranspose2d fold_conv(torch::nn::ConvTranspose2d &conv, torch::nn::BatchNorm2d &bn);
+    template <typename Model> void load_folded(Model &model, const std::string path);
+
+}
+
+
+// ----------------------------------------------------------------------------
+// namespace{fusion} -> function{load_folded}
+// ----------------------------------------------------------------------------
+// Load a checkpoint into the model with BatchNorm folded, and export the folded checkpoint "<path>_folded.pth" for the next time.
+template <typename Model>
+void fusion::load_folded(Model &model, const std::string path){
+
+    size_t folded;
+    std::string path_folded = path.substr(0, path.rfind(".pth")) + "_folded.pth";
+
+    // (1) Exported Checkpoint is Newer than Original
+    if (std::filesystem::exists(path_folded) && (std::filesystem::last_write_time(path_folded) >= std::filesystem::last_write_time(path))){
+        folded = fusion::fold_batchnorm(model.ptr());  // the structure of the folded model is required to load the checkpoint
+        torch::load(model, path_folded);
+    }
+    // (2) Fold and Export
+    else{
+        torch::load(model, path);
+        folded = fusion::fold_batchnorm(model.ptr());
+        torch::save(model, path_folded);
+    }
+    std::cout << "folded BatchNorm layers : " << folded << " (" << path_folded << ')' << std::endl;
+
+    return;
+
+}
+
+
+#endif
@@ -1,6 +1,11 @@
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <algorithm>
 #include <cmath>
 // For External Library
 #include <torch/torch.h>
+#include <omp.h>
 // For Original Header
 #include "losses.hpp"
 
@@ -11,48 +16,56 @@ namespace F = torch::nn::functional;
 // ----------------------------------------------------
 // namespace{Losses} -> class{SSIMLoss} -> constructor
 // ----------------------------------------------------
-Losses::SSIMLoss::SSIMLoss(const size_t nc_, const torch::Device device, const size_t window_size_, const float gauss_std_, const float c1_base_, const float c2_base_){
+Losses::SSIMLoss::SSIMLoss(const size_t window_size_, const float gauss_std_, const float c1_base_, const float c2_base_, const bool fused_cpu_){
 
-    this->nc = nc_;
     this->window_size = window_size_;
     this->gauss_std = gauss_std_;
     this->c1_base = c1_base_;
     this->c2_base = c2_base_;
+    this->fused_cpu = fused_cpu_;
 
-    float *gauss_list = new float[this->window_size];
+    std::vector<float> gauss_list(this->window_size);
     auto Gaussian_PDF = [](float mean, float std, float x){ return (float)std::exp(- (x - mean) * (x - mean) / (2.0 * std * std)); };
     for (size_t i = 0; i < this->window_size; i++){
         gauss_list[i] = Gaussian_PDF(this->window_size/2, this->gauss_std, (float)i);
     }
 
     torch::Tensor tensor;
-    tensor = torch::from_blob(gauss_list, {(long int)this->window_size}, torch::kFloat);  // Array {W} ===> Tensor {W}
-    tensor = tensor / tensor.sum();                                                       // No Normalize {W} ===> Normalize {W}
-    tensor = tensor.unsqueeze(/*dim=*/1);                                                 // {W} ===> {W,1}
-    tensor = tensor.mm(tensor.t());                                                       // {W,1} * {1,W} ===> {W,W}
-    tensor = tensor.unsqueeze(/*dim=*/0).unsqueeze(/*dim=*/0);                            // {W,W} ===> {1,1,W,W}
-    tensor = tensor.expand({(long int)this->nc, 1, (long int)this->window_size, (long int)this->window_size}).contiguous();  // {1,1,W,W} ===> {C,1,W,W}
+    tensor = torch::from_blob(gauss_list.data(), {(long int)this->window_size}, torch::kFloat);  // Array {W} ===> Tensor {W}
+    tensor = tensor / tensor.sum();                                                              // No Normalize {W} ===> Normalize {W}
 
     // -------------------------------------------------------------------------------------
     // (Default) if window size is 11 and gauss_std is 1.5, ...
     // 
-    //          | 1.0576 7.8144 37.022 112.46 219.05 273.56 219.05 112.46 37.022 7.8144 1.0576 |
-    //          | 7.8144 57.741 273.56 831.01 1618.6 2021.4 1618.6 831.01 273.56 57.741 7.8144 |
-    //          | 37.022 273.56 1296.1 3937.1 7668.4 9576.6 7668.4 3937.1 1296.1 273.56 37.022 |
-    //          | 112.46 831.01 3937.1 11960. 23294. 29091. 23294. 11960. 3937.1 831.01 112.46 |
-    //          | 219.05 1618.6 7668.4 23294. 45371. 56662. 45371. 23294. 7668.4 1618.6 219.05 |
-    // window = | 273.56 2021.4 9576.6 29091. 56662. 70762. 56662. 29091. 9576.6 2021.4 273.56 | * 0.000001
-    //          | 219.05 1618.6 7668.4 23294. 45371. 56662. 45371. 23294. 7668.4 1618.6 219.05 |
-    //          | 112.46 831.01 3937.1 11960. 23294. 29091. 23294. 11960. 3937.1 831.01 112.46 |
-    //          | 37.022 273.56 1296.1 3937.1 7668.4 9576.6 7668.4 3937.1 1296.1 273.56 37.022 |
-    //          | 7.8144 57.741 273.56 831.01 1618.6 2021.4 1618.6 831.01 273.56 57.741 7.8144 |
-    //          | 1.0576 7.8144 37.022 112.46 219.05 273.56 219.05 112.46 37.022 7.8144 1.0576 |
+    //   gauss = | 1.0284 7.5988 36.000 109.36 213.00 266.01 213.00 109.36 36.000 7.5988 1.0284 | * 0.001
     // 
+    // The 2-D window {W,W} is the outer product gauss * gauss^T,
+    // so the filtering is applied as a horizontal pass {1,W} followed by a vertical pass {W,1}.
     // -------------------------------------------------------------------------------------
 
-    this->window = tensor.to(device).detach().clone();
+    this->gauss = tensor.detach().clone();
 
-    delete[] gauss_list;
+}
+
+
+// -------------------------------------------------------------
+// namespace{Losses} -> class{SSIMLoss} -> function{get_window}
+// -------------------------------------------------------------
+std::pair<torch::Tensor, torch::Tensor> &Losses::SSIMLoss::get_window(const size_t nc, const torch::Device device, const torch::ScalarType dtype){
+
+    auto key = std::make_tuple(nc, device.str(), (int)dtype);
+    auto it = this->windows.find(key);
+    if (it != this->windows.end()){
+        return it->second;
+    }
+
+    // Five statistics (x, y, x^2, y^2, xy) of every channel are filtered in one grouped convolution
+    long int groups = 5 * nc;
+    torch::Tensor window = this->gauss.to(device, dtype);  // {W}
+    torch::Tensor window_h = window.view({1, 1, 1, (long int)this->window_size}).expand({groups, 1, 1, (long int)this->window_size}).contiguous();  // {W} ===> {5C,1,1,W}
+    torch::Tensor window_v = window.view({1, 1, (long int)this->window_size, 1}).expand({groups, 1, (long int)this->window_size, 1}).contiguous();  // {W} ===> {5C,1,W,1}
+
+    return this->windows.emplace(key, std::make_pair(window_h, window_v)).first->second;
 
 }
 
@@ -60,33 +73,174 @@ Losses::SSIMLoss::SSIMLoss(const size_t nc_, const torch::Device device, const s
 // -------------------------------------------------------------------------
 // namespace{Losses} -> class{SSIMLoss} -> function{Structural_Similarity}
 // -------------------------------------------------------------------------
-torch::Tensor Losses::SSIMLoss::Structural_Similarity(torch::Tensor &image1, torch::Tensor &image2){
+// The mean SSIM of the mini batch {}, or of every sample {N} with "each"
+torch::Tensor Losses::SSIMLoss::Structural_Similarity(torch::Tensor &image1, torch::Tensor &image2, const bool each){
 
-    // (1) Calculation of Mean
-    torch::Tensor mu1 = F::conv2d(image1, this->window, F::Conv2dFuncOptions().padding(this->window_size/2).groups(this->nc));
-    torch::Tensor mu2 = F::conv2d(image2, this->window, F::Conv2dFuncOptions().padding(this->window_size/2).groups(this->nc));
+    // (0) Fused Kernel for CPU Inference
+    bool need_grad = torch::GradMode::is_enabled() && (image1.requires_grad() || image2.requires_grad());
+    if (this->fused_cpu && !need_grad && image1.device().is_cpu() && (image1.scalar_type() == torch::kFloat) && (image2.scalar_type() == torch::kFloat)){
+        return this->Structural_Similarity_CPU(image1, image2, each);
+    }
+
+    // (1) Separable Filtering of Statistics
+    long int nc = image1.size(1);
+    long int pad = this->window_size / 2;
+    std::pair<torch::Tensor, torch::Tensor> &window = this->get_window(nc, image1.device(), image1.scalar_type());
+    torch::Tensor stats = torch::cat({image1, image2, image1 * image1, image2 * image2, image1 * image2}, /*dim=*/1);  // {C,H,W} * 5 ===> {5C,H,W}
+    stats = F::conv2d(stats, window.first, F::Conv2dFuncOptions().padding({0, pad}).groups(5 * nc));   // {5C,H,W} ===> {5C,H,W} (horizontal)
+    stats = F::conv2d(stats, window.second, F::Conv2dFuncOptions().padding({pad, 0}).groups(5 * nc));  // {5C,H,W} ===> {5C,H,W} (vertical)
+    std::vector<torch::Tensor> moments = stats.chunk(5, /*dim=*/1);  // {5C,H,W} ===> {C,H,W} * 5
+
+    // (2) Calculation of Mean
+    torch::Tensor mu1 = moments[0];
+    torch::Tensor mu2 = moments[1];
     torch::Tensor mu1_sq = mu1.pow(2.0);
     torch::Tensor mu2_sq = mu2.pow(2.0);
     torch::Tensor mu1_mu2 = mu1 * mu2;
 
-    // (2) Calculation of Variance and Covariance
-    torch::Tensor var1 = F::conv2d(image1*image1, this->window, F::Conv2dFuncOptions().padding(this->window_size/2).groups(this->nc)) - mu1_sq;
-    torch::Tensor var2 = F::conv2d(image2*image2, this->window, F::Conv2dFuncOptions().padding(this->window_size/2).groups(this->nc)) - mu2_sq;
-    torch::Tensor covar = F::conv2d(image1*image2, this->window, F::Conv2dFuncOptions().padding(this->window_size/2).groups(this->nc)) - mu1_mu2;
+    // (3) Calculation of Variance and Covariance
+    torch::Tensor var1 = moments[2] - mu1_sq;
+    torch::Tensor var2 = moments[3] - mu2_sq;
+    torch::Tensor covar = moments[4] - mu1_mu2;
 
-    // (3) Calculation of SSIM
+    // (4) Calculation of SSIM
     float c1 = this->c1_base * this->c1_base;
     float c2 = this->c2_base * this->c2_base;
     torch::Tensor ssim = (2.0 * mu1_mu2 + c1) * (2.0 * covar + c2) / ((mu1_sq + mu2_sq + c1) * (var1 + var2 + c2));
 
+    if (each){
+        return ssim.view({ssim.size(0), -1}).mean(/*dim=*/1);  // {N,C,H,W} ===> {N}
+    }
     return ssim.mean();
 
 }
 
 
+// -----------------------------------------------------------------------------
+// namespace{Losses} -> class{SSIMLoss} -> function{Structural_Similarity_CPU}
+// -----------------------------------------------------------------------------
+torch::Tensor Losses::SSIMLoss::Structural_Similarity_CPU(torch::Tensor &image1, torch::Tensor &image2, const bool each){
+
+    // (0) Initialization and Declaration
+    torch::Tensor x = image1.contiguous();
+    torch::Tensor y = image2.contiguous();
+    long int planes = x.size(0) * x.size(1);
+    long int height = x.size(2);
+    long int width = x.size(3);
+    long int area = height * width;
+    long int pad = this->window_size / 2;
+    float c1 = this->c1_base * this->c1_base;
+    float c2 = this->c2_base * this->c2_base;
+    const float *x_ptr = x.data_ptr<float>();
+    const float *y_ptr = y.data_ptr<float>();
+    const float *g = this->gauss.data_ptr<float>();
+    long int rows = 2 * pad + 1;  // rows of the window held by the ring buffer
+    std::vector<double> partial(planes, 0.0);
+
+    // (1) Filtering and SSIM per Plane
+    #pragma omp parallel
+    {
+
+        std::vector<float> ring(5 * rows * width);  // horizontal pass of (x, y, x^2, y^2, xy) for the rows of the window, reused by the planes of a thread
+
+        #pragma omp for
+        for (long int p = 0; p < planes; p++){
+
+            const float *a = x_ptr + p * area;
+            const float *b = y_ptr + p * area;
+            long int next = 0;  // next row of the horizontal pass
+            double acc = 0.0;
+
+            for (long int i = 0; i < height; i++){
+
+                // (1.1) Horizontal Pass up to the Bottom Row of the Window
+                for (; next <= std::min(i + pad, height - 1); next++){
+                    float *r = ring.data() + 5 * (next % rows) * width;
+                    for (long int j = 0; j < width; j++){
+                        float s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0, s4 = 0.0;
+                        long int k_min = std::max(-pad, -j);
+                        long int k_max = std::min(pad, width - 1 - j);
+                        for (long int k = k_min; k <= k_max; k++){
+                            float w = g[k + pad];
+                            float va = a[next * width + j + k];
+                            float vb = b[next * width + j + k];
+                            s0 += w * va;
+                            s1 += w * vb;
+                            s2 += w * va * va;
+                            s3 += w * vb * vb;
+                            s4 += w * va * vb;
+                        }
+                        r[j] = s0;
+                        r[width + j] = s1;
+                        r[2 * width + j] = s2;
+                        r[3 * width + j] = s3;
+                        r[4 * width + j] = s4;
+                    }
+                }
+
+                // (1.2) Vertical Pass and SSIM
+                long int k_min = std::max(-pad, -i);
+                long int k_max = std::min(pad, height - 1 - i);
+                for (long int j = 0; j < width; j++){
+                    float mu1 = 0.0, mu2 = 0.0, e11 = 0.0, e22 = 0.0, e12 = 0.0;
+                    for (long int k = k_min; k <= k_max; k++){
+                        float w = g[k + pad];
+                        const float *r = ring.data() + 5 * ((i + k) % rows) * width;
+                        mu1 += w * r[j];
+                        mu2 += w * r[width + j];
+                        e11 += w * r[2 * width + j];
+                        e22 += w * r[3 * width + j];
+                        e12 += w * r[4 * width + j];
+                    }
+                    float mu1_mu2 = mu1 * mu2;
+                    float mu1_sq = mu1 * mu1;
+                    float mu2_sq = mu2 * mu2;
+                    acc += (double)((2.0f * mu1_mu2 + c1) * (2.0f * (e12 - mu1_mu2) + c2) / ((mu1_sq + mu2_sq + c1) * ((e11 - mu1_sq) + (e22 - mu2_sq) + c2)));
+                }
+
+            }
+
+            partial[p] = acc;
+
+        }
+
+    }
+
+    // (2) Average of SSIM
+    if (each){
+        long int mini_batch_size = x.size(0);
+        torch::Tensor out = torch::empty({mini_batch_size}, torch::TensorOptions().dtype(torch::kFloat));
+        auto out_a = out.accessor<float, 1>();
+        for (long int n = 0; n < mini_batch_size; n++){
+            double total = 0.0;
+            for (long int p = n * x.size(1); p < (n + 1) * x.size(1); p++){
+                total += partial[p];
+            }
+            out_a[n] = (float)(total / (double)(x.size(1) * area));
+        }
+        return out;
+    }
+    double total = 0.0;
+    for (auto &v : partial){
+        total += v;
+    }
+
+    return torch::full({}, /*value=*/(float)(total / (double)(planes * area)), torch::TensorOptions().dtype(torch::kFloat));
+
+}
+
+
 // -------------------------------------------------
 // namespace{Losses} -> class{SSIMLoss} -> operator
 // -------------------------------------------------
 torch::Tensor Losses::SSIMLoss::operator()(torch::Tensor &input, torch::Tensor &target){
     return -this->Structural_Similarity(input, target) * 0.5 + 0.5;  // 0.0<=SSIM<=1.0 (0.0 is best matching)
 }
+
+
+// -------------------------------------------------------
+// namespace{Losses} -> class{SSIMLoss} -> function{each}
+// -------------------------------------------------------
+torch::Tensor Losses::SSIMLoss::each(torch::Tensor &input, torch::Tensor &target){
+    return -this->Structural_Similarity(input, target, /*each=*/true) * 0.5 + 0.5;  // {N,C,H,W} ===> {N}
+}
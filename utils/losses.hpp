@@ -1,6 +1,10 @@
 #ifndef LOSSES_HPP
 #define LOSSES_HPP
 
+#include <string>
+#include <tuple>
+#include <utility>
+#include <map>
 // For External Library
 #include <torch/torch.h>
 
@@ -15,20 +19,23 @@ namespace Losses{
     // -------------------------------------
     class SSIMLoss{
     private:
-        size_t nc;
         size_t window_size;
         float gauss_std;
         float c1_base;
         float c2_base;
-        torch::Tensor window;
+        bool fused_cpu;
+        torch::Tensor gauss;  // 1-D Gaussian window {W} (CPU)
+        std::map<std::tuple<size_t, std::string, int>, std::pair<torch::Tensor, torch::Tensor>> windows;  // (nc, device, dtype) ===> (horizontal{5C,1,1,W}, vertical{5C,1,W,1})
+        std::pair<torch::Tensor, torch::Tensor> &get_window(const size_t nc, const torch::Device device, const torch::ScalarType dtype);
+        torch::Tensor Structural_Similarity_CPU(torch::Tensor &image1, torch::Tensor &image2, const bool each);
     public:
-        SSIMLoss(){}
-        SSIMLoss(const size_t nc_, const torch::Device device, const size_t window_size_=11, const float gauss_std_=1.5, const float c1_base_=0.01, const float c2_base_=0.03);
-        torch::Tensor Structural_Similarity(torch::Tensor &image1, torch::Tensor &image2);
+        SSIMLoss(const size_t window_size_=11, const float gauss_std_=1.5, const float c1_base_=0.01, const float c2_base_=0.03, const bool fused_cpu_=true);
+        torch::Tensor Structural_Similarity(torch::Tensor &image1, torch::Tensor &image2, const bool each=false);
         torch::Tensor operator()(torch::Tensor &input, torch::Tensor &target);
+        torch::Tensor each(torch::Tensor &input, torch::Tensor &target);
     };
 
 }
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,178 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "lowrank.hpp"
+
+// Define Namespace
+namespace nn = torch::nn;
+
+
+// ---------------------------------------------
+// namespace{lowrank} -> function{parse_ranks}
+// ---------------------------------------------
+// "r1,r2,..." ===> {r1,r2,...} (an empty string or a rank of 0 keeps the layer in full rank)
+std::vector<long int> lowrank::parse_ranks(const std::string ranks, const size_t num){
+
+    std::vector<long int> out;
+    std::stringstream ss(ranks);
+    std::string item;
+
+    if (ranks == ""){
+        return std::vector<long int>(num, 0);
+    }
+    while (std::getline(ss, item, ',')){
+        out.push_back(std::stol(item));
+    }
+    if (out.size() != num){
+        std::cerr << "Error : The number of ranks is " << out.size() << '.' << std::endl;
+        std::cerr << "Error : Please give " << num << " ranks for the fully connected layers (0 keeps the layer in full rank)." << std::endl;
+        std::exit(1);
+    }
+
+    return out;
+
+}
+
+
+// ---------------------------------------------
+// namespace{lowrank} -> function{format_ranks}
+// ---------------------------------------------
+std::string lowrank::format_ranks(const std::vector<long int> ranks){
+    std::string out;
+    for (size_t i = 0; i < ranks.size(); i++){
+        out += (i == 0 ? "" : ",") + std::to_string(ranks.at(i));
+    }
+    return out;
+}
+
+
+// ---------------------------------------------
+// namespace{lowrank} -> function{linear}
+// ---------------------------------------------
+// The full-rank layer stays a plain Linear, so that the checkpoints without factorization can be loaded as before.
+nn::AnyModule lowrank::linear(const long int in_features, const long int out_features, const long int rank){
+    if (rank <= 0){
+        return nn::AnyModule(nn::Linear(in_features, out_features));
+    }
+    return nn::AnyModule(lowrank::FactorizedLinear(in_features, out_features, rank));
+}
+
+
+// ---------------------------------------------
+// namespace{lowrank} -> function{select_rank}
+// ---------------------------------------------
+// Use the given rank, or the smallest rank keeping the ratio "energy" of the squared singular values.
+// A rank without reduction of the parameters returns 0 (full rank).
+long int lowrank::select_rank(torch::Tensor S, const long int in_features, const long int out_features, const size_t rank, const float energy){
+    long int r;
+    if (rank > 0){
+        r = std::min((long int)rank, S.size(0));
+    }
+    else{
+        torch::Tensor ratio = (S * S).cumsum(/*dim=*/0) / (S * S).sum();  // {K}
+        r = std::min((ratio < energy).sum().item<long int>() + 1, S.size(0));
+    }
+    if (r * (in_features + out_features) >= in_features * out_features){
+        return 0;
+    }
+    return r;
+}
+
+
+// ---------------------------------------------
+// namespace{lowrank} -> function{factorize}
+// ---------------------------------------------
+// Replace every Linear in the Sequentials of the model with the truncated SVD : W = U S V^T ~ (U_r S_r^(1/2)) (S_r^(1/2) V_r^T)
+// The ranks are returned in the order of the layers, in the format of the network option "fc_ranks".
+std::vector<long int> lowrank::factorize(std::shared_ptr<nn::Module> model, const size_t rank, const float energy){
+
+    torch::NoGradGuard no_grad;
+
+    size_t i;
+    long int r;
+    std::vector<long int> ranks;
+
+    for (auto &module : model->modules(/*include_self=*/true)){
+        auto seq_ptr = std::dynamic_pointer_cast<nn::SequentialImpl>(module);
+        if (!seq_ptr) continue;
+        nn::Sequential seq(seq_ptr);
+        for (i = 0; i < seq->size(); i++){
+            auto linear_ptr = std::dynamic_pointer_cast<nn::LinearImpl>(seq->ptr(i));
+            if (!linear_ptr) continue;
+            nn::Linear linear(linear_ptr);
+            long int in_features = linear->options.in_features();
+            long int out_features = linear->options.out_features();
+
+            // (1) Singular Value Decomposition
+            auto [U, S, V] = torch::svd(linear->weight.to(torch::kFloat));  // {OUT,IN} ===> {OUT,K}, {K}, {IN,K}
+            r = lowrank::select_rank(S, in_features, out_features, rank, energy);
+            ranks.push_back(r);
+            if (r == 0) continue;
+
+            // (2) Factorized Layer
+            torch::Tensor sqrt_S = S.narrow(/*dim=*/0, 0, r).sqrt();  // {R}
+            torch::Tensor weight_V = sqrt_S.unsqueeze(1) * V.narrow(/*dim=*/1, 0, r).t();  // {R,1} * {R,IN} ===> {R,IN}
+            torch::Tensor weight_U = U.narrow(/*dim=*/1, 0, r) * sqrt_S.unsqueeze(0);  // {OUT,R} * {1,R} ===> {OUT,R}
+            lowrank::FactorizedLinear factorized(in_features, out_features, r);
+            factorized->to(linear->weight.device(), linear->weight.scalar_type());
+            factorized->set_weights(weight_V, weight_U, linear->options.bias() ? linear->bias : torch::zeros({out_features}));
+            *(seq->begin() + i) = nn::AnyModule(factorized);
+            seq->replace_module(std::to_string(i), factorized);
+        }
+    }
+
+    return ranks;
+
+}
+
+
+// ---------------------------------------------
+// namespace{lowrank} -> function{count_params}
+// ---------------------------------------------
+size_t lowrank::count_params(std::shared_ptr<nn::Module> model){
+    size_t total = 0;
+    for (auto &param : model->parameters()){
+        total += param.numel();
+    }
+    return total;
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{lowrank} -> struct{FactorizedLinearImpl}(nn::Module) -> constructor
+// ---------------------------------------------------------------------------
+lowrank::FactorizedLinearImpl::FactorizedLinearImpl(const long int in_features, const long int out_features, const long int rank){
+    this->layers = nn::Sequential(
+        nn::Linear(nn::LinearOptions(/*in_features=*/in_features, /*out_features=*/rank).bias(false)),  // {IN} ===> {R}
+        nn::Linear(nn::LinearOptions(/*in_features=*/rank, /*out_features=*/out_features))              // {R} ===> {OUT}
+    );
+    register_module("layers", this->layers);
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{lowrank} -> struct{FactorizedLinearImpl}(nn::Module) -> function{set_weights}
+// ---------------------------------------------------------------------------
+void lowrank::FactorizedLinearImpl::set_weights(torch::Tensor V, torch::Tensor U, torch::Tensor bias){
+    torch::NoGradGuard no_grad;
+    this->layers[0]->as<nn::Linear>()->weight.copy_(V);  // {R,IN}
+    this->layers[1]->as<nn::Linear>()->weight.copy_(U);  // {OUT,R}
+    this->layers[1]->as<nn::Linear>()->bias.copy_(bias);  // {OUT}
+    return;
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{lowrank} -> struct{FactorizedLinearImpl}(nn::Module) -> function{forward}
+// ---------------------------------------------------------------------------
+torch::Tensor lowrank::FactorizedLinearImpl::forward(torch::Tensor x){
+    return this->layers->forward(x);  // {IN} ===> {R} ===> {OUT}
+}
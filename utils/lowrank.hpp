@@ -0,0 +1,43 @@
+#ifndef LOWRANK_HPP
+#define LOWRANK_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+// For External Library
+#include <torch/torch.h>
+
+
+// --------------------
+// namespace{lowrank}
+// --------------------
+namespace lowrank{
+
+    // Function Prototype
+    std::vector<long int> parse_ranks(const std::string ranks, const size_t num);
+    std::string format_ranks(const std::vector<long int> ranks);
+    torch::nn::AnyModule linear(const long int in_features, const long int out_features, const long int rank);
+    long int select_rank(torch::Tensor S, const long int in_features, const long int out_features, const size_t rank, const float energy);
+    std::vector<long int> factorize(std::shared_ptr<torch::nn::Module> model, const size_t rank, const float energy);
+    size_t count_params(std::shared_ptr<torch::nn::Module> model);
+
+    // ------------------------------------------------------------
+    // namespace{lowrank} -> struct{FactorizedLinearImpl}(nn::Module)
+    // ------------------------------------------------------------
+    // W {OUT,IN} ~ U {OUT,R} * V {R,IN} : Linear(IN,OUT) ===> Linear(IN,R,bias=false) -> Linear(R,OUT)
+    struct FactorizedLinearImpl : torch::nn::Module{
+    private:
+        torch::nn::Sequential layers;
+    public:
+        FactorizedLinearImpl(){}
+        FactorizedLinearImpl(const long int in_features, const long int out_features, const long int rank);
+        void set_weights(torch::Tensor V, torch::Tensor U, torch::Tensor bias);
+        torch::Tensor forward(torch::Tensor x);
+    };
+
+    TORCH_MODULE(FactorizedLinear);
+
+}
+
+
+#endif
@@ -0,0 +1,158 @@
+#include <string>
+#include <sstream>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <algorithm>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "metrics.hpp"
+#include "progress.hpp"
+
+
+// ----------------------------------------------------
+// namespace{metrics} -> class{logger} -> constructor
+// ----------------------------------------------------
+metrics::logger::logger(progress::display *show_progress_, std::ofstream &ofs_, const std::string json_path, const size_t epoch_, const size_t total_iter_, const std::vector<std::string> loss_, const size_t sync_iter_){
+    this->stop = false;
+    this->epoch = epoch_;
+    this->total_iter = total_iter_;
+    this->sync_iter = std::max<size_t>(sync_iter_, 1);
+    this->iters = 0;
+    this->slot = 0;
+    this->loss = loss_;
+    this->show_progress = show_progress_;
+    this->ofs = &ofs_;
+    if (json_path != "") this->ofs_json.open(json_path, std::ios::app);
+    this->worker = std::thread(&metrics::logger::work, this);
+}
+
+
+// ---------------------------------------------------------
+// namespace{metrics} -> class{logger} -> function{push}
+// ---------------------------------------------------------
+// Only a device copy is issued here, without the synchronization of "item()".
+void metrics::logger::push(const std::vector<torch::Tensor> loss_value){
+
+    torch::NoGradGuard no_grad;
+    std::vector<torch::Tensor> values;
+
+    // (1) Ring Buffer on the Device of the Losses
+    for (auto &v : loss_value){
+        values.push_back(v.detach().reshape({}).to(torch::kFloat));
+    }
+    if (!this->ring.defined()){
+        this->ring = torch::zeros({(long int)this->sync_iter, (long int)values.size()}, torch::TensorOptions().dtype(torch::kFloat).device(values.at(0).device()));
+    }
+    this->ring[this->slot].copy_(torch::stack(values));  // {L} ===> {K,L}
+    this->slot++;
+    this->iters++;
+
+    // (2) Synchronization per "sync_iter" Iterations
+    if (this->slot == this->sync_iter) this->sync();
+
+    // End Processing
+    return;
+
+}
+
+
+// ---------------------------------------------------------
+// namespace{metrics} -> class{logger} -> function{sync}
+// ---------------------------------------------------------
+void metrics::logger::sync(){
+
+    // (0) Initialization and Declaration
+    size_t i, j;
+    size_t count;
+    std::vector<float> value;
+    std::stringstream ss, ss_json;
+    torch::Tensor host;
+
+    if (this->slot == 0) return;
+
+    // (1) Copy the Rows to the Host at Once
+    host = this->ring.narrow(/*dim=*/0, /*start=*/0, /*length=*/this->slot).to(torch::kCPU);  // {K,L}
+    auto host_a = host.accessor<float, 2>();
+
+    // (2) Progress and Text for each Iteration
+    count = this->iters - this->slot;
+    value = std::vector<float>(this->loss.size());
+    for (i = 0; i < this->slot; i++){
+        count++;
+        for (j = 0; j < this->loss.size(); j++){
+            value.at(j) = host_a[i][j];
+        }
+        this->show_progress->increment(/*loss_value=*/value);
+        ss << "iters:" << count << '/' << this->total_iter;
+        ss_json << "{\"epoch\":" << this->epoch << ",\"iters\":" << count;
+        for (j = 0; j < this->loss.size(); j++){
+            ss << ' ' << this->loss.at(j) << ':' << value.at(j) << "(ave:" << this->show_progress->get_ave(j) << ')';
+            ss_json << ",\"" << this->loss.at(j) << "\":" << value.at(j);
+        }
+        ss << '\n';
+        ss_json << "}\n";
+    }
+    this->slot = 0;
+
+    // (3) Hand the Text to the Writer
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        this->lines.push_back({ss.str(), ss_json.str()});
+    }
+    this->cond.notify_one();
+
+    // End Processing
+    return;
+
+}
+
+
+// ---------------------------------------------------------
+// namespace{metrics} -> class{logger} -> function{work}
+// ---------------------------------------------------------
+// The text is written in blocks, and the files are flushed only when the logger is finished.
+void metrics::logger::work(){
+    std::pair<std::string, std::string> text;
+    while (true){
+        {
+            std::unique_lock<std::mutex> lock(this->mtx);
+            this->cond.wait(lock, [this]{ return this->stop || !this->lines.empty(); });
+            if (this->lines.empty()) break;
+            text = std::move(this->lines.front());
+            this->lines.pop_front();
+        }
+        *this->ofs << text.first;
+        if (this->ofs_json.is_open()) this->ofs_json << text.second;
+    }
+    this->ofs->flush();
+    if (this->ofs_json.is_open()) this->ofs_json.flush();
+    return;
+}
+
+
+// ---------------------------------------------------------
+// namespace{metrics} -> class{logger} -> function{get_iters}
+// ---------------------------------------------------------
+size_t metrics::logger::get_iters(){
+    return this->iters;
+}
+
+
+// ---------------------------------------------------
+// namespace{metrics} -> class{logger} -> destructor
+// ---------------------------------------------------
+// The rest of the ring buffer is synchronized, and the writer is joined before the caller uses the files again.
+metrics::logger::~logger(){
+    this->sync();
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        this->stop = true;
+    }
+    this->cond.notify_one();
+    this->worker.join();
+    this->ofs_json.close();
+}
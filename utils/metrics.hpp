@@ -0,0 +1,54 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "progress.hpp"
+
+
+// --------------------
+// namespace{metrics}
+// --------------------
+namespace metrics{
+
+    // ---------------------------------------
+    // namespace{metrics} -> class{logger}
+    // ---------------------------------------
+    // The losses of each iteration are kept as detached tensors on the device in a ring buffer of "sync_iter" rows.
+    // They are copied to the host once per "sync_iter" iterations, passed to progress::display in order,
+    // and written by a background thread as the lines of "train.txt" and as JSON lines.
+    class logger{
+    private:
+        bool stop;
+        size_t epoch, total_iter, sync_iter;
+        size_t iters, slot;
+        std::vector<std::string> loss;
+        torch::Tensor ring;
+        progress::display *show_progress;
+        std::ofstream *ofs;
+        std::ofstream ofs_json;
+        std::deque<std::pair<std::string, std::string>> lines;
+        std::mutex mtx;
+        std::condition_variable cond;
+        std::thread worker;
+        void sync();
+        void work();
+    public:
+        logger(progress::display *show_progress_, std::ofstream &ofs_, const std::string json_path, const size_t epoch_, const size_t total_iter_, const std::vector<std::string> loss_, const size_t sync_iter_);
+        void push(const std::vector<torch::Tensor> loss_value);
+        size_t get_iters();
+        ~logger();
+    };
+
+}
+
+
+#endif
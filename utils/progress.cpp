@@ -5,6 +5,8 @@
 #include <chrono>
 #include <algorithm>
 #include <utility>
+#include <mutex>
+#include <thread>
 #include <ios>
 #include <iomanip>
 #include <cstdlib>
@@ -14,20 +16,20 @@
 // For Original Header
 #include "progress.hpp"
 
+// Define Constant
+constexpr std::chrono::milliseconds refresh_interval(100);  // the interval to redraw the progress bar (10 Hz)
+constexpr std::chrono::seconds log_interval(10);  // the interval of the plain lines without terminal
+
+// Function Prototype
+static size_t terminal_width();
+
 
 // -------------------------------------------
 // namespace{progress} -> function{separator}
 // -------------------------------------------
 std::string progress::separator(){
     size_t length;
-    struct winsize ws;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != -1){
-       length = ws.ws_col - 1;
-    }
-    else{
-        std::cerr << "Error : Couldn't get the width of terminal." << std::endl;
-        std::exit(1);
-    }
+    length = terminal_width() - 1;
     return std::string(length, '-');
 }
 
@@ -37,14 +39,7 @@ std::string progress::separator(){
 // --------------------------------------------------
 std::string progress::separator_center(const std::string word){
     size_t length;
-    struct winsize ws;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != -1){
-       length = ws.ws_col - 1;
-    }
-    else{
-        std::cerr << "Error : Couldn't get the width of terminal." << std::endl;
-        std::exit(1);
-    }
+    length = terminal_width() - 1;
     size_t both_width = length - word.length() - 2;
     return std::string(both_width/2, '-') + " " + word + " " + std::string(both_width/2, '-');
 }
@@ -69,38 +64,39 @@ std::string progress::current_date(){
 // namespace{progress} -> class{display} -> constructor
 // ------------------------------------------------------
 progress::display::display(const size_t count_max_, const std::pair<size_t, size_t> epoch, const std::vector<std::string> loss_){
-
-    this->count = 0;
-    this->count_max = count_max_;
-    this->length = 0;
-    this->loss = loss_;
-
     std::stringstream ss;
     ss << "epoch:" << epoch.first << "/" << epoch.second << " ";
-    std::cout << ss.str() << std::flush;
-    this->header = ss.str().length();
-
-    this->loss_sum = std::vector<float>(this->loss.size(), 0.0);
-    this->loss_ave = std::vector<float>(this->loss.size(), 0.0);
-    this->start = std::chrono::system_clock::now();
-
+    this->init(count_max_, ss.str(), loss_);
 }
 
 progress::display::display(const size_t count_max_, const std::string header1, const std::string header2, const std::vector<std::string> loss_){
+    std::stringstream ss;
+    ss << header1 << " " << header2 << " ";
+    this->init(count_max_, ss.str(), loss_);
+}
+
+
+// --------------------------------------------------------
+// namespace{progress} -> class{display} -> function{init}
+// --------------------------------------------------------
+void progress::display::init(const size_t count_max_, const std::string header_, const std::vector<std::string> loss_){
 
+    this->tty = isatty(STDOUT_FILENO);
+    this->stop = false;
     this->count = 0;
     this->count_max = count_max_;
     this->length = 0;
     this->loss = loss_;
+    this->header_str = header_;
+    this->header = this->header_str.length();
+    if (this->tty) std::cout << this->header_str << std::flush;
 
-    std::stringstream ss;
-    ss << header1 << " " << header2 << " ";
-    std::cout << ss.str() << std::flush;
-    this->header = ss.str().length();
-
+    this->loss_value = std::vector<float>(this->loss.size(), 0.0);
     this->loss_sum = std::vector<float>(this->loss.size(), 0.0);
     this->loss_ave = std::vector<float>(this->loss.size(), 0.0);
     this->start = std::chrono::system_clock::now();
+    this->last_log = this->start;
+    this->renderer = std::thread(&progress::display::run, this);
 
 }
 
@@ -108,107 +104,104 @@ progress::display::display(const size_t count_max_, const std::string header1, c
 // -------------------------------------------------------------
 // namespace{progress} -> class{display} -> function{increment}
 // -------------------------------------------------------------
+// Only the counters are updated here, and nothing is written to the terminal.
 void progress::display::increment(const std::vector<float> loss_value){
+    std::lock_guard<std::mutex> lock(this->mtx);
+    for (size_t i = 0; i < this->loss.size(); i++){
+        this->loss_value.at(i) = loss_value.at(i);
+        this->loss_sum.at(i) += loss_value.at(i);
+        this->loss_ave.at(i) = this->loss_sum.at(i) / (float)(this->count + 1);
+    }
+    this->count++;
+    return;
+}
+
+
+// -------------------------------------------------------
+// namespace{progress} -> class{display} -> function{run}
+// -------------------------------------------------------
+void progress::display::run(){
+    std::unique_lock<std::mutex> lock(this->mtx);
+    while (!this->stop){
+        this->cond.wait_for(lock, refresh_interval, [this]{ return this->stop; });
+        if (this->stop) break;
+        lock.unlock();
+        this->render(/*final=*/false);
+        lock.lock();
+    }
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{progress} -> class{display} -> function{render}
+// ----------------------------------------------------------
+void progress::display::render(const bool final){
 
     // (0) Initialization and Declaration
     size_t i;
+    size_t count_now;
     size_t center_length, bar_length;
     size_t ideal_length;
     int percent;
     int elap_min, elap_sec, rem_times, rem_min, rem_sec;
     double sec_per_iter;
     std::string initialize;
-    std::string left_str, right_str, center_str;
-    std::string elap_min_str, elap_sec_str, sec_per_iter_str, rem_min_str, rem_sec_str;
+    std::string loss_str, left_str, right_str, center_str;
     std::stringstream ss;
+    std::vector<float> value, ave;
+
+    // (1) Snapshot of the Counters
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        count_now = this->count;
+        value = this->loss_value;
+        ave = this->loss_ave;
+    }
+    if (count_now == 0) return;
+    this->end = std::chrono::system_clock::now();
+    if (!this->tty && !final && (this->end - this->last_log < log_interval)) return;
 
-    // (1) Count Up Epochs
-    this->count++;
-
-    // (2) Initialization of Terminal Line
-    initialize = std::string(this->length, '\b') + std::string(this->length, ' ') + std::string(this->length, '\b');
-
-    // (3) Get Left String
-    left_str = "";
+    // (2) Get Loss String
     for (i = 0; i < this->loss.size(); i++){
-        this->loss_sum.at(i) += loss_value.at(i);
-        this->loss_ave.at(i) = this->loss_sum.at(i) / (float)this->count;
-        ss.str(""); ss.clear(std::stringstream::goodbit);
-        ss << this->loss.at(i) << ":" << loss_value.at(i);
-        ss << "(ave:" << this->loss_ave.at(i) << ") ";
-        left_str += ss.str();
+        ss << this->loss.at(i) << ":" << value.at(i) << "(ave:" << ave.at(i) << ") ";
     }
+    loss_str = ss.str();
     ss.str(""); ss.clear(std::stringstream::goodbit);
-    percent = (int)((float)this->count / (float)this->count_max * 100.0f);
+    percent = (int)((float)count_now / (float)this->count_max * 100.0f);
     ss << std::right << std::setw(4) << percent;
-    left_str += ss.str() + "%[";
-
-    // (4) Get Times for Right String
-    sec_per_iter = 0.0; rem_times = 0;
-    this->end = std::chrono::system_clock::now();
-    for (i = 0; i < 6; i++){
-        ss.str(""); ss.clear(std::stringstream::goodbit);
-        switch (i){
-            case 0:
-                elap_min = (int)std::chrono::duration_cast<std::chrono::minutes>(this->end - this->start).count();
-                ss << std::setfill('0') << std::right << std::setw(2) << elap_min;
-                elap_min_str = ss.str();
-                break;
-            case 1:
-                elap_sec = (int)std::chrono::duration_cast<std::chrono::seconds>(this->end - this->start).count() % 60;
-                ss << std::setfill('0') << std::right << std::setw(2) << elap_sec;
-                elap_sec_str = ss.str();
-                break;
-            case 2:
-                sec_per_iter = (double)std::chrono::duration_cast<std::chrono::milliseconds>(this->end - this->start).count() * 0.001 / (double)this->count;
-                ss << std::setprecision(3) << sec_per_iter;
-                sec_per_iter_str = ss.str();
-                break;
-            case 3:
-                rem_times = (int)(sec_per_iter * (double)(this->count_max - this->count));
-                break;
-            case 4:
-                rem_min = rem_times / 60;
-                ss << std::setfill('0') << std::right << std::setw(2) << rem_min;
-                rem_min_str = ss.str();
-                break;
-            case 5:
-                rem_sec = rem_times % 60;
-                ss << std::setfill('0') << std::right << std::setw(2) << rem_sec;
-                rem_sec_str = ss.str();
-                break;
-            default:
-                std::cerr << "Error : There is an unexpected value in argument of 'switch'." << std::endl;
-                std::exit(1);
-        }
-    }
-
-    // (5) Get Right String
+    left_str = loss_str + ss.str() + "%[";
+
+    // (3) Get Right String
+    elap_min = (int)std::chrono::duration_cast<std::chrono::minutes>(this->end - this->start).count();
+    elap_sec = (int)std::chrono::duration_cast<std::chrono::seconds>(this->end - this->start).count() % 60;
+    sec_per_iter = (double)std::chrono::duration_cast<std::chrono::milliseconds>(this->end - this->start).count() * 0.001 / (double)count_now;
+    rem_times = (int)(sec_per_iter * (double)(this->count_max - std::min(count_now, this->count_max)));
+    rem_min = rem_times / 60;
+    rem_sec = rem_times % 60;
     ss.str(""); ss.clear(std::stringstream::goodbit);
-    ss << "] " << this->count << "/" << this->count_max << " ";
-    ss << "[" << elap_min_str << ":" << elap_sec_str << "<" << rem_min_str << ":" << rem_sec_str << ", " << sec_per_iter_str << "s/it]";
+    ss << "] " << count_now << "/" << this->count_max << " ";
+    ss << "[" << std::setfill('0') << std::right << std::setw(2) << elap_min << ":" << std::setw(2) << elap_sec;
+    ss << "<" << std::setw(2) << rem_min << ":" << std::setw(2) << rem_sec << ", " << std::setprecision(3) << sec_per_iter << "s/it]";
     right_str = ss.str();
 
-    // (6) Catch Terminal Size
-    struct winsize ws;
-    ideal_length = 0;
-    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != -1){
-       ideal_length = ws.ws_col - this->header - 1;
-    }
-    else{
-        std::cerr << "Error : Couldn't get the width of terminal." << std::endl;
-        std::exit(1);
+    // (4) Plain Line without Terminal
+    if (!this->tty){
+        std::cout << this->header_str << loss_str << percent << "% " << right_str.substr(2) << std::endl;
+        this->last_log = this->end;
+        return;
     }
 
-    // (7) Get Center String
+    // (5) Get Center String
+    ideal_length = terminal_width() - this->header - 1;
     center_length = (size_t)std::max((int)1, (int)(ideal_length - left_str.length() - right_str.length()));
-    bar_length = (size_t)((float)center_length * (float)this->count / (float)this->count_max);
+    bar_length = (size_t)((float)center_length * (float)std::min(count_now, this->count_max) / (float)this->count_max);
     center_str = std::string(bar_length, '#') + std::string(center_length - bar_length, ' ');
 
-    // (8) Output All String
+    // (6) Output All String
+    initialize = std::string(this->length, '\b') + std::string(this->length, ' ') + std::string(this->length, '\b');
     this->length = left_str.length() + center_str.length() + right_str.length();
-    std::cout << initialize << std::flush;
-    std::cout << left_str << center_str << right_str << std::flush;
+    std::cout << initialize << left_str << center_str << right_str << std::flush;
 
     // End Processing
     return;
@@ -228,10 +221,12 @@ size_t progress::display::get_iters(){
 // namespace{progress} -> class{display} -> function{get_ave}
 // -----------------------------------------------------------
 std::vector<float> progress::display::get_ave(){
+    std::lock_guard<std::mutex> lock(this->mtx);
     return this->loss_ave;
 }
 
 float progress::display::get_ave(const int index){
+    std::lock_guard<std::mutex> lock(this->mtx);
     return this->loss_ave.at(index);
 }
 
@@ -239,8 +234,17 @@ float progress::display::get_ave(const int index){
 // ----------------------------------------------------
 // namespace{progress} -> class{display} -> destructor
 // ----------------------------------------------------
+// The last state is drawn after the renderer is stopped.
 progress::display::~display(){
-    std::cout << std::endl;
+    if (!this->renderer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        this->stop = true;
+    }
+    this->cond.notify_one();
+    this->renderer.join();
+    this->render(/*final=*/true);
+    if (this->tty) std::cout << std::endl;
 }
 
 
@@ -377,4 +381,17 @@ std::string progress::irregular::get_date_fin(){
 // -----------------------------------------------------------------
 std::string progress::irregular::get_sec_per(){
     return this->sec_per;
-}
\ No newline at end of file
+}
+
+
+// ----------------------------------------------------------
+// function{terminal_width}
+// ----------------------------------------------------------
+// 80 columns are assumed when the output is not a terminal.
+static size_t terminal_width(){
+    struct winsize ws;
+    if ((ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != -1) && (ws.ws_col > 0)){
+        return ws.ws_col;
+    }
+    return 80;
+}
@@ -4,6 +4,10 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 
 // -------------------------
@@ -19,15 +23,26 @@ namespace progress{
     // ---------------------------------------
     // namespace{progress} -> class{display}
     // ---------------------------------------
+    // The counters are updated by increment(), and the line is drawn by a background thread at a fixed rate.
+    // Without a terminal, plain lines are written at a longer interval instead of the progress bar.
     class display{
     private:
-        size_t count;
+        bool tty, stop;
+        std::atomic<size_t> count;
         size_t count_max;
         size_t header, length;
+        std::string header_str;
         std::vector<std::string> loss;
+        std::vector<float> loss_value;
         std::vector<float> loss_sum;
         std::vector<float> loss_ave;
-        std::chrono::system_clock::time_point start, end;
+        std::chrono::system_clock::time_point start, end, last_log;
+        std::mutex mtx;
+        std::condition_variable cond;
+        std::thread renderer;
+        void init(const size_t count_max_, const std::string header_, const std::vector<std::string> loss_);
+        void render(const bool final);
+        void run();
     public:
         display(){}
         display(const size_t count_max_, const std::pair<size_t, size_t> epoch, const std::vector<std::string> loss_);
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "pruning.hpp"
+
+// Define Namespace
+namespace nn = torch::nn;
+
+
+// ---------------------------------------------
+// namespace{pruning} -> function{importance}
+// ---------------------------------------------
+// Importance of the output channels of "Conv2d -> BatchNorm2d" : "bn" is |gamma|, and "l1" is the L1 norm of the filter.
+torch::Tensor pruning::importance(nn::Conv2d &conv, nn::BatchNorm2d &bn, const std::string criterion){
+    torch::NoGradGuard no_grad;
+    if ((criterion == "bn") && bn->options.affine()){
+        return bn->weight.abs().to(torch::kCPU, torch::kFloat);  // {OC}
+    }
+    else if (criterion == "l1"){
+        return conv->weight.abs().flatten(/*start_dim=*/1).sum(/*dim=*/1).to(torch::kCPU, torch::kFloat);  // {OC,IC,KH,KW} ===> {OC}
+    }
+    std::cerr << "Error : The pruning criterion is " << criterion << '.' << std::endl;
+    std::cerr << "Error : Please choose bn (with affine BatchNorm) or l1." << std::endl;
+    std::exit(1);
+}
+
+
+// ---------------------------------------------
+// namespace{pruning} -> function{select}
+// ---------------------------------------------
+// Indices of the channels kept after removing the ratio of the least important ones, in ascending order.
+torch::Tensor pruning::select(torch::Tensor importance, const float ratio){
+    long int channels = importance.size(0);
+    long int keep = std::max(1L, std::min(channels, (long int)std::round((float)channels * (1.0 - ratio))));
+    torch::Tensor index = std::get<1>(importance.topk(keep));  // {C} ===> {K}
+    return std::get<0>(index.sort());
+}
+
+
+// ---------------------------------------------
+// namespace{pruning} -> function{conv}
+// ---------------------------------------------
+// Dense convolution keeping the output channels "out_index" and the input channels "in_index" (an undefined index keeps all).
+nn::Conv2d pruning::conv(nn::Conv2d &conv, torch::Tensor out_index, torch::Tensor in_index){
+
+    torch::NoGradGuard no_grad;
+
+    // (1) Weights of Kept Channels
+    auto &o = conv->options;
+    if (o.groups() != 1){
+        std::cerr << "Error : The pruning of grouped convolutions is not supported." << std::endl;
+        std::exit(1);
+    }
+    torch::Tensor weight = conv->weight;
+    torch::Tensor bias = conv->bias;
+    if (out_index.defined()){
+        out_index = out_index.to(weight.device());
+        weight = weight.index_select(/*dim=*/0, out_index);  // {OC,IC,KH,KW} ===> {OC',IC,KH,KW}
+        if (bias.defined()) bias = bias.index_select(/*dim=*/0, out_index);  // {OC} ===> {OC'}
+    }
+    if (in_index.defined()){
+        weight = weight.index_select(/*dim=*/1, in_index.to(weight.device()));  // {OC',IC,KH,KW} ===> {OC',IC',KH,KW}
+    }
+
+    // (2) Convolution of Smaller Size
+    nn::Conv2d out(nn::Conv2dOptions(weight.size(1), weight.size(0), o.kernel_size()).stride(o.stride()).padding(o.padding()).dilation(o.dilation()).groups(1).bias(o.bias()).padding_mode(o.padding_mode()));
+    out->to(weight.device(), weight.scalar_type());
+    out->weight.copy_(weight);
+    if (bias.defined()) out->bias.copy_(bias);
+
+    return out;
+
+}
+
+
+// ---------------------------------------------
+// namespace{pruning} -> function{batchnorm}
+// ---------------------------------------------
+nn::BatchNorm2d pruning::batchnorm(nn::BatchNorm2d &bn, torch::Tensor index){
+
+    torch::NoGradGuard no_grad;
+
+    auto &o = bn->options;
+    index = index.to(bn->running_mean.device());
+    nn::BatchNorm2d out(nn::BatchNorm2dOptions(index.size(0)).eps(o.eps()).momentum(o.momentum()).affine(o.affine()).track_running_stats(o.track_running_stats()));
+    out->to(bn->running_mean.device(), bn->running_mean.scalar_type());
+    if (o.affine()){
+        out->weight.copy_(bn->weight.index_select(/*dim=*/0, index));  // {C} ===> {C'}
+        out->bias.copy_(bn->bias.index_select(/*dim=*/0, index));  // {C} ===> {C'}
+    }
+    out->running_mean.copy_(bn->running_mean.index_select(/*dim=*/0, index));  // {C} ===> {C'}
+    out->running_var.copy_(bn->running_var.index_select(/*dim=*/0, index));  // {C} ===> {C'}
+    out->num_batches_tracked.copy_(bn->num_batches_tracked);
+
+    return out;
+
+}
+
+
+// ---------------------------------------------
+// namespace{pruning} -> function{read_widths}
+// ---------------------------------------------
+// One line per residual block, listing the widths of its inner convolutions
+std::vector<std::vector<long int>> pruning::read_widths(const std::string path){
+
+    long int width;
+    std::string line;
+    std::ifstream ifs(path, std::ios::in);
+    std::vector<std::vector<long int>> widths;
+
+    if (!ifs){
+        std::cerr << "Error : Couldn't open the widths file '" << path << "'." << std::endl;
+        std::exit(1);
+    }
+    while (std::getline(ifs, line)){
+        if (line.empty()) continue;
+        std::stringstream ss(line);
+        std::vector<long int> block;
+        while (ss >> width){
+            block.push_back(width);
+        }
+        widths.push_back(block);
+    }
+    ifs.close();
+
+    return widths;
+
+}
+
+
+// ---------------------------------------------
+// namespace{pruning} -> function{write_widths}
+// ---------------------------------------------
+void pruning::write_widths(const std::string path, const std::vector<std::vector<long int>> widths){
+    std::ofstream ofs(path, std::ios::out);
+    for (auto &block : widths){
+        for (size_t i = 0; i < block.size(); i++){
+            ofs << (i == 0 ? "" : " ") << block.at(i);
+        }
+        ofs << std::endl;
+    }
+    ofs.close();
+    return;
+}
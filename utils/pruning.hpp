@@ -0,0 +1,26 @@
+#ifndef PRUNING_HPP
+#define PRUNING_HPP
+
+#include <string>
+#include <vector>
+// For External Library
+#include <torch/torch.h>
+
+
+// --------------------
+// namespace{pruning}
+// --------------------
+namespace pruning{
+
+    // Function Prototype
+    torch::Tensor importance(torch::nn::Conv2d &conv, torch::nn::BatchNorm2d &bn, const std::string criterion);
+    torch::Tensor select(torch::Tensor importance, const float ratio);
+    torch::nn::Conv2d conv(torch::nn::Conv2d &conv, torch::Tensor out_index, torch::Tensor in_index);
+    torch::nn::BatchNorm2d batchnorm(torch::nn::BatchNorm2d &bn, torch::Tensor index);
+    std::vector<std::vector<long int>> read_widths(const std::string path);
+    void write_widths(const std::string path, const std::vector<std::vector<long int>> widths);
+
+}
+
+
+#endif
@@ -0,0 +1,439 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cmath>
+#include <cstdlib>
+// For External Library
+#include <torch/torch.h>
+#include <ATen/core/dispatch/Dispatcher.h>
+// For Original Header
+#include "quantization.hpp"
+
+// Define Namespace
+namespace nn = torch::nn;
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{replace}
+// -------------------------------------------------
+// Replace both the forward slot and the registered child of the Sequential, so that saved parameters follow the new module.
+template <typename T>
+static void replace(nn::Sequential &seq, const size_t index, T module){
+    *(seq->begin() + index) = nn::AnyModule(module);
+    seq->replace_module(std::to_string(index), module);
+    return;
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{call}
+// -------------------------------------------------
+// The quantized kernels are registered only as operators, so they are called through the dispatcher with boxed arguments.
+static std::vector<c10::IValue> call(const char *name, const char *overload, std::vector<c10::IValue> stack){
+    c10::OperatorHandle op = c10::Dispatcher::singleton().findSchemaOrThrow(name, overload);
+    op.callBoxed(&stack);
+    return stack;
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{to_vector}
+// -------------------------------------------------
+// The padding of Conv2dOptions is an ExpandingArray, or a variant of it in later versions of LibTorch.
+template <typename T>
+static std::vector<long int> to_vector(const T &value){
+    if constexpr (std::is_convertible_v<T, c10::ArrayRef<int64_t>>){
+        return c10::ArrayRef<int64_t>(value).vec();
+    }
+    else{
+        return c10::ArrayRef<int64_t>(std::get<torch::ExpandingArray<2>>(value)).vec();
+    }
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{passthrough}
+// -------------------------------------------------
+// Layers between two quantized layers which also run on quantized tensors
+static bool passthrough(std::shared_ptr<nn::Module> module){
+    return std::dynamic_pointer_cast<nn::IdentityImpl>(module) || std::dynamic_pointer_cast<nn::ReLUImpl>(module)
+        || std::dynamic_pointer_cast<nn::DropoutImpl>(module) || std::dynamic_pointer_cast<nn::MaxPool2dImpl>(module)
+        || std::dynamic_pointer_cast<nn::FlattenImpl>(module);
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{link}
+// -------------------------------------------------
+// Two quantized layers of the Sequential with only passthrough layers in between exchange the activation in uint8 :
+// the first one outputs with the input quantization parameters of the second one, and does not dequantize.
+static void link(nn::Sequential &seq){
+
+    size_t i, j;
+    std::pair<double, long int> next;
+
+    for (i = 0; i < seq->size(); i++){
+        for (j = i + 1; (j < seq->size()) && passthrough(seq->ptr(j)); j++);
+        if (j == seq->size()) continue;
+        if (auto conv_ptr = std::dynamic_pointer_cast<quantization::QuantizedConv2dImpl>(seq->ptr(j))){
+            next = conv_ptr->input_qparams();
+        }
+        else if (auto linear_ptr = std::dynamic_pointer_cast<quantization::QuantizedLinearImpl>(seq->ptr(j))){
+            next = linear_ptr->input_qparams();
+        }
+        else{
+            continue;
+        }
+        if (auto conv_ptr = std::dynamic_pointer_cast<quantization::QuantizedConv2dImpl>(seq->ptr(i))){
+            conv_ptr->chain(next);
+        }
+        else if (auto linear_ptr = std::dynamic_pointer_cast<quantization::QuantizedLinearImpl>(seq->ptr(i))){
+            linear_ptr->chain(next);
+        }
+    }
+
+    return;
+
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{quantize_weight}
+// -------------------------------------------------
+// Symmetric per-channel int8 : W ~ scale[oc] * q, q in [-127,127]
+static std::pair<torch::Tensor, torch::Tensor> quantize_weight(torch::Tensor weight){
+    torch::Tensor flat = weight.detach().to(torch::kCPU, torch::kFloat).flatten(/*start_dim=*/1);  // {OC,...} ===> {OC,K}
+    torch::Tensor scale = (std::get<0>(flat.abs().max(/*dim=*/1)) / 127.0).clamp_min(1e-8);  // {OC,K} ===> {OC}
+    torch::Tensor q = (flat / scale.unsqueeze(1)).round().clamp(-127, 127).to(torch::kChar);  // {OC,K}
+    return {q.view(weight.sizes()), scale.to(torch::kDouble)};
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{set_engine}
+// -------------------------------------------------
+void quantization::set_engine(const std::string engine){
+
+    at::QEngine qengine;
+    if (engine == "fbgemm"){
+        qengine = at::QEngine::FBGEMM;
+    }
+    else if (engine == "qnnpack"){
+        qengine = at::QEngine::QNNPACK;
+    }
+    else{
+        std::cerr << "Error : The quantization engine is " << engine << '.' << std::endl;
+        std::cerr << "Error : Please choose fbgemm or qnnpack." << std::endl;
+        std::exit(1);
+    }
+
+    const std::vector<at::QEngine> &supported = at::globalContext().supportedQEngines();
+    if (std::find(supported.begin(), supported.end(), qengine) == supported.end()){
+        std::cerr << "Error : The quantization engine " << engine << " is not supported by this LibTorch." << std::endl;
+        std::exit(1);
+    }
+    at::globalContext().setQEngine(qengine);
+
+    return;
+
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{prepare}
+// -------------------------------------------------
+// Wrap every Conv2d/Linear in the Sequentials of the model with an observer.
+// A ReLU following the layer (BatchNorm folded into Identity in between) is fused into the quantized kernel.
+size_t quantization::prepare(std::shared_ptr<nn::Module> model){
+
+    size_t i, j;
+    size_t observed = 0;
+    bool relu;
+
+    for (auto &module : model->modules(/*include_self=*/true)){
+        auto seq_ptr = std::dynamic_pointer_cast<nn::SequentialImpl>(module);
+        if (!seq_ptr) continue;
+        nn::Sequential seq(seq_ptr);
+        for (i = 0; i < seq->size(); i++){
+            relu = false;
+            for (j = i + 1; j < seq->size(); j++){
+                if (std::dynamic_pointer_cast<nn::IdentityImpl>(seq->ptr(j))) continue;
+                relu = (bool)std::dynamic_pointer_cast<nn::ReLUImpl>(seq->ptr(j));
+                break;
+            }
+            if (auto conv_ptr = std::dynamic_pointer_cast<nn::Conv2dImpl>(seq->ptr(i))){
+                replace(seq, i, quantization::Observed(nn::AnyModule(nn::Conv2d(conv_ptr)), conv_ptr, relu));
+            }
+            else if (auto linear_ptr = std::dynamic_pointer_cast<nn::LinearImpl>(seq->ptr(i))){
+                replace(seq, i, quantization::Observed(nn::AnyModule(nn::Linear(linear_ptr)), linear_ptr, relu));
+            }
+            else{
+                continue;
+            }
+            observed++;
+        }
+    }
+
+    return observed;
+
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{convert}
+// -------------------------------------------------
+// Replace every observed layer with the quantized layer, using the range recorded by the calibration.
+// The activations stay quantized between consecutive quantized layers, and are dequantized only before the other layers.
+size_t quantization::convert(std::shared_ptr<nn::Module> model){
+
+    size_t i;
+    size_t converted = 0;
+    bool reduce_range = (at::globalContext().qEngine() == at::QEngine::FBGEMM);  // fbgemm accumulates activations in 7 bits to avoid the overflow
+
+    for (auto &module : model->modules(/*include_self=*/true)){
+        auto seq_ptr = std::dynamic_pointer_cast<nn::SequentialImpl>(module);
+        if (!seq_ptr) continue;
+        nn::Sequential seq(seq_ptr);
+        for (i = 0; i < seq->size(); i++){
+            auto observed_ptr = std::dynamic_pointer_cast<quantization::ObservedImpl>(seq->ptr(i));
+            if (!observed_ptr) continue;
+            if (auto conv_ptr = std::dynamic_pointer_cast<nn::Conv2dImpl>(observed_ptr->module_ptr)){
+                nn::Conv2d conv(conv_ptr);
+                replace(seq, i, quantization::QuantizedConv2d(conv, *observed_ptr, reduce_range));
+            }
+            else if (auto linear_ptr = std::dynamic_pointer_cast<nn::LinearImpl>(observed_ptr->module_ptr)){
+                nn::Linear linear(linear_ptr);
+                replace(seq, i, quantization::QuantizedLinear(linear, *observed_ptr, reduce_range));
+            }
+            converted++;
+        }
+        link(seq);
+    }
+
+    return converted;
+
+}
+
+
+// -------------------------------------------------
+// namespace{quantization} -> function{pack}
+// -------------------------------------------------
+// The packed weights are not saved, so they are rebuilt after converting or loading.
+void quantization::pack(std::shared_ptr<nn::Module> model){
+    for (auto &module : model->modules(/*include_self=*/true)){
+        if (auto conv_ptr = std::dynamic_pointer_cast<quantization::QuantizedConv2dImpl>(module)){
+            conv_ptr->pack();
+        }
+        else if (auto linear_ptr = std::dynamic_pointer_cast<quantization::QuantizedLinearImpl>(module)){
+            linear_ptr->pack();
+        }
+    }
+    return;
+}
+
+
+// -------------------------------------------------------------
+// namespace{quantization} -> class{MinMaxObserver} -> constructor
+// -------------------------------------------------------------
+quantization::MinMaxObserver::MinMaxObserver(){
+    this->empty = true;
+    this->min_val = 0.0;
+    this->max_val = 0.0;
+}
+
+
+// -------------------------------------------------------------
+// namespace{quantization} -> class{MinMaxObserver} -> function{update}
+// -------------------------------------------------------------
+void quantization::MinMaxObserver::update(torch::Tensor x){
+    float min_x = x.detach().min().item<float>();
+    float max_x = x.detach().max().item<float>();
+    this->min_val = this->empty ? min_x : std::min(this->min_val, min_x);
+    this->max_val = this->empty ? max_x : std::max(this->max_val, max_x);
+    this->empty = false;
+    return;
+}
+
+
+// -------------------------------------------------------------
+// namespace{quantization} -> class{MinMaxObserver} -> function{qparams}
+// -------------------------------------------------------------
+// Asymmetric uint8 : x ~ scale * (q - zero_point), where the range always contains zero
+std::pair<double, long int> quantization::MinMaxObserver::qparams(const bool reduce_range){
+    if (this->empty) return {1.0, 0};
+    double qmax = reduce_range ? 127.0 : 255.0;
+    double min_x = std::min(this->min_val, 0.0f);
+    double max_x = std::max(this->max_val, 0.0f);
+    double scale = std::max((max_x - min_x) / qmax, 1e-8);
+    long int zero_point = (long int)std::min(std::max(std::round(-min_x / scale), 0.0), qmax);
+    return {scale, zero_point};
+}
+
+
+// --------------------------------------------------------------------
+// namespace{quantization} -> struct{ObservedImpl}(nn::Module) -> constructor
+// --------------------------------------------------------------------
+quantization::ObservedImpl::ObservedImpl(nn::AnyModule module_, std::shared_ptr<nn::Module> module_ptr_, const bool relu_){
+    this->module = module_;
+    this->module_ptr = module_ptr_;
+    this->relu = relu_;
+    register_module("module", this->module_ptr);
+}
+
+
+// --------------------------------------------------------------------
+// namespace{quantization} -> struct{ObservedImpl}(nn::Module) -> function{forward}
+// --------------------------------------------------------------------
+torch::Tensor quantization::ObservedImpl::forward(torch::Tensor x){
+    torch::Tensor out = this->module.forward(x);
+    this->observer_in.update(x);
+    this->observer_out.update(this->relu ? out.clamp_min(0.0) : out);
+    return out;
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedConv2dImpl}(nn::Module) -> constructor
+// ---------------------------------------------------------------------------
+quantization::QuantizedConv2dImpl::QuantizedConv2dImpl(nn::Conv2d &conv, quantization::ObservedImpl &observed, const bool reduce_range){
+
+    torch::NoGradGuard no_grad;
+
+    // (1) Convolution Options
+    auto &o = conv->options;
+    this->relu = observed.relu;
+    this->stride = to_vector(o.stride());
+    this->padding = to_vector(o.padding());
+    this->dilation = to_vector(o.dilation());
+    this->groups = o.groups();
+
+    // (2) Quantization Parameters
+    auto [q, scale] = quantize_weight(conv->weight);
+    auto [in_scale, in_zero_point] = observed.observer_in.qparams(reduce_range);
+    auto [out_scale, out_zero_point] = observed.observer_out.qparams(/*reduce_range=*/false);
+    this->weight = register_buffer("weight", q);
+    this->weight_scale = register_buffer("weight_scale", scale);
+    this->bias = register_buffer("bias", conv->bias.defined() ? conv->bias.detach().to(torch::kCPU, torch::kFloat) : torch::zeros({o.out_channels()}));
+    this->qparams = register_buffer("qparams", torch::tensor({in_scale, (double)in_zero_point, out_scale, (double)out_zero_point}, torch::kDouble));
+
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedConv2dImpl}(nn::Module) -> function{pack}
+// ---------------------------------------------------------------------------
+void quantization::QuantizedConv2dImpl::pack(){
+    torch::Tensor zero_point = torch::zeros({this->weight.size(0)}, torch::kLong);
+    torch::Tensor qweight = torch::_make_per_channel_quantized_tensor(this->weight, this->weight_scale, zero_point, /*axis=*/0);
+    this->packed = call("quantized::conv2d_prepack", "", {qweight, this->bias, this->stride, this->padding, this->dilation, this->groups}).at(0);
+    return;
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedConv2dImpl}(nn::Module) -> function{input_qparams}
+// ---------------------------------------------------------------------------
+std::pair<double, long int> quantization::QuantizedConv2dImpl::input_qparams(){
+    auto q = this->qparams.accessor<double, 1>();
+    return {q[0], (long int)q[1]};
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedConv2dImpl}(nn::Module) -> function{chain}
+// ---------------------------------------------------------------------------
+// The output is quantized with the input quantization parameters of the next quantized layer, and is passed to it without dequantization.
+void quantization::QuantizedConv2dImpl::chain(const std::pair<double, long int> next){
+    auto q = this->qparams.accessor<double, 1>();
+    q[2] = next.first;
+    q[3] = (double)next.second;
+    this->quantized_output = true;
+    return;
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedConv2dImpl}(nn::Module) -> function{forward}
+// ---------------------------------------------------------------------------
+// The input and output stay in float at the boundaries with the other layers, so that the residual additions need no change.
+torch::Tensor quantization::QuantizedConv2dImpl::forward(torch::Tensor x){
+    if (this->packed.isNone()){
+        std::cerr << "Error : The quantized weights are not packed." << std::endl;
+        std::exit(1);
+    }
+    auto q = this->qparams.accessor<double, 1>();
+    torch::Tensor qx = x.is_quantized() ? x : torch::quantize_per_tensor(x.contiguous(), q[0], (long int)q[1], torch::kQUInt8);  // {N,IC,H,W} ===> {N,IC,H,W} (uint8)
+    torch::Tensor qy = call(this->relu ? "quantized::conv2d_relu" : "quantized::conv2d", "new", {qx, this->packed, q[2], (long int)q[3]}).at(0).toTensor();  // {N,IC,H,W} ===> {N,OC,H',W'} (uint8)
+    return this->quantized_output ? qy : qy.dequantize();
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedLinearImpl}(nn::Module) -> constructor
+// ---------------------------------------------------------------------------
+quantization::QuantizedLinearImpl::QuantizedLinearImpl(nn::Linear &linear, quantization::ObservedImpl &observed, const bool reduce_range){
+
+    torch::NoGradGuard no_grad;
+
+    auto [q, scale] = quantize_weight(linear->weight);
+    auto [in_scale, in_zero_point] = observed.observer_in.qparams(reduce_range);
+    auto [out_scale, out_zero_point] = observed.observer_out.qparams(/*reduce_range=*/false);
+    this->relu = observed.relu;
+    this->weight = register_buffer("weight", q);
+    this->weight_scale = register_buffer("weight_scale", scale);
+    this->bias = register_buffer("bias", linear->bias.defined() ? linear->bias.detach().to(torch::kCPU, torch::kFloat) : torch::zeros({linear->options.out_features()}));
+    this->qparams = register_buffer("qparams", torch::tensor({in_scale, (double)in_zero_point, out_scale, (double)out_zero_point}, torch::kDouble));
+
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedLinearImpl}(nn::Module) -> function{pack}
+// ---------------------------------------------------------------------------
+void quantization::QuantizedLinearImpl::pack(){
+    torch::Tensor zero_point = torch::zeros({this->weight.size(0)}, torch::kLong);
+    torch::Tensor qweight = torch::_make_per_channel_quantized_tensor(this->weight, this->weight_scale, zero_point, /*axis=*/0);
+    this->packed = call("quantized::linear_prepack", "", {qweight, this->bias}).at(0);
+    return;
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedLinearImpl}(nn::Module) -> function{input_qparams}
+// ---------------------------------------------------------------------------
+std::pair<double, long int> quantization::QuantizedLinearImpl::input_qparams(){
+    auto q = this->qparams.accessor<double, 1>();
+    return {q[0], (long int)q[1]};
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedLinearImpl}(nn::Module) -> function{chain}
+// ---------------------------------------------------------------------------
+// The output is quantized with the input quantization parameters of the next quantized layer, and is passed to it without dequantization.
+void quantization::QuantizedLinearImpl::chain(const std::pair<double, long int> next){
+    auto q = this->qparams.accessor<double, 1>();
+    q[2] = next.first;
+    q[3] = (double)next.second;
+    this->quantized_output = true;
+    return;
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{quantization} -> struct{QuantizedLinearImpl}(nn::Module) -> function{forward}
+// ---------------------------------------------------------------------------
+torch::Tensor quantization::QuantizedLinearImpl::forward(torch::Tensor x){
+    if (this->packed.isNone()){
+        std::cerr << "Error : The quantized weights are not packed." << std::endl;
+        std::exit(1);
+    }
+    auto q = this->qparams.accessor<double, 1>();
+    torch::Tensor qx = x.is_quantized() ? x : torch::quantize_per_tensor(x.contiguous(), q[0], (long int)q[1], torch::kQUInt8);  // {N,IN} ===> {N,IN} (uint8)
+    torch::Tensor qy = call(this->relu ? "quantized::linear_relu" : "quantized::linear", "", {qx, this->packed, q[2], (long int)q[3]}).at(0).toTensor();  // {N,IN} ===> {N,OUT} (uint8)
+    return this->quantized_output ? qy : qy.dequantize();
+}
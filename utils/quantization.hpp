@@ -0,0 +1,116 @@
+#ifndef QUANTIZATION_HPP
+#define QUANTIZATION_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "fusion.hpp"
+
+
+// -------------------------
+// namespace{quantization}
+// -------------------------
+namespace quantization{
+
+    // Function Prototype
+    void set_engine(const std::string engine);
+    size_t prepare(std::shared_ptr<torch::nn::Module> model);
+    size_t convert(std::shared_ptr<torch::nn::Module> model);
+    void pack(std::shared_ptr<torch::nn::Module> model);
+    template <typename Model> void load_quantized(Model &model, const std::string path);
+
+    // -------------------------------------------------
+    // namespace{quantization} -> class{MinMaxObserver}
+    // -------------------------------------------------
+    class MinMaxObserver{
+    private:
+        bool empty;
+        float min_val, max_val;
+    public:
+        MinMaxObserver();
+        void update(torch::Tensor x);
+        std::pair<double, long int> qparams(const bool reduce_range);
+    };
+
+    // --------------------------------------------------------
+    // namespace{quantization} -> struct{ObservedImpl}(nn::Module)
+    // --------------------------------------------------------
+    // Wrapper of Conv2d/Linear recording the range of the input and output during calibration.
+    struct ObservedImpl : torch::nn::Module{
+    public:
+        bool relu;
+        torch::nn::AnyModule module;
+        std::shared_ptr<torch::nn::Module> module_ptr;
+        MinMaxObserver observer_in, observer_out;
+        ObservedImpl(){}
+        ObservedImpl(torch::nn::AnyModule module_, std::shared_ptr<torch::nn::Module> module_ptr_, const bool relu_);
+        torch::Tensor forward(torch::Tensor x);
+    };
+
+    // ----------------------------------------------------------
+    // namespace{quantization} -> struct{QuantizedConv2dImpl}(nn::Module)
+    // ----------------------------------------------------------
+    struct QuantizedConv2dImpl : torch::nn::Module{
+    private:
+        bool relu;
+        std::vector<long int> stride, padding, dilation;
+        long int groups;
+        torch::Tensor weight, weight_scale, bias, qparams;  // int8 weight {OC,IC/G,KH,KW}, per-channel scale {OC}, bias {OC}, {in_scale,in_zero_point,out_scale,out_zero_point}
+        c10::IValue packed;
+        bool quantized_output = false;  // the output stays quantized for the next quantized layer
+    public:
+        QuantizedConv2dImpl(){}
+        QuantizedConv2dImpl(torch::nn::Conv2d &conv, ObservedImpl &observed, const bool reduce_range);
+        void pack();
+        std::pair<double, long int> input_qparams();
+        void chain(const std::pair<double, long int> next);
+        torch::Tensor forward(torch::Tensor x);
+    };
+
+    // ----------------------------------------------------------
+    // namespace{quantization} -> struct{QuantizedLinearImpl}(nn::Module)
+    // ----------------------------------------------------------
+    struct QuantizedLinearImpl : torch::nn::Module{
+    private:
+        bool relu;
+        torch::Tensor weight, weight_scale, bias, qparams;  // int8 weight {OUT,IN}, per-channel scale {OUT}, bias {OUT}, {in_scale,in_zero_point,out_scale,out_zero_point}
+        c10::IValue packed;
+        bool quantized_output = false;  // the output stays quantized for the next quantized layer
+    public:
+        QuantizedLinearImpl(){}
+        QuantizedLinearImpl(torch::nn::Linear &linear, ObservedImpl &observed, const bool reduce_range);
+        void pack();
+        std::pair<double, long int> input_qparams();
+        void chain(const std::pair<double, long int> next);
+        torch::Tensor forward(torch::Tensor x);
+    };
+
+    TORCH_MODULE(Observed);
+    TORCH_MODULE(QuantizedConv2d);
+    TORCH_MODULE(QuantizedLinear);
+
+}
+
+
+// ----------------------------------------------------------------------------
+// namespace{quantization} -> function{load_quantized}
+// ----------------------------------------------------------------------------
+// Rebuild the structure of the quantized model on the CPU, load the int8 checkpoint into it and pack the weights for the quantized kernels.
+template <typename Model>
+void quantization::load_quantized(Model &model, const std::string path){
+    model->to(torch::kCPU);
+    fusion::fold_batchnorm(model.ptr());
+    quantization::prepare(model.ptr());
+    quantization::convert(model.ptr());  // uncalibrated quantization parameters are overwritten by the checkpoint
+    torch::load(model, path);
+    quantization::pack(model.ptr());
+    return;
+}
+
+
+#endif
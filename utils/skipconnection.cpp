@@ -0,0 +1,213 @@
+#include <tuple>
+#include <vector>
+#include <algorithm>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "skipconnection.hpp"
+#include "checkpointing.hpp"
+
+// Define Namespace
+namespace nn = torch::nn;
+
+// Function Prototype
+static torch::Tensor run(nn::SequentialImpl *seq, const size_t begin, const size_t end, torch::Tensor x);
+static void normalize(torch::Tensor out, torch::Tensor y, nn::BatchNorm2dImpl *bn, torch::Tensor &mean, torch::Tensor &invstd);
+
+
+// ------------------------------------------------
+// namespace{skipconnection} -> function{forward}
+// ------------------------------------------------
+// {NF,H,W} ===> {NF+NF',H,W} : the activated input and the output of the Sequential, without torch::cat.
+// A leading LeakyReLU is applied to the input of the skip connection, and a trailing BatchNorm2d writes straight into the second half of the buffer.
+// The first half is a copy of the activated input, except without gradients for a mini batch of 1, where the LeakyReLU writes straight into it.
+torch::Tensor skipconnection::forward(nn::Sequential &seq, torch::Tensor x, const bool recompute){
+
+    // (0) Initialization and Declaration
+    size_t i, begin, end;
+    long int in_nc, out_nc;
+    torch::Tensor buffer, skip, y, mean, invstd;
+    nn::LeakyReLUImpl *activation;
+    nn::ConvTranspose2dImpl *up;
+    nn::BatchNorm2dImpl *bn;
+
+    // (1) Layout of the Sequential : {LeakyReLU}, [begin, end), {BatchNorm2d}, {Dropout in eval mode}
+    activation = seq->ptr(0)->as<nn::LeakyReLU>();
+    begin = (activation != nullptr) ? 1 : 0;
+    end = seq->size();
+    while ((end > 0) && (seq->ptr(end - 1)->as<nn::Dropout>() != nullptr) && !seq->ptr(end - 1)->is_training()){
+        end--;  // Dropout in eval mode is the identity
+    }
+    bn = (end > 0) ? seq->ptr(end - 1)->as<nn::BatchNorm2d>() : nullptr;
+    if ((bn != nullptr) && !(recompute && torch::GradMode::is_enabled())){
+        end--;
+    }
+    else{  // the recomputed segment runs to the end of the Sequential
+        bn = nullptr;
+        end = seq->size();
+    }
+
+    // (2) Forward with Gradients
+    if (torch::GradMode::is_enabled()){
+        // The skip half is a copy : the in-place ReLU of the outer block overwrites the buffer, and the convolution keeps its input for the backward pass.
+        if (activation != nullptr){
+            x = activation->forward(x);
+        }
+        y = recompute ? checkpointing::forward(seq, x, begin) : run(seq.get(), begin, end, x);
+        if (bn == nullptr){
+            return skipconnection::ConcatFunction::apply(x, y, torch::Tensor(), torch::Tensor(), (int64_t)0);
+        }
+        return skipconnection::ConcatFunction::apply(x, y, bn->weight, bn->bias, reinterpret_cast<int64_t>(bn));
+    }
+
+    // (3) Skip Connection into the First Half
+    out_nc = 0;
+    for (i = seq->size(); (i > 0) && (out_nc == 0); i--){
+        up = seq->ptr(i - 1)->as<nn::ConvTranspose2d>();
+        if (up != nullptr) out_nc = up->options.out_channels();
+    }
+    in_nc = x.size(1);
+    buffer = torch::empty({x.size(0), in_nc + out_nc, x.size(2), x.size(3)}, x.options());  // {NF+NF',H,W}
+    skip = buffer.narrow(/*dim=*/1, /*start=*/0, /*length=*/in_nc);                        // {NF,H,W}
+    if ((activation != nullptr) && skip.is_contiguous()){  // the half of the buffer is contiguous for a mini batch of 1
+        torch::leaky_relu_out(skip, x, activation->options.negative_slope());
+        x = skip;
+    }
+    else{  // the in-place activation keeps the input of the convolution contiguous
+        if (activation != nullptr) x = activation->forward(x);
+        skip.copy_(x);
+    }
+
+    // (4) Output into the Second Half
+    y = run(seq.get(), begin, end, x);  // {NF,H,W} ===> ... ===> {NF',H,W}
+    if (bn != nullptr){
+        normalize(buffer.narrow(/*dim=*/1, /*start=*/in_nc, /*length=*/out_nc), y, bn, mean, invstd);
+    }
+    else{
+        buffer.narrow(/*dim=*/1, /*start=*/in_nc, /*length=*/out_nc).copy_(y);
+    }
+
+    return buffer;
+
+}
+
+
+// ------------------------------------------------------------------------------
+// namespace{skipconnection} -> struct{ConcatFunction} -> function{forward}
+// ------------------------------------------------------------------------------
+torch::Tensor skipconnection::ConcatFunction::forward(torch::autograd::AutogradContext *ctx, torch::Tensor x, torch::Tensor y, torch::Tensor weight, torch::Tensor bias, const int64_t bn){
+
+    // (0) Initialization and Declaration
+    long int in_nc, out_nc;
+    torch::Tensor buffer, mean, invstd;
+
+    // (1) Skip Connection into the First Half
+    in_nc = x.size(1);
+    out_nc = y.size(1);
+    buffer = torch::empty({x.size(0), in_nc + out_nc, x.size(2), x.size(3)}, x.options());  // {NF+NF',H,W}
+    buffer.narrow(/*dim=*/1, /*start=*/0, /*length=*/in_nc).copy_(x);
+
+    // (2) Output into the Second Half
+    if (bn != 0){
+        normalize(buffer.narrow(/*dim=*/1, /*start=*/in_nc, /*length=*/out_nc), y, reinterpret_cast<nn::BatchNorm2dImpl*>(bn), mean, invstd);
+        ctx->saved_data["mean"] = mean;
+        ctx->saved_data["invstd"] = invstd;
+        ctx->save_for_backward({y, weight});
+    }
+    else{
+        buffer.narrow(/*dim=*/1, /*start=*/in_nc, /*length=*/out_nc).copy_(y);
+    }
+    ctx->saved_data["module"] = bn;
+    ctx->saved_data["in_nc"] = (int64_t)in_nc;
+    ctx->saved_data["out_nc"] = (int64_t)out_nc;
+
+    return buffer;
+
+}
+
+
+// ------------------------------------------------------------------------------
+// namespace{skipconnection} -> struct{ConcatFunction} -> function{backward}
+// ------------------------------------------------------------------------------
+torch::autograd::variable_list skipconnection::ConcatFunction::backward(torch::autograd::AutogradContext *ctx, torch::autograd::variable_list grad_output){
+
+    // (0) Initialization and Declaration
+    bool affine, batch_stats;
+    long int in_nc, out_nc;
+    nn::BatchNorm2dImpl *bn;
+    torch::Tensor grad_x, grad_y, grad_weight, grad_bias, y, weight;
+    std::vector<torch::Tensor> saved;
+
+    // (1) Narrowed Gradients of the Two Halves
+    in_nc = ctx->saved_data["in_nc"].toInt();
+    out_nc = ctx->saved_data["out_nc"].toInt();
+    grad_x = grad_output.at(0).narrow(/*dim=*/1, /*start=*/0, /*length=*/in_nc);
+    grad_y = grad_output.at(0).narrow(/*dim=*/1, /*start=*/in_nc, /*length=*/out_nc);
+
+    // (2) Gradients through the BatchNorm2d
+    bn = reinterpret_cast<nn::BatchNorm2dImpl*>(ctx->saved_data["module"].toInt());
+    if (bn != nullptr){
+        saved = ctx->get_saved_variables();
+        y = saved.at(0);
+        weight = saved.at(1);
+        affine = weight.defined();
+        batch_stats = bn->is_training() || !bn->options.track_running_stats();
+        std::tie(grad_y, grad_weight, grad_bias) = torch::native_batch_norm_backward(
+            grad_y.contiguous(), y, weight, bn->running_mean, bn->running_var,
+            ctx->saved_data["mean"].toTensor(), ctx->saved_data["invstd"].toTensor(),
+            batch_stats, bn->options.eps(), {true, affine, affine}
+        );
+    }
+
+    // (3) One Gradient for each Argument of forward : {x, y, weight, bias, bn}
+    return {grad_x, grad_y, grad_weight, grad_bias, torch::Tensor()};
+
+}
+
+
+// ----------------------------
+// function{run}
+// ----------------------------
+static torch::Tensor run(nn::SequentialImpl *seq, const size_t begin, const size_t end, torch::Tensor x){
+    for (auto it = seq->begin() + begin; it != seq->begin() + end; ++it){
+        x = it->forward(x);
+    }
+    return x;
+}
+
+
+// ----------------------------
+// function{normalize}
+// ----------------------------
+// BatchNorm2d as y * scale + shift into "out", with the statistics of the mini batch in train mode and the running statistics in eval mode
+static void normalize(torch::Tensor out, torch::Tensor y, nn::BatchNorm2dImpl *bn, torch::Tensor &mean, torch::Tensor &invstd){
+
+    double momentum;
+    long int count;
+    torch::Tensor var, scale, shift;
+
+    if (bn->is_training() || !bn->options.track_running_stats()){
+        std::tie(var, mean) = torch::var_mean(y, {0, 2, 3}, /*unbiased=*/false);
+        if (bn->is_training() && bn->options.track_running_stats()){
+            bn->num_batches_tracked += 1;
+            momentum = bn->options.momentum().has_value() ? bn->options.momentum().value() : 1.0 / bn->num_batches_tracked.item<double>();
+            count = y.numel() / y.size(1);
+            bn->running_mean.mul_(1.0 - momentum).add_(mean, momentum);
+            bn->running_var.mul_(1.0 - momentum).add_(var * ((double)count / (double)std::max(count - 1, 1L)), momentum);
+        }
+    }
+    else{
+        mean = bn->running_mean;
+        var = bn->running_var;
+    }
+    invstd = torch::rsqrt(var + bn->options.eps());
+
+    scale = invstd;
+    if (bn->options.affine()) scale = scale * bn->weight;
+    shift = -mean * scale;
+    if (bn->options.affine()) shift = shift + bn->bias;
+    torch::addcmul_out(out, shift.view({1, -1, 1, 1}), y, scale.view({1, -1, 1, 1}));
+
+    return;
+
+}
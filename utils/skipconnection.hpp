@@ -0,0 +1,28 @@
+#ifndef SKIPCONNECTION_HPP
+#define SKIPCONNECTION_HPP
+
+// For External Library
+#include <torch/torch.h>
+
+
+// -----------------------
+// namespace{skipconnection}
+// -----------------------
+namespace skipconnection{
+
+    // Function Prototype
+    torch::Tensor forward(torch::nn::Sequential &seq, torch::Tensor x, const bool recompute=false);
+
+    // ------------------------------------------------------------------------------
+    // namespace{skipconnection} -> struct{ConcatFunction}(autograd::Function)
+    // ------------------------------------------------------------------------------
+    // {x, y} ===> {x, BN(y)} : both are written into one buffer, and the gradient of the buffer is split back into its two halves.
+    struct ConcatFunction : public torch::autograd::Function<ConcatFunction>{
+        static torch::Tensor forward(torch::autograd::AutogradContext *ctx, torch::Tensor x, torch::Tensor y, torch::Tensor weight, torch::Tensor bias, const int64_t bn);
+        static torch::autograd::variable_list backward(torch::autograd::AutogradContext *ctx, torch::autograd::variable_list grad_output);
+    };
+
+}
+
+
+#endif
@@ -0,0 +1,206 @@
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+// For External Library
+#include <torch/torch.h>
+// For Original Header
+#include "tiling.hpp"
+
+// Define Namespace
+namespace F = torch::nn::functional;
+
+
+// -----------------------------------------------------------
+// namespace{tiling} -> class{SlidingWindow} -> constructor
+// -----------------------------------------------------------
+tiling::SlidingWindow::SlidingWindow(const size_t tile_, const size_t overlap_, const size_t tile_batch_){
+
+    if (overlap_ >= tile_){
+        std::cerr << "Error : The overlap of tiles must be smaller than the tile size." << std::endl;
+        std::exit(1);
+    }
+    this->tile = tile_;
+    this->stride = tile_ - overlap_;
+    this->tile_batch = std::max(tile_batch_, (size_t)1);
+
+    // Squared sine window : the weight falls towards tile borders, with a floor so that image borders are still covered
+    torch::Tensor line = (torch::arange(this->tile, torch::kFloat) + 0.5) * (M_PI / (double)this->tile);  // {T}
+    line = line.sin().pow(2.0).clamp_min(1e-3);  // {T}
+    this->window = line.unsqueeze(1) * line.unsqueeze(0);  // {T,1} * {1,T} ===> {T,T}
+
+}
+
+
+// -----------------------------------------------------------
+// namespace{tiling} -> class{SlidingWindow} -> function{pad}
+// -----------------------------------------------------------
+torch::Tensor tiling::SlidingWindow::pad(torch::Tensor image){
+    long int pad_h = std::max(this->tile - image.size(2), (long int)0);
+    long int pad_w = std::max(this->tile - image.size(3), (long int)0);
+    if ((pad_h == 0) && (pad_w == 0)){
+        return image;
+    }
+    return F::pad(image, F::PadFuncOptions({0, pad_w, 0, pad_h}).mode(torch::kReplicate));  // {N,C,H,W} ===> {N,C,max(H,T),max(W,T)}
+}
+
+
+// -----------------------------------------------------------------
+// namespace{tiling} -> class{SlidingWindow} -> function{positions}
+// -----------------------------------------------------------------
+std::vector<long int> tiling::SlidingWindow::positions(const long int length){
+    std::vector<long int> out;
+    for (long int p = 0; p + this->tile < length; p += this->stride){
+        out.push_back(p);
+    }
+    out.push_back(length - this->tile);  // the last tile is aligned to the border
+    return out;
+}
+
+
+// ------------------------------------------------------------------
+// namespace{tiling} -> class{SlidingWindow} -> function{get_window}
+// ------------------------------------------------------------------
+torch::Tensor tiling::SlidingWindow::get_window(const torch::TensorOptions options){
+    if ((this->window.device() != options.device()) || (this->window.dtype() != options.dtype())){
+        this->window = this->window.to(options);
+    }
+    return this->window;
+}
+
+
+// -------------------------------------------------------------
+// namespace{tiling} -> class{SlidingWindow} -> function{blend}
+// -------------------------------------------------------------
+// Forward overlapping tiles in mini batches of tiles, and blend the outputs with the window function.
+torch::Tensor tiling::SlidingWindow::blend(std::function<torch::Tensor(torch::Tensor)> forward, torch::Tensor image){
+
+    // (0) Initialization and Declaration
+    size_t b, start, end;
+    long int n, y, x;
+    long int height, width;
+    std::vector<long int> ys, xs;
+    std::vector<std::tuple<long int, long int, long int>> tiles;
+    std::vector<torch::Tensor> batch;
+    torch::Tensor input, pred, window, output, weight;
+
+    // (1) Tile Positions
+    height = image.size(2);
+    width = image.size(3);
+    input = this->pad(image);
+    ys = this->positions(input.size(2));
+    xs = this->positions(input.size(3));
+    for (n = 0; n < input.size(0); n++){
+        for (auto &y_ : ys){
+            for (auto &x_ : xs){
+                tiles.push_back({n, y_, x_});
+            }
+        }
+    }
+
+    // (2) Forward Tiles and Accumulate Weighted Outputs
+    for (start = 0; start < tiles.size(); start += this->tile_batch){
+        end = std::min(start + this->tile_batch, tiles.size());
+        batch.clear();
+        for (b = start; b < end; b++){
+            std::tie(n, y, x) = tiles.at(b);
+            batch.push_back(input[n].narrow(/*dim=*/1, y, this->tile).narrow(/*dim=*/2, x, this->tile));  // {C,H,W} ===> {C,T,T}
+        }
+        pred = forward(torch::stack(batch, /*dim=*/0));  // {B,C,T,T} ===> {B,K,T,T}
+        if ((pred.size(2) != this->tile) || (pred.size(3) != this->tile)){
+            std::cerr << "Error : The output size of a tile must be the same as the tile size." << std::endl;
+            std::exit(1);
+        }
+        if (!output.defined()){
+            output = torch::zeros({input.size(0), pred.size(1), input.size(2), input.size(3)}, pred.options());  // {N,K,H,W}
+            window = this->get_window(pred.options());  // {T,T}
+        }
+        for (b = start; b < end; b++){
+            std::tie(n, y, x) = tiles.at(b);
+            output[n].narrow(/*dim=*/1, y, this->tile).narrow(/*dim=*/2, x, this->tile).add_(pred[b - start] * window);
+        }
+    }
+
+    // (3) Normalization by Accumulated Weights
+    weight = torch::zeros({input.size(2), input.size(3)}, window.options());  // {H,W}
+    for (auto &y_ : ys){
+        for (auto &x_ : xs){
+            weight.narrow(/*dim=*/0, y_, this->tile).narrow(/*dim=*/1, x_, this->tile).add_(window);
+        }
+    }
+    output = output / weight;  // {N,K,H,W} / {H,W} ===> {N,K,H,W}
+
+    return output.narrow(/*dim=*/2, 0, height).narrow(/*dim=*/3, 0, width).contiguous();
+
+}
+
+
+// ------------------------------------------------------------
+// namespace{tiling} -> class{SlidingWindow} -> function{vote}
+// ------------------------------------------------------------
+// Forward overlapping tiles, and keep the class of the tile with the highest window-weighted confidence per pixel.
+// Unlike blending class scores, the memory does not grow with the number of classes.
+torch::Tensor tiling::SlidingWindow::vote(std::function<torch::Tensor(torch::Tensor)> forward, torch::Tensor image){
+
+    // (0) Initialization and Declaration
+    size_t b, start, end;
+    long int n, y, x;
+    long int height, width;
+    std::vector<long int> ys, xs;
+    std::vector<std::tuple<long int, long int, long int>> tiles;
+    std::vector<torch::Tensor> batch;
+    std::tuple<torch::Tensor, torch::Tensor> conf_index;
+    torch::Tensor input, pred, window, conf, index, score, label;
+    torch::Tensor score_tile, label_tile, better;
+
+    // (1) Tile Positions
+    height = image.size(2);
+    width = image.size(3);
+    input = this->pad(image);
+    ys = this->positions(input.size(2));
+    xs = this->positions(input.size(3));
+    for (n = 0; n < input.size(0); n++){
+        for (auto &y_ : ys){
+            for (auto &x_ : xs){
+                tiles.push_back({n, y_, x_});
+            }
+        }
+    }
+
+    // (2) Forward Tiles and Vote for Classes
+    for (start = 0; start < tiles.size(); start += this->tile_batch){
+        end = std::min(start + this->tile_batch, tiles.size());
+        batch.clear();
+        for (b = start; b < end; b++){
+            std::tie(n, y, x) = tiles.at(b);
+            batch.push_back(input[n].narrow(/*dim=*/1, y, this->tile).narrow(/*dim=*/2, x, this->tile));  // {C,H,W} ===> {C,T,T}
+        }
+        pred = forward(torch::stack(batch, /*dim=*/0));  // {B,C,T,T} ===> {B,K,T,T}
+        if ((pred.size(2) != this->tile) || (pred.size(3) != this->tile)){
+            std::cerr << "Error : The output size of a tile must be the same as the tile size." << std::endl;
+            std::exit(1);
+        }
+        if (!score.defined()){
+            score = torch::full({input.size(0), input.size(2), input.size(3)}, -1.0, pred.options().dtype(torch::kFloat));  // {N,H,W}
+            label = torch::zeros({input.size(0), input.size(2), input.size(3)}, pred.options().dtype(torch::kLong));  // {N,H,W}
+            window = this->get_window(score.options());  // {T,T}
+        }
+        conf_index = pred.to(torch::kFloat).softmax(/*dim=*/1).max(/*dim=*/1);  // {B,K,T,T} ===> {B,T,T}
+        conf = std::get<0>(conf_index) * window;  // {B,T,T}
+        index = std::get<1>(conf_index);  // {B,T,T}
+        for (b = start; b < end; b++){
+            std::tie(n, y, x) = tiles.at(b);
+            score_tile = score[n].narrow(/*dim=*/0, y, this->tile).narrow(/*dim=*/1, x, this->tile);
+            label_tile = label[n].narrow(/*dim=*/0, y, this->tile).narrow(/*dim=*/1, x, this->tile);
+            better = conf[b - start] > score_tile;  // {T,T}
+            score_tile.copy_(torch::where(better, conf[b - start], score_tile));
+            label_tile.copy_(torch::where(better, index[b - start], label_tile));
+        }
+    }
+
+    return label.narrow(/*dim=*/1, 0, height).narrow(/*dim=*/2, 0, width).contiguous();  // {N,H,W}
+
+}
@@ -0,0 +1,36 @@
+#ifndef TILING_HPP
+#define TILING_HPP
+
+#include <vector>
+#include <functional>
+// For External Library
+#include <torch/torch.h>
+
+
+// -------------------
+// namespace{tiling}
+// -------------------
+namespace tiling{
+
+    // ----------------------------------------------
+    // namespace{tiling} -> class{SlidingWindow}
+    // ----------------------------------------------
+    class SlidingWindow{
+    private:
+        long int tile, stride;
+        size_t tile_batch;
+        torch::Tensor window;  // blending weight {T,T}
+        torch::Tensor pad(torch::Tensor image);
+        std::vector<long int> positions(const long int length);
+        torch::Tensor get_window(const torch::TensorOptions options);
+    public:
+        SlidingWindow(){}
+        SlidingWindow(const size_t tile_, const size_t overlap_, const size_t tile_batch_);
+        torch::Tensor blend(std::function<torch::Tensor(torch::Tensor)> forward, torch::Tensor image);
+        torch::Tensor vote(std::function<torch::Tensor(torch::Tensor)> forward, torch::Tensor image);
+    };
+
+}
+
+
+#endif
@@ -0,0 +1,46 @@
+#include <string>
+#include <functional>
+// For External Library
+#include <torch/torch.h>
+#include <torch/script.h>
+#include <torch/csrc/jit/frontend/tracer.h>
+// For Original Header
+#include "torchscript.hpp"
+
+
+// -----------------------------------------------
+// namespace{torchscript} -> function{trace}
+// -----------------------------------------------
+// Record the operators executed by the C++ module into a graph, and attach the graph to a new module as "forward".
+torch::jit::Module torchscript::trace(std::function<torch::Tensor(torch::Tensor)> forward, torch::Tensor example){
+
+    // (1) Tracing
+    auto traced = torch::jit::tracer::trace(
+        /*inputs=*/{example},
+        /*traced_fn=*/[&](torch::jit::Stack inputs){ return torch::jit::Stack{forward(inputs.at(0).toTensor())}; },
+        /*var_name_lookup_fn=*/[](const torch::autograd::Variable &var){ return std::string(); },
+        /*strict=*/false
+    );
+    std::shared_ptr<torch::jit::Graph> graph = traced.first->graph;
+
+    // (2) Module with Traced Graph
+    torch::jit::Module module("__torch__.TracedModule");
+    module.register_attribute("training", c10::BoolType::get(), false);
+    graph->insertInput(0, "self")->setType(module._ivalue()->type());
+    auto method = module._ivalue()->compilation_unit()->create_function(c10::QualifiedName(*module.type()->name(), "forward"), graph);
+    module.type()->addMethod(method);
+
+    return module;
+
+}
+
+
+// -----------------------------------------------
+// namespace{torchscript} -> function{optimize}
+// -----------------------------------------------
+// Freezing folds constants and conv-BN pairs, and optimize_for_inference enables the oneDNN fusions on CPU.
+torch::jit::Module torchscript::optimize(torch::jit::Module &module){
+    module.eval();
+    torch::jit::Module frozen = torch::jit::freeze(module);
+    return torch::jit::optimize_for_inference(frozen);
+}
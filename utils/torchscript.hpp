@@ -0,0 +1,51 @@
+#ifndef TORCHSCRIPT_HPP
+#define TORCHSCRIPT_HPP
+
+#include <iostream>
+#include <string>
+#include <functional>
+// For External Library
+#include <torch/torch.h>
+#include <torch/script.h>
+
+
+// -----------------------
+// namespace{torchscript}
+// -----------------------
+namespace torchscript{
+
+    // Function Prototype
+    torch::jit::Module trace(std::function<torch::Tensor(torch::Tensor)> forward, torch::Tensor example);
+    torch::jit::Module optimize(torch::jit::Module &module);
+    template <typename Model> void export_model(Model &model, const std::string path, torch::Tensor example);
+
+}
+
+
+// ----------------------------------------------------------------------------
+// namespace{torchscript} -> function{export_model}
+// ----------------------------------------------------------------------------
+// Load "<path>.pth", trace the forward for the shape of the example, freeze it and save "<path>.pt".
+template <typename Model>
+void torchscript::export_model(Model &model, const std::string path, torch::Tensor example){
+
+    // (1) Get Model
+    torch::load(model, path + ".pth");
+    model->eval();
+    for (auto &param : model->parameters()){
+        param.set_requires_grad(false);  // weights are recorded as constants of the graph
+    }
+
+    // (2) Trace, Freeze and Save
+    torch::NoGradGuard no_grad;
+    torch::jit::Module module = torchscript::trace([&](torch::Tensor x){ return model->forward(x); }, example);
+    module = torchscript::optimize(module);
+    module.save(path + ".pt");
+    std::cout << "TorchScript module : " << path << ".pt (input:" << example.sizes() << ')' << std::endl;
+
+    return;
+
+}
+
+
+#endif
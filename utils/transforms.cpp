@@ -88,6 +88,10 @@ transforms::Resize::Resize(const cv::Size size_, const int interpolation_){
 // namespace{transforms} -> class{Resize}(Compose) -> function{forward}
 // -----------------------------------------------------------------------
 void transforms::Resize::forward(cv::Mat &data_in, cv::Mat &data_out){
+    if (this->interpolation == cv::INTER_NEAREST){
+        cv::resize(data_in, data_out, this->size, 0.0, 0.0, this->interpolation);  // no interpolated values, so the depth is kept as it is
+        return;
+    }
     cv::Mat float_mat, float_mat_resize;
     data_in.convertTo(float_mat, CV_32F);  // discrete ===> continuous
     cv::resize(float_mat, float_mat_resize, this->size, 0.0, 0.0, this->interpolation);
@@ -100,8 +104,34 @@ void transforms::Resize::forward(cv::Mat &data_in, cv::Mat &data_out){
 // namespace{transforms} -> class{ConvertIndex}(Compose) -> constructor
 // ---------------------------------------------------------------------------
 transforms::ConvertIndex::ConvertIndex(const int before_, const int after_){
-    this->before = before_;
-    this->after = after_;
+    this->pairs = {{before_, after_}};
+    this->set_table();
+}
+
+transforms::ConvertIndex::ConvertIndex(const std::vector<std::pair<int, int>> pairs_){
+    this->pairs = pairs_;
+    this->set_table();
+}
+
+
+// ---------------------------------------------------------------------------
+// namespace{transforms} -> class{ConvertIndex}(Compose) -> function{set_table}
+// ---------------------------------------------------------------------------
+void transforms::ConvertIndex::set_table(){
+    this->table = cv::Mat(1, 256, CV_8UC1);
+    for (int i = 0; i < 256; i++){
+        this->table.at<unsigned char>(0, i) = (unsigned char)i;
+    }
+    this->table_ok = true;
+    for (auto &pair : this->pairs){
+        if ((pair.second < 0) || (pair.second > 255)){
+            this->table_ok = false;
+        }
+        else if ((0 <= pair.first) && (pair.first <= 255)){
+            this->table.at<unsigned char>(0, pair.first) = (unsigned char)pair.second;
+        }
+    }
+    return;
 }
 
 
@@ -109,19 +139,21 @@ transforms::ConvertIndex::ConvertIndex(const int before_, const int after_){
 // namespace{transforms} -> class{ConvertIndex}(Compose) -> function{forward}
 // ---------------------------------------------------------------------------
 void transforms::ConvertIndex::forward(cv::Mat &data_in, cv::Mat &data_out){
-    size_t width = data_in.cols;
-    size_t height = data_in.rows;
-    data_out = cv::Mat(cv::Size(width, height), CV_32SC1);
-    for (size_t j = 0; j < height; j++){
-        for (size_t i = 0; i < width; i++){
-            if (data_in.at<int>(j, i) == this->before){
-                data_out.at<int>(j, i) = this->after;
-            }
-            else{
-                data_out.at<int>(j, i) = data_in.at<int>(j, i);
-            }
-        }
+
+    // (1) uint8 Index Image : all pairs in a single table look-up
+    if ((data_in.depth() == CV_8U) && this->table_ok){
+        cv::LUT(data_in, this->table, data_out);
+        return;
     }
+
+    // (2) int32 Index Image : every pair is matched against the input, so the pairs are converted simultaneously
+    cv::Mat src;
+    data_in.convertTo(src, CV_32S);
+    data_out = src.clone();
+    for (auto &pair : this->pairs){
+        data_out.setTo(cv::Scalar(pair.second), (src == pair.first));
+    }
+
     return;
 }
 
@@ -144,7 +176,10 @@ void transforms::ToTensor::forward(cv::Mat &data_in, torch::Tensor &data_out){
 // namespace{transforms} -> class{ToTensorLabel}(Compose) -> function{forward}
 // ----------------------------------------------------------------------------
 void transforms::ToTensorLabel::forward(cv::Mat &data_in, torch::Tensor &data_out){
-    torch::Tensor data_out_src = torch::from_blob(data_in.data, {data_in.rows, data_in.cols, data_in.channels()}, torch::kInt).to(torch::kLong);  // {0,1,2} = {H,W,C}
+    cv::Mat index = data_in.isContinuous() ? data_in : data_in.clone();
+    torch::ScalarType dtype = (index.depth() == CV_8U) ? torch::kByte : torch::kInt;  // uint8 labels stay compact until the mini batch is collated
+    if ((index.depth() != CV_8U) && (index.depth() != CV_32S)) index.convertTo(index, CV_32S);
+    torch::Tensor data_out_src = torch::from_blob(index.data, {index.rows, index.cols, index.channels()}, dtype);  // {0,1,2} = {H,W,C}
     data_out_src = data_out_src.permute({2, 0, 1});  // {0,1,2} = {H,W,C} ===> {0,1,2} = {C,H,W}
     data_out_src = torch::squeeze(data_out_src, /*dim=*/0);  // {C,H,W} ===> {H,W}
     data_out = data_out_src.contiguous().detach().clone();
@@ -76,10 +76,14 @@ namespace transforms{
     // ----------------------------------------------------
     class ConvertIndex : Compose{
     private:
-        int before, after;
+        std::vector<std::pair<int, int>> pairs;  // {before, after} * P
+        cv::Mat table;                           // look-up table {256} for uint8 index images
+        bool table_ok;
+        void set_table();
     public:
         ConvertIndex(){}
         ConvertIndex(const int before_, const int after_);
+        ConvertIndex(const std::vector<std::pair<int, int>> pairs_);
         bool type() override{return CV_MAT;}
         void forward(cv::Mat &data_in, cv::Mat &data_out) override;
         void forward(cv::Mat &data_in, torch::Tensor &data_out) override{}
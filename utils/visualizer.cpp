@@ -2,16 +2,23 @@
 #include <fstream>
 #include <filesystem>
 #include <string>
+#include <sstream>
 #include <tuple>
 #include <vector>
 #include <utility>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <csetjmp>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <memory>
 // For External Library
 #include <torch/torch.h>
 #include <opencv2/opencv.hpp>
-#include <png++/png.hpp>
+#include <png.h>
 // For Original Header
 #include "visualizer.hpp"
 
@@ -19,213 +26,539 @@
 namespace fs = std::filesystem;
 
 
+// Function Prototype
+static cv::Mat image_grid(const torch::Tensor image, const std::pair<float, float> range, const size_t cols, const size_t padding, const size_t bits, const int mtype_out);
+static cv::Mat label_grid(const torch::Tensor label_byte, const size_t cols, const size_t padding);
+static bool encode_label(const cv::Mat &output, const std::vector<png_color> &pal, const std::string path, const int compression, std::vector<unsigned char> &buf);
+static void write_png(png_structp png_ptr, png_bytep data, png_size_t length);
+static double nice_step(const double span);
+static cv::Mat draw_graph(const std::vector<float> &base, const std::vector<std::vector<float>> &value, const std::vector<std::string> &label);
+
+
 // ----------------------------------------------------------
 // namespace{visualizer} -> function{save_image}
 // ----------------------------------------------------------
+// The tensor is copied to the CPU here, and the grid assembly and PNG encoding are left to the writer.
 void visualizer::save_image(const torch::Tensor image, const std::string path, const std::pair<float, float> range, const size_t cols, const size_t padding, const size_t bits){
 
     // (0) Initialization and Declaration
-    size_t i, j, k, l;
-    size_t i_dev, j_dev;
-    size_t width, height, channels, mini_batch_size;
-    size_t width_out, height_out;
-    size_t ncol, nrow;
-    int mtype_in, mtype_out;
-    cv::Mat float_mat, normal_mat, bit_mat, RGB, BGR;
-    cv::Mat sample, output;
-    std::vector<cv::Mat> samples;
-    torch::Tensor tensor_sq, tensor_per;
+    size_t channels;
+    int mtype_out, compression;
+    std::string name;
+    std::shared_ptr<archive::tar> archive_sink;
+    torch::Tensor image_cpu;
 
-    // (1) Get Tensor Size
-    mini_batch_size = image.size(0);
+    // (1) Judge the number of channels and bits
     channels = image.size(1);
-    height = image.size(2);
-    width = image.size(3);
+    if ((channels != 1) && (channels != 3)){
+        std::cerr << "Error : Channels of the image to be saved is inappropriate." << std::endl;
+        std::exit(1);
+    }
+    else if (bits == 8){
+        mtype_out = (channels == 1) ? CV_8UC1 : CV_8UC3;
+    }
+    else if (bits == 16){
+        mtype_out = (channels == 1) ? CV_16UC1 : CV_16UC3;
+    }
+    else{
+        std::cerr << "Error : Bits of the image to be saved is inappropriate." << std::endl;
+        std::exit(1);
+    }
 
-    // (2) Judge the number of channels and bits
-    mtype_in = CV_32FC1;
-    if (channels == 1){
-        if (bits == 8){
-            mtype_out = CV_8UC1;
-        }
-        else if (bits == 16){
-            mtype_out = CV_16UC1;
-        }
-        else{
-            std::cerr << "Error : Bits of the image to be saved is inappropriate." << std::endl;
-            std::exit(1);
+    // (2) Copy the Mini Batch to the CPU
+    image_cpu = image.detach().clamp(/*min=*/range.first, /*max=*/range.second).to(torch::kCPU, torch::kFloat).contiguous();  // {N,C,H,W} (float)
+
+    // (3) Grid Assembly and Image Output
+    compression = visualizer::writer::instance().get_compression();
+    archive_sink = visualizer::writer::instance().get_sink(path, name);  // the archive opened at this call, even if it is closed before the job runs
+    visualizer::writer::instance().push([=](){
+        std::vector<int> params;
+        std::vector<unsigned char> buf;
+        cv::Mat output = image_grid(image_cpu, range, cols, padding, bits, mtype_out);
+        if (compression >= 0) params = {cv::IMWRITE_PNG_COMPRESSION, compression};
+        if (!cv::imencode(fs::path(path).extension().string(), output, buf, params)){
+            std::cerr << "Error : Couldn't encode the image '" << path << "'." << std::endl;
+            return;
         }
+        visualizer::writer::instance().store(archive_sink, name, path, buf);
+    });
+
+    // End Processing
+    return;
+
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> function{save_label}
+// ----------------------------------------------------------
+// The tensor is copied to the CPU here, and the grid assembly and PNG encoding are left to the writer.
+void visualizer::save_label(const torch::Tensor label, const std::string path, const std::vector<std::tuple<unsigned char, unsigned char, unsigned char>> label_palette, const size_t cols, const size_t padding){
+
+    // (0) Initialization and Declaration
+    size_t i;
+    int compression;
+    std::string name;
+    std::shared_ptr<archive::tar> archive_sink;
+    torch::Tensor label_byte;
+    std::vector<png_color> pal;
+
+    // (1) Narrow the whole mini batch to uint8 at once
+    label_byte = label.detach().to(torch::kCPU).clamp(0, 255).to(torch::kByte).contiguous();  // {N,1,H,W} (uint8)
+
+    // (2) Palette for Index Image
+    pal = std::vector<png_color>(std::min(label_palette.size(), (size_t)PNG_MAX_PALETTE_LENGTH));
+    for (i = 0; i < pal.size(); i++){
+        pal.at(i).red = std::get<0>(label_palette.at(i));
+        pal.at(i).green = std::get<1>(label_palette.at(i));
+        pal.at(i).blue = std::get<2>(label_palette.at(i));
     }
-    else if (channels == 3){
-        if (bits == 8){
-            mtype_out = CV_8UC3;
-        }
-        else if (bits == 16){
-            mtype_out = CV_16UC3;
+
+    // (3) Grid Assembly and Image Output
+    compression = visualizer::writer::instance().get_compression();
+    archive_sink = visualizer::writer::instance().get_sink(path, name);  // the archive opened at this call, even if it is closed before the job runs
+    visualizer::writer::instance().push([=](){
+        std::vector<unsigned char> buf;
+        cv::Mat output = label_grid(label_byte, cols, padding);
+        if (encode_label(output, pal, path, compression, buf)){
+            visualizer::writer::instance().store(archive_sink, name, path, buf);
         }
-        else{
-            std::cerr << "Error : Bits of the image to be saved is inappropriate." << std::endl;
-            std::exit(1);
+    });
+
+    // End Processing
+    return;
+
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> function{set_writer}
+// ----------------------------------------------------------
+// "num_workers=0" writes the images on the calling thread, and "compression=-1" keeps the default level of the encoder.
+void visualizer::set_writer(const size_t num_workers, const size_t capacity, const int compression){
+    visualizer::writer::instance().restart(num_workers, capacity, compression);
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> function{flush}
+// ----------------------------------------------------------
+void visualizer::flush(){
+    visualizer::writer::instance().flush();
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> function{open_archive}
+// ----------------------------------------------------------
+// The following images are stored in the tar archive "path" with the names relative to its directory, instead of one file per image.
+void visualizer::open_archive(const std::string path){
+    visualizer::writer::instance().open_archive(path);
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> function{close_archive}
+// ----------------------------------------------------------
+void visualizer::close_archive(){
+    visualizer::writer::instance().close_archive();
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{instance}
+// ----------------------------------------------------------
+// The writer of the process is built at the first call, and is flushed and joined at exit.
+visualizer::writer &visualizer::writer::instance(){
+    static visualizer::writer service(visualizer::writer::default_workers(), /*capacity_=*/64, /*compression_=*/-1);
+    return service;
+}
+
+
+// -------------------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{default_workers}
+// -------------------------------------------------------------------
+size_t visualizer::writer::default_workers(){
+    return std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> constructor
+// ----------------------------------------------------------
+visualizer::writer::writer(const size_t num_workers, const size_t capacity_, const int compression_){
+    this->stop = false;
+    this->busy = 0;
+    this->restart(num_workers, capacity_, compression_);
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{restart}
+// ----------------------------------------------------------
+void visualizer::writer::restart(const size_t num_workers, const size_t capacity_, const int compression_){
+
+    // (1) Finish the Current Workers
+    this->join();
+
+    // (2) Start New Workers
+    std::lock_guard<std::mutex> lock(this->mtx);
+    this->stop = false;
+    this->capacity = std::max<size_t>(capacity_, 1);
+    this->compression = std::min(compression_, 9);
+    for (size_t i = 0; i < num_workers; i++){
+        this->workers.emplace_back(&visualizer::writer::work, this);
+    }
+
+    // End Processing
+    return;
+
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{push}
+// ----------------------------------------------------------
+// The caller waits while the queue is full, so that the images in memory are bounded by the capacity.
+void visualizer::writer::push(std::function<void()> job){
+    {
+        std::unique_lock<std::mutex> lock(this->mtx);
+        if (!this->workers.empty()){
+            this->cond_space.wait(lock, [this]{ return this->jobs.size() < this->capacity; });
+            this->jobs.push(std::move(job));
+            this->cond_job.notify_one();
+            return;
         }
     }
-    else{
-        std::cerr << "Error : Channels of the image to be saved is inappropriate." << std::endl;
-        std::exit(1);
+    job();
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{flush}
+// ----------------------------------------------------------
+void visualizer::writer::flush(){
+    std::unique_lock<std::mutex> lock(this->mtx);
+    this->cond_idle.wait(lock, [this]{ return this->jobs.empty() && (this->busy == 0); });
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{get_compression}
+// ----------------------------------------------------------
+int visualizer::writer::get_compression(){
+    std::lock_guard<std::mutex> lock(this->mtx);
+    return this->compression;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{open_archive}
+// ----------------------------------------------------------
+void visualizer::writer::open_archive(const std::string path){
+    this->close_archive();
+    std::lock_guard<std::mutex> lock(this->mtx);
+    this->archive_dir = fs::path(path).parent_path();
+    this->sink = std::make_shared<archive::tar>(path);
+    return;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{close_archive}
+// ----------------------------------------------------------
+// The queued images are written before the archive is closed.
+void visualizer::writer::close_archive(){
+    std::shared_ptr<archive::tar> closing;
+    this->flush();
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        closing = this->sink;
+        this->sink.reset();
     }
+    if (closing) closing->close();
+    return;
+}
 
-    // (3) Add images to the array
-    i = 0;
-    samples = std::vector<cv::Mat>(mini_batch_size);
-    auto mini_batch = image.clamp(/*min=*/range.first, /*max=*/range.second).contiguous().to(torch::kCPU).chunk(mini_batch_size, /*dim=*/0);  // {N,C,H,W} ===> {1,C,H,W} + {1,C,H,W} + ...
-    for (auto &tensor : mini_batch){
-        tensor_sq = torch::squeeze(tensor, /*dim=*/0);  // {1,C,H,W} ===> {C,H,W}
-        tensor_per = tensor_sq.permute({1, 2, 0});  // {C,H,W} ===> {H,W,C}
-        if (channels == 3){
-            auto tensor_vec = tensor_per.chunk(channels, /*dim=*/2);  // {H,W,3} ===> {H,W,1} + {H,W,1} + {H,W,1}
-            std::vector<cv::Mat> mv;
-            for (auto &tensor_channel : tensor_vec){
-                mv.push_back(cv::Mat(cv::Size(width, height), mtype_in, tensor_channel.data_ptr<float>()));  // torch::Tensor ===> cv::Mat
-            }
-            cv::merge(mv, float_mat);  // {H,W,1} + {H,W,1} + {H,W,1} ===> {H,W,3}
-        }
-        else{
-            float_mat = cv::Mat(cv::Size(width, height), mtype_in, tensor_per.data_ptr<float>());  // torch::Tensor ===> cv::Mat
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{get_sink}
+// ----------------------------------------------------------
+// The archive opened now (or nullptr), and the name of "path" relative to its directory.
+std::shared_ptr<archive::tar> visualizer::writer::get_sink(const std::string path, std::string &name){
+    std::lock_guard<std::mutex> lock(this->mtx);
+    if (this->sink){
+        name = fs::path(path).lexically_relative(this->archive_dir).generic_string();
+        if (name.empty() || (name.compare(0, 2, "..") == 0)) name = fs::path(path).generic_string();
+    }
+    return this->sink;
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{store}
+// ----------------------------------------------------------
+// The encoded image goes to the archive captured at the call of save_image or save_label, and to the file "path" otherwise.
+// An image the archive cannot hold (e.g. a name too long for the ustar header) is written to the file "path" instead of being dropped.
+void visualizer::writer::store(const std::shared_ptr<archive::tar> archive_sink, const std::string name, const std::string path, const std::vector<unsigned char> &buf){
+
+    std::ofstream ofs;
+
+    // (1) Archive Output
+    if (archive_sink){
+        if (archive_sink->append(name, buf)) return;
+        std::cerr << "Error : Couldn't store '" << name << "' in the archive, so it is written to the path '" << path << "'." << std::endl;
+        if (fs::path(path).has_parent_path()) fs::create_directories(fs::path(path).parent_path());
+    }
+
+    // (2) File Output
+    ofs.open(path, std::ios::out | std::ios::binary);
+    if (!ofs.is_open()){
+        std::cerr << "Error : Couldn't open the path '" << path << "'." << std::endl;
+        return;
+    }
+    ofs.write((const char*)buf.data(), buf.size());
+    ofs.close();
+
+    // End Processing
+    return;
+
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{work}
+// ----------------------------------------------------------
+void visualizer::writer::work(){
+    std::function<void()> job;
+    while (true){
+        {
+            std::unique_lock<std::mutex> lock(this->mtx);
+            this->cond_job.wait(lock, [this]{ return this->stop || !this->jobs.empty(); });
+            if (this->jobs.empty()) return;
+            job = std::move(this->jobs.front());
+            this->jobs.pop();
+            this->busy++;
+            this->cond_space.notify_one();
         }
-        normal_mat = (float_mat - range.first) / (float)(range.second - range.first);  // [range.first, range.second] ===> [0,1]
-        bit_mat = normal_mat * (std::pow(2.0, bits) - 1.0);  // [0,1] ===> [0,255] or [0,65535]
-        bit_mat.convertTo(sample, mtype_out);  // {32F} ===> {8U} or {16U}
-        if (channels == 3){
-            RGB = sample;
-            cv::cvtColor(RGB, BGR, cv::COLOR_RGB2BGR);  // {R,G,B} ===> {B,G,R}
-            sample = BGR;
+        job();
+        {
+            std::lock_guard<std::mutex> lock(this->mtx);
+            this->busy--;
+            if (this->jobs.empty() && (this->busy == 0)) this->cond_idle.notify_all();
         }
-        sample.copyTo(samples.at(i));
-        i++;
     }
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> function{join}
+// ----------------------------------------------------------
+// The workers drain the queue before they stop.
+void visualizer::writer::join(){
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        this->stop = true;
+        this->cond_job.notify_all();
+    }
+    for (auto &worker : this->workers){
+        worker.join();
+    }
+    this->workers.clear();
+    return;
+}
 
-    // (4) Output Image Information
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{writer} -> destructor
+// ----------------------------------------------------------
+visualizer::writer::~writer(){
+    this->join();
+    if (this->sink) this->sink->close();
+}
+
+
+// ----------------------------------------------------------
+// function{image_grid}
+// ----------------------------------------------------------
+static cv::Mat image_grid(const torch::Tensor image, const std::pair<float, float> range, const size_t cols, const size_t padding, const size_t bits, const int mtype_out){
+
+    // (0) Initialization and Declaration
+    size_t l;
+    size_t i_dev, j_dev;
+    size_t width, height, channels, mini_batch_size;
+    size_t width_out, height_out;
+    size_t ncol, nrow;
+    int mtype_in;
+    cv::Mat float_mat, normal_mat, bit_mat, RGB, BGR;
+    cv::Mat sample, output;
+    torch::Tensor tensor_per;
+
+    // (1) Get Tensor Size
+    mini_batch_size = image.size(0);
+    channels = image.size(1);
+    height = image.size(2);
+    width = image.size(3);
+    mtype_in = (channels == 1) ? CV_32FC1 : CV_32FC3;
+
+    // (2) Output Image Information
     ncol = (mini_batch_size < cols) ? mini_batch_size : cols;
     width_out = width * ncol + padding * (ncol + 1);
     nrow = 1 + (mini_batch_size - 1) / ncol;
     height_out =  height * nrow + padding * (nrow + 1);
 
-    // (5) Value Substitution for Output Image
+    // (3) Convert each Sample and Copy it into the Output Image
     output = cv::Mat(cv::Size(width_out, height_out), mtype_out, cv::Scalar::all(0));
     for (l = 0; l < mini_batch_size; l++){
-        sample = samples.at(l);
+        tensor_per = image[l].permute({1, 2, 0}).contiguous();  // {C,H,W} ===> {H,W,C}
+        float_mat = cv::Mat(cv::Size(width, height), mtype_in, tensor_per.data_ptr<float>());  // torch::Tensor ===> cv::Mat
+        normal_mat = (float_mat - cv::Scalar::all(range.first)) / (float)(range.second - range.first);  // [range.first, range.second] ===> [0,1]
+        bit_mat = normal_mat * (std::pow(2.0, bits) - 1.0);  // [0,1] ===> [0,255] or [0,65535]
+        bit_mat.convertTo(sample, mtype_out);  // {32F} ===> {8U} or {16U}
+        if (channels == 3){
+            RGB = sample;
+            cv::cvtColor(RGB, BGR, cv::COLOR_RGB2BGR);  // {R,G,B} ===> {B,G,R}
+            sample = BGR;
+        }
         i_dev = (l % ncol) * width + padding * (l % ncol + 1);
         j_dev = (l / ncol) * height + padding * (l / ncol + 1);
-        for (j = 0; j < height; j++){
-            for (i = 0; i < width; i++){
-                for (k = 0; k < sample.elemSize(); k++){
-                    output.data[(j + j_dev) * output.step + (i + i_dev) * output.elemSize() + k] = sample.data[j * sample.step + i * sample.elemSize() + k];
-                }
-            }
-        }
+        sample.copyTo(output(cv::Rect(i_dev, j_dev, width, height)));
     }
 
-    // (6) Image Output
-    cv::imwrite(path, output);
-
-    // End Processing
-    return;
+    return output;
 
 }
 
 
 // ----------------------------------------------------------
-// namespace{visualizer} -> function{save_label}
+// function{label_grid}
 // ----------------------------------------------------------
-void visualizer::save_label(const torch::Tensor label, const std::string path, const std::vector<std::tuple<unsigned char, unsigned char, unsigned char>> label_palette, const size_t cols, const size_t padding){
+static cv::Mat label_grid(const torch::Tensor label_byte, const size_t cols, const size_t padding){
 
     // (0) Initialization and Declaration
-    size_t i, j, k;
+    size_t k;
     size_t i_dev, j_dev;
     size_t width, height, mini_batch_size;
     size_t width_out, height_out;
     size_t ncol, nrow;
-    unsigned char R, G, B;
-    cv::Mat sample;
-    std::vector<cv::Mat> samples;
-    torch::Tensor tensor_sq, tensor_per;
-    png::image<png::index_pixel> output;
-    png::palette pal;
-    std::tuple<unsigned char, unsigned char, unsigned char> pal_one;
+    cv::Mat sample, output;
 
     // (1) Get Tensor Size
-    mini_batch_size = label.size(0);
-    height = label.size(2);
-    width = label.size(3);
-
-    // (2) Add images to the array
-    i = 0;
-    samples = std::vector<cv::Mat>(mini_batch_size);
-    auto mini_batch = label.contiguous().to(torch::kCPU).chunk(mini_batch_size, /*dim=*/0);  // {N,1,H,W} ===> {1,1,H,W} + {1,1,H,W} + ...
-    for (auto &tensor : mini_batch){
-        tensor_sq = torch::squeeze(tensor, /*dim=*/0);  // {1,1,H,W} ===> {1,H,W}
-        tensor_per = tensor_sq.permute({1, 2, 0});  // {1,H,W} ===> {H,W,1}
-        sample = cv::Mat(cv::Size(width, height), CV_32SC1, tensor_per.to(torch::kInt).data_ptr<int>());  // torch::Tensor ===> cv::Mat
-        sample.copyTo(samples.at(i));
-        i++;
-    }
+    mini_batch_size = label_byte.size(0);
+    height = label_byte.size(2);
+    width = label_byte.size(3);
 
-    // (3) Output Image Information
+    // (2) Output Image Information
     ncol = (mini_batch_size < cols) ? mini_batch_size : cols;
     width_out = width * ncol + padding * (ncol + 1);
     nrow = 1 + (mini_batch_size - 1) / ncol;
     height_out =  height * nrow + padding * (nrow + 1);
 
-    // (4) Palette and Value Initialization for Index Image
-    output = png::image<png::index_pixel>(width_out, height_out);
-    pal = png::palette(label_palette.size());
-    for (i = 0; i < pal.size(); i++){
-        pal_one = label_palette.at(i);
-        R = std::get<0>(pal_one);
-        G = std::get<1>(pal_one);
-        B = std::get<2>(pal_one);
-        pal[i] = png::color(R, G, B);
-    }
-    output.set_palette(pal);
-    for (j = 0; j < height_out; j++){
-        for (i = 0; i < width_out; i++){
-            output[j][i] = 0;
-        }
-    }
-
-    // (5) Value Substitution for Output Image
+    // (3) Value Substitution for Output Image
+    output = cv::Mat::zeros(cv::Size(width_out, height_out), CV_8UC1);
     for (k = 0; k < mini_batch_size; k++){
-        sample = samples.at(k);
+        sample = cv::Mat(cv::Size(width, height), CV_8UC1, label_byte[k].data_ptr<unsigned char>());  // torch::Tensor ===> cv::Mat
         i_dev = (k % ncol) * width + padding * (k % ncol + 1);
         j_dev = (k / ncol) * height + padding * (k / ncol + 1);
-        for (j = 0; j < height; j++){
-            for (i = 0; i < width; i++){
-                output[j+j_dev][i+i_dev] = sample.at<int>(j, i);
-            }
-        }
+        sample.copyTo(output(cv::Rect(i_dev, j_dev, width, height)));
     }
 
-    // (6) Image Output
-    output.write(path);
+    return output;
+
+}
+
+
+// ----------------------------------------------------------
+// function{encode_label}
+// ----------------------------------------------------------
+// The errors are reported without exit, since this runs on the workers of the writer.
+static bool encode_label(const cv::Mat &output, const std::vector<png_color> &pal, const std::string path, const int compression, std::vector<unsigned char> &buf){
+
+    // (0) Initialization and Declaration
+    int j;
+    png_structp png_ptr;
+    png_infop info_ptr;
+    std::vector<png_bytep> rows;
+
+    // (1) Encoder into the Memory
+    png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    info_ptr = png_create_info_struct(png_ptr);
+    if (setjmp(png_jmpbuf(png_ptr))){
+        std::cerr << "Error : Couldn't encode the index image '" << path << "'." << std::endl;
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return false;
+    }
+    png_set_write_fn(png_ptr, &buf, write_png, nullptr);
+
+    // (2) Row-wise Image Output
+    if (compression >= 0) png_set_compression_level(png_ptr, compression);
+    png_set_IHDR(png_ptr, info_ptr, output.cols, output.rows, 8, PNG_COLOR_TYPE_PALETTE, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_set_PLTE(png_ptr, info_ptr, pal.data(), pal.size());
+    png_write_info(png_ptr, info_ptr);
+    rows = std::vector<png_bytep>(output.rows);
+    for (j = 0; j < output.rows; j++){
+        rows.at(j) = (png_bytep)output.ptr<unsigned char>(j);
+    }
+    png_write_image(png_ptr, rows.data());
+    png_write_end(png_ptr, nullptr);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+
+    return true;
+
+}
 
-    // End Processing
-    return;
 
+// ----------------------------------------------------------
+// function{write_png}
+// ----------------------------------------------------------
+static void write_png(png_structp png_ptr, png_bytep data, png_size_t length){
+    std::vector<unsigned char> *buf = (std::vector<unsigned char>*)png_get_io_ptr(png_ptr);
+    buf->insert(buf->end(), data, data + length);
+    return;
 }
 
 
 // ----------------------------------------------------------
 // namespace{visualizer} -> class{graph} -> constructor
 // ----------------------------------------------------------
+// The existing values in "<dir>/data/<gname>.dat" are loaded, so that the chart keeps the history of the resumed training.
 visualizer::graph::graph(const std::string dir_, const std::string gname_, const std::vector<std::string> label_){
-    this->flag = false;
+
+    float v;
+    std::string line;
+    std::ifstream ifs;
+
     this->dir = dir_;
     this->data_dir = this->dir + "/data";
     this->gname = gname_;
     this->graph_fname= this->dir + '/' + this->gname + ".png";
     this->data_fname= this->data_dir + '/' + this->gname + ".dat";
     this->label = label_;
+    this->data = std::make_shared<series>();
+    this->data->pending = false;
     fs::create_directories(this->dir);
     fs::create_directories(this->data_dir);
+
+    ifs.open(this->data_fname, std::ios::in);
+    while (std::getline(ifs, line)){
+        std::stringstream ss(line);
+        std::vector<float> value;
+        if (!(ss >> v)) continue;
+        this->data->base.push_back(v);
+        while (ss >> v){
+            value.push_back(v);
+        }
+        value.resize(this->label.size(), std::nanf(""));
+        this->data->value.push_back(value);
+    }
+    ifs.close();
+
 }
 
 
@@ -234,6 +567,8 @@ visualizer::graph::graph(const std::string dir_, const std::string gname_, const
 // ----------------------------------------------------------
 void visualizer::graph::plot(const float base, const std::vector<float> value){
 
+    bool queue;
+
     // (1) Value Output
     std::ofstream ofs(this->data_fname, std::ios::app);
     ofs << base << std::flush;
@@ -243,24 +578,166 @@ void visualizer::graph::plot(const float base, const std::vector<float> value){
     ofs << std::endl;
     ofs.close();
 
-    // (2) Graph Output
-    if (this->flag){
-        FILE* gp;
-        gp = popen("gnuplot -persist", "w");
-        fprintf(gp, "set terminal png\n");
-        fprintf(gp, "set output '%s'\n", this->graph_fname.c_str());
-        fprintf(gp, "plot ");
-        for (size_t i = 0; i < this->label.size() - 1; i++){
-            fprintf(gp, "'%s' using 1:%zu ti '%s' with lines,", this->data_fname.c_str(), i + 2, this->label.at(i).c_str());
-        }
-        fprintf(gp, "'%s' using 1:%zu ti '%s' with lines\n", this->data_fname.c_str(), this->label.size() + 1, this->label.at(this->label.size() - 1).c_str());
-        pclose(gp);
+    // (2) Value Addition to the Series
+    {
+        std::lock_guard<std::mutex> lock(this->data->mtx);
+        this->data->base.push_back(base);
+        this->data->value.push_back(value);
+        this->data->value.back().resize(this->label.size(), std::nanf(""));
+        queue = (!this->data->pending && (this->data->base.size() >= 2));
+        if (queue) this->data->pending = true;
     }
 
-    // (3) Setting for after the Second Time
-    this->flag = true;
+    // (3) Graph Output in the Background
+    if (queue){
+        std::shared_ptr<series> data_ = this->data;
+        std::string graph_fname_ = this->graph_fname;
+        std::vector<std::string> label_ = this->label;
+        visualizer::writer::instance().push([data_, graph_fname_, label_](){
+            visualizer::graph::render(data_, graph_fname_, label_);
+        });
+    }
 
     // End Processing
     return;
 
+}
+
+
+// ----------------------------------------------------------
+// namespace{visualizer} -> class{graph} -> function{render}
+// ----------------------------------------------------------
+// The latest values at the time of drawing are used, so the requests queued while waiting are drawn at once.
+void visualizer::graph::render(const std::shared_ptr<series> data, const std::string graph_fname, const std::vector<std::string> label){
+
+    std::vector<float> base;
+    std::vector<std::vector<float>> value;
+    {
+        std::lock_guard<std::mutex> lock(data->mtx);
+        base = data->base;
+        value = data->value;
+        data->pending = false;
+    }
+    if (!cv::imwrite(graph_fname, draw_graph(base, value, label))){
+        std::cerr << "Error : Couldn't write the graph '" << graph_fname << "'." << std::endl;
+    }
+    return;
+
+}
+
+
+// ----------------------------------------------------------
+// function{nice_step}
+// ----------------------------------------------------------
+// The interval of the ticks in {1,2,5}*10^k for about 5 ticks over the span.
+static double nice_step(const double span){
+    double raw, scale, frac;
+    raw = span / 5.0;
+    scale = std::pow(10.0, std::floor(std::log10(raw)));
+    frac = raw / scale;
+    if (frac < 1.5) return scale;
+    else if (frac < 3.5) return 2.0 * scale;
+    else if (frac < 7.5) return 5.0 * scale;
+    return 10.0 * scale;
+}
+
+
+// ----------------------------------------------------------
+// function{draw_graph}
+// ----------------------------------------------------------
+static cv::Mat draw_graph(const std::vector<float> &base, const std::vector<std::vector<float>> &value, const std::vector<std::string> &label){
+
+    constexpr int width = 640, height = 480;  // the same size as the png terminal of gnuplot
+    constexpr int left = 70, right = 20, top = 20, bottom = 40;
+    constexpr int font = cv::FONT_HERSHEY_SIMPLEX;
+    constexpr double font_scale = 0.4;
+
+    // (0) Initialization and Declaration
+    size_t i, j;
+    int baseline, px, py;
+    double x_min, x_max, y_min, y_max, x_step, y_step, t;
+    char text[32];
+    bool drawing;
+    cv::Size text_size;
+    cv::Point prev, point;
+    cv::Mat canvas;
+    const std::vector<cv::Scalar> colors = {{211, 0, 148}, {115, 158, 0}, {233, 180, 86}, {0, 159, 230}, {66, 228, 240}, {178, 114, 0}, {36, 30, 229}, {0, 0, 0}};  // BGR
+
+    // (1) Range of the Values
+    x_min = *std::min_element(base.begin(), base.end());
+    x_max = *std::max_element(base.begin(), base.end());
+    y_min = INFINITY;
+    y_max = -INFINITY;
+    for (auto &row : value){
+        for (auto &v : row){
+            if (!std::isfinite(v)) continue;
+            y_min = std::min(y_min, (double)v);
+            y_max = std::max(y_max, (double)v);
+        }
+    }
+    if (!std::isfinite(y_min)){
+        y_min = 0.0;
+        y_max = 1.0;
+    }
+    if (x_max - x_min <= 0.0) x_max = x_min + 1.0;
+    if (y_max - y_min <= 0.0){
+        t = (std::abs(y_min) > 0.0) ? std::abs(y_min) * 0.1 : 1.0;
+        y_min -= t;
+        y_max += t;
+    }
+
+    // (2) Range Extension to the Ticks
+    x_step = nice_step(x_max - x_min);
+    x_min = std::floor(x_min / x_step) * x_step;
+    x_max = std::ceil(x_max / x_step) * x_step;
+    y_step = nice_step(y_max - y_min);
+    y_min = std::floor(y_min / y_step) * y_step;
+    y_max = std::ceil(y_max / y_step) * y_step;
+    auto to_point = [&](const double x, const double y){
+        return cv::Point(left + (int)std::lround((x - x_min) / (x_max - x_min) * (width - left - right)), top + (int)std::lround((y_max - y) / (y_max - y_min) * (height - top - bottom)));
+    };
+
+    // (3) Border and Ticks
+    canvas = cv::Mat(cv::Size(width, height), CV_8UC3, cv::Scalar::all(255));
+    cv::rectangle(canvas, cv::Point(left, top), cv::Point(width - right, height - bottom), cv::Scalar::all(0), 1);
+    for (t = x_min; t <= x_max + x_step * 0.5; t += x_step){
+        px = to_point(t, y_min).x;
+        cv::line(canvas, cv::Point(px, height - bottom), cv::Point(px, height - bottom - 5), cv::Scalar::all(0), 1);
+        std::snprintf(text, sizeof(text), "%g", (std::abs(t) < x_step * 1e-6) ? 0.0 : t);
+        text_size = cv::getTextSize(text, font, font_scale, 1, &baseline);
+        cv::putText(canvas, text, cv::Point(px - text_size.width / 2, height - bottom + 8 + text_size.height), font, font_scale, cv::Scalar::all(0), 1, cv::LINE_AA);
+    }
+    for (t = y_min; t <= y_max + y_step * 0.5; t += y_step){
+        py = to_point(x_min, t).y;
+        cv::line(canvas, cv::Point(left, py), cv::Point(left + 5, py), cv::Scalar::all(0), 1);
+        std::snprintf(text, sizeof(text), "%g", (std::abs(t) < y_step * 1e-6) ? 0.0 : t);
+        text_size = cv::getTextSize(text, font, font_scale, 1, &baseline);
+        cv::putText(canvas, text, cv::Point(left - 6 - text_size.width, py + text_size.height / 2), font, font_scale, cv::Scalar::all(0), 1, cv::LINE_AA);
+    }
+
+    // (4) Lines for each Label
+    for (j = 0; j < label.size(); j++){
+        drawing = false;
+        for (i = 0; i < base.size(); i++){
+            if (!std::isfinite(value.at(i).at(j))){
+                drawing = false;
+                continue;
+            }
+            point = to_point(base.at(i), value.at(i).at(j));
+            if (drawing) cv::line(canvas, prev, point, colors.at(j % colors.size()), 1, cv::LINE_AA);
+            prev = point;
+            drawing = true;
+        }
+    }
+
+    // (5) Legend
+    for (j = 0; j < label.size(); j++){
+        text_size = cv::getTextSize(label.at(j), font, font_scale, 1, &baseline);
+        py = top + 15 + (int)j * 16;
+        cv::putText(canvas, label.at(j), cv::Point(width - right - 50 - text_size.width, py + text_size.height / 2), font, font_scale, cv::Scalar::all(0), 1, cv::LINE_AA);
+        cv::line(canvas, cv::Point(width - right - 40, py), cv::Point(width - right - 10, py), colors.at(j % colors.size()), 1, cv::LINE_AA);
+    }
+
+    return canvas;
+
 }
\ No newline at end of file
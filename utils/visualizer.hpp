@@ -4,8 +4,16 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <queue>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
 // For External Library
 #include <torch/torch.h>
+// For Original Header
+#include "archive.hpp"
 
 
 // -----------------------------------
@@ -16,17 +24,61 @@ namespace visualizer{
     // Function Prototype    
     void save_image(const torch::Tensor image, const std::string path, const std::pair<float, float> range={0.0, 1.0}, const size_t cols=8, const size_t padding=2, const size_t bits=8);
     void save_label(const torch::Tensor label, const std::string path, const std::vector<std::tuple<unsigned char, unsigned char, unsigned char>> label_palette, const size_t cols=8, const size_t padding=2);
+    void set_writer(const size_t num_workers, const size_t capacity=64, const int compression=-1);
+    void flush();
+    void open_archive(const std::string path);
+    void close_archive();
+
+    // -----------------------------------
+    // namespace{visualizer} -> class{writer}
+    // -----------------------------------
+    // The images of save_image and save_label are assembled and encoded by a thread pool through a bounded queue.
+    class writer{
+    private:
+        bool stop;
+        size_t capacity, busy;
+        int compression;
+        std::string archive_dir;
+        std::shared_ptr<archive::tar> sink;
+        std::queue<std::function<void()>> jobs;
+        std::vector<std::thread> workers;
+        std::mutex mtx;
+        std::condition_variable cond_job, cond_space, cond_idle;
+        writer(const size_t num_workers, const size_t capacity_, const int compression_);
+        void work();
+        void join();
+    public:
+        static writer &instance();
+        static size_t default_workers();
+        void restart(const size_t num_workers, const size_t capacity_, const int compression_);
+        void push(std::function<void()> job);
+        void flush();
+        int get_compression();
+        void open_archive(const std::string path);
+        void close_archive();
+        std::shared_ptr<archive::tar> get_sink(const std::string path, std::string &name);
+        void store(const std::shared_ptr<archive::tar> archive_sink, const std::string name, const std::string path, const std::vector<unsigned char> &buf);
+        ~writer();
+    };
 
     // -----------------------------------
     // namespace{visualizer} -> class{graph}
     // -----------------------------------
+    // The series are kept in memory, and the chart is drawn with OpenCV by the writer, coalescing the requests queued at once.
     class graph{
     private:
-        bool flag;
+        struct series{
+            bool pending;
+            std::vector<float> base;
+            std::vector<std::vector<float>> value;
+            std::mutex mtx;
+        };
         std::string dir, data_dir;
         std::string gname;
         std::string graph_fname, data_fname;
         std::vector<std::string> label;
+        std::shared_ptr<series> data;
+        static void render(const std::shared_ptr<series> data, const std::string graph_fname, const std::vector<std::string> label);
     public:
         graph(){}
         graph(const std::string dir_, const std::string gname_, const std::vector<std::string> label_);